@@ -0,0 +1,96 @@
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "boot.h"
+
+static const char *TAG = "boot";
+
+static EventGroupHandle_t s_boot_group;
+
+static const char *s_stage_names[BOOT_STAGE_MAX] = {
+    [BOOT_STAGE_NVS] = "nvs",
+    [BOOT_STAGE_MOTOR] = "motor",
+    [BOOT_STAGE_PWM] = "pwm",
+    [BOOT_STAGE_NETIF] = "netif",
+    [BOOT_STAGE_HTTP] = "http",
+    [BOOT_STAGE_WIFI] = "wifi",
+    [BOOT_STAGE_IP] = "ip",
+};
+
+const char *boot_stage_name(boot_stage_t stage)
+{
+    return stage < BOOT_STAGE_MAX ? s_stage_names[stage] : "?";
+}
+
+static EventGroupHandle_t boot_group(void)
+{
+    // Tworzona przy pierwszym użyciu - zdarzenia mogą przyjść przed boot_run
+    if (s_boot_group == NULL) {
+        s_boot_group = xEventGroupCreate();
+    }
+    return s_boot_group;
+}
+
+void boot_stage_done(boot_stage_t stage)
+{
+    EventBits_t before = xEventGroupSetBits(boot_group(), BOOT_DEP(stage));
+    if (!(before & BOOT_DEP(stage))) {
+        ESP_LOGI(TAG, "%-6s gotowy  %7" PRId64 " us", boot_stage_name(stage), esp_timer_get_time());
+    }
+}
+
+bool boot_wait(uint32_t mask, TickType_t timeout)
+{
+    EventBits_t bits = xEventGroupWaitBits(boot_group(), mask, pdFALSE, pdTRUE, timeout);
+    return (bits & mask) == mask;
+}
+
+esp_err_t boot_run(const boot_stage_desc_t *stages, size_t count)
+{
+    uint32_t pending = 0;
+    for (size_t i = 0; i < count; i++) {
+        pending |= BOOT_DEP(stages[i].stage);
+    }
+
+    while (pending) {
+        EventBits_t done = xEventGroupGetBits(boot_group());
+        uint32_t waiting_for = 0;
+        bool progressed = false;
+
+        for (size_t i = 0; i < count; i++) {
+            const boot_stage_desc_t *s = &stages[i];
+            if (!(pending & BOOT_DEP(s->stage))) {
+                continue;
+            }
+            if ((done & s->deps) != s->deps) {
+                waiting_for |= s->deps & ~done;
+                continue;
+            }
+
+            int64_t start = esp_timer_get_time();
+            esp_err_t err = s->init();
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "%-6s błąd %s", boot_stage_name(s->stage), esp_err_to_name(err));
+                return err;
+            }
+            ESP_LOGI(TAG, "%-6s start %7" PRId64 " us, czas %6" PRId64 " us",
+                     boot_stage_name(s->stage), start, esp_timer_get_time() - start);
+            pending &= ~BOOT_DEP(s->stage);
+            boot_stage_done(s->stage);
+            done = xEventGroupGetBits(boot_group());
+            progressed = true;
+        }
+
+        if (!progressed && pending) {
+            // Pozostałe etapy czekają na zdarzenia zewnętrzne (np. IP)
+            if (!(waiting_for & ~pending)) {
+                ESP_LOGE(TAG, "Cykliczne zależności etapów (0x%" PRIx32 ")", pending);
+                return ESP_ERR_INVALID_STATE;
+            }
+            xEventGroupWaitBits(boot_group(), waiting_for & ~pending, pdFALSE, pdFALSE, portMAX_DELAY);
+        }
+    }
+    return ESP_OK;
+}
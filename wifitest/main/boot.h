@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+// Etapy startu. Etapy z funkcją init uruchamia boot_run, pozostałe
+// (np. uzyskanie IP) zgłaszają się same przez boot_stage_done.
+typedef enum {
+    BOOT_STAGE_NVS,
+    BOOT_STAGE_MOTOR,       // PWM w stanie bezpiecznym + zadanie silnika
+    BOOT_STAGE_PWM,         // częstotliwość PWM zapisana w NVS
+    BOOT_STAGE_NETIF,       // stos TCP/IP, pętla zdarzeń, interfejs STA
+    BOOT_STAGE_HTTP,        // serwer HTTP nasłuchuje
+    BOOT_STAGE_WIFI,        // sterownik Wi-Fi uruchomiony, łączenie w tle
+    BOOT_STAGE_IP,          // uzyskano adres IP
+    BOOT_STAGE_MAX
+} boot_stage_t;
+
+#define BOOT_DEP(stage) (1u << (stage))
+
+typedef struct {
+    boot_stage_t stage;
+    esp_err_t (*init)(void);
+    uint32_t deps;          // maska BOOT_DEP() etapów wymaganych wcześniej
+} boot_stage_desc_t;
+
+// Uruchomienie etapów w kolejności wynikającej z zależności, jeden po
+// drugim w zadaniu wołającym (bez równoległości). Etap startuje, gdy
+// tylko wszystkie jego zależności są gotowe, a przy remisie decyduje
+// kolejność w tabeli; czasy startu i końca każdego etapu trafiają do logu.
+esp_err_t boot_run(const boot_stage_desc_t *stages, size_t count);
+
+// Zgłoszenie zakończenia etapu (również z obsługi zdarzeń)
+void boot_stage_done(boot_stage_t stage);
+
+// Oczekiwanie na etapy z maski BOOT_DEP()
+bool boot_wait(uint32_t mask, TickType_t timeout);
+
+const char *boot_stage_name(boot_stage_t stage);
@@ -0,0 +1,185 @@
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_adc/adc_continuous.h"
+#include "current_sense.h"
+
+static const char *TAG = "current_sense";
+
+// Ramka DMA 32 próbek przy 20 kHz (minimum ESP32) to przerwanie co 1,6 ms
+#define CURRENT_SENSE_RATE_HZ 20000
+#define CURRENT_SENSE_SAMPLE_US (1000000 / CURRENT_SENSE_RATE_HZ)
+#define CURRENT_SENSE_FRAME_SAMPLES 32
+#define CURRENT_SENSE_FRAME_BYTES (CURRENT_SENSE_FRAME_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES)
+// Pula sterownika nie jest czytana - przy przepełnieniu jest czyszczona
+#define CURRENT_SENSE_POOL_BYTES (4 * CURRENT_SENSE_FRAME_BYTES)
+
+// Filtr wykładniczy 1/8 (stała czasowa 0,4 ms); utyk, gdy prąd po filtrze
+// jest ponad progiem przez 1 ms - pojedyncze szpilki PWM nie wystarczą
+#define CURRENT_SENSE_FILTER_SHIFT 3
+#define CURRENT_SENSE_HOLD_SAMPLES 20
+#define CURRENT_SENSE_BLANK_SAMPLES (CONFIG_MOTOR_STALL_BLANK_MS * (CURRENT_SENSE_RATE_HZ / 1000))
+
+// Zakres przy tłumieniu 12 dB bez kalibracji - wystarcza do progu utyku
+#define CURRENT_SENSE_FULL_MV 3100
+#define CURRENT_SENSE_RAW_MAX 4095
+
+static adc_continuous_handle_t s_adc;
+static current_sense_stall_cb_t s_stall_cb;
+static void *s_stall_arg;
+static uint32_t s_threshold_raw;
+
+// Stan detekcji - wspólny dla przerwania ADC i zadań sterujących mostkiem
+static portMUX_TYPE s_sense_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_filter_q;     // prąd po filtrze << CURRENT_SENSE_FILTER_SHIFT
+static bool s_driven;
+static uint32_t s_blank;
+static uint32_t s_over;
+static bool s_stall_pending;
+static int64_t s_stall_us;      // chwila przekroczenia progu przez ostatni utyk
+static current_sense_stats_t s_stats;
+
+static uint32_t current_sense_raw_to_ma(uint32_t raw)
+{
+    return (uint32_t)((uint64_t)raw * CURRENT_SENSE_FULL_MV * 1000 /
+                      ((uint64_t)CURRENT_SENSE_RAW_MAX * CONFIG_CURRENT_SENSE_MV_PER_A));
+}
+
+// Koniec ramki DMA (przerwanie). edata wskazuje bufor DMA sterownika -
+// próbki są przetwarzane na miejscu.
+static bool IRAM_ATTR current_sense_on_frame(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata, void *user_data)
+{
+    const uint32_t n = edata->size / SOC_ADC_DIGI_RESULT_BYTES;
+    const int64_t now = esp_timer_get_time();
+    bool stall = false;
+
+    portENTER_CRITICAL_ISR(&s_sense_lock);
+    for (uint32_t i = 0; i < n; i++) {
+        const adc_digi_output_data_t *p =
+            (const adc_digi_output_data_t *)&edata->conv_frame_buffer[i * SOC_ADC_DIGI_RESULT_BYTES];
+        if (p->type1.channel != CONFIG_CURRENT_SENSE_ADC_CHANNEL) {
+            continue;
+        }
+        s_filter_q += p->type1.data - (s_filter_q >> CURRENT_SENSE_FILTER_SHIFT);
+
+        if (!s_driven || s_stall_pending) {
+            s_over = 0;
+            continue;
+        }
+        if (s_blank > 0) {
+            s_blank--;
+            continue;
+        }
+        if ((s_filter_q >> CURRENT_SENSE_FILTER_SHIFT) < s_threshold_raw) {
+            s_over = 0;
+            continue;
+        }
+        if (++s_over == CURRENT_SENSE_HOLD_SAMPLES) {
+            // Ostatnia próbka ramki odpowiada chwili przerwania
+            s_stall_us = now - (int64_t)(n - 1 - i + CURRENT_SENSE_HOLD_SAMPLES - 1) * CURRENT_SENSE_SAMPLE_US;
+            s_stall_pending = true;
+            stall = true;
+        }
+    }
+    portEXIT_CRITICAL_ISR(&s_sense_lock);
+
+    return stall ? s_stall_cb(s_stall_arg) : false;
+}
+
+esp_err_t current_sense_init(current_sense_stall_cb_t cb, void *arg)
+{
+    s_stall_cb = cb;
+    s_stall_arg = arg;
+    s_threshold_raw = (uint32_t)((uint64_t)CONFIG_MOTOR_STALL_CURRENT_MA * CONFIG_CURRENT_SENSE_MV_PER_A *
+                                 CURRENT_SENSE_RAW_MAX / (1000ULL * CURRENT_SENSE_FULL_MV));
+    if (s_threshold_raw > CURRENT_SENSE_RAW_MAX) {
+        ESP_LOGW(TAG, "Próg utyku %d mA poza zakresem ADC", CONFIG_MOTOR_STALL_CURRENT_MA);
+    }
+
+    adc_continuous_handle_cfg_t handle_config = {
+        .max_store_buf_size = CURRENT_SENSE_POOL_BYTES,
+        .conv_frame_size = CURRENT_SENSE_FRAME_BYTES,
+        .flags.flush_pool = true
+    };
+    esp_err_t err = adc_continuous_new_handle(&handle_config, &s_adc);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    adc_digi_pattern_config_t pattern = {
+        .atten = ADC_ATTEN_DB_12,
+        .channel = CONFIG_CURRENT_SENSE_ADC_CHANNEL,
+        .unit = ADC_UNIT_1,
+        .bit_width = ADC_BITWIDTH_12
+    };
+    adc_continuous_config_t adc_config = {
+        .pattern_num = 1,
+        .adc_pattern = &pattern,
+        .sample_freq_hz = CURRENT_SENSE_RATE_HZ,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE1
+    };
+    err = adc_continuous_config(s_adc, &adc_config);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    adc_continuous_evt_cbs_t cbs = {
+        .on_conv_done = current_sense_on_frame
+    };
+    err = adc_continuous_register_event_callbacks(s_adc, &cbs, NULL);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Pomiar prądu: ADC1 kanał %d, %d Hz, próg utyku %d mA (%" PRIu32 ")",
+             CONFIG_CURRENT_SENSE_ADC_CHANNEL, CURRENT_SENSE_RATE_HZ,
+             CONFIG_MOTOR_STALL_CURRENT_MA, s_threshold_raw);
+    return adc_continuous_start(s_adc);
+}
+
+void current_sense_set_driven(bool driven)
+{
+    portENTER_CRITICAL(&s_sense_lock);
+    if (driven && !s_driven) {
+        s_blank = CURRENT_SENSE_BLANK_SAMPLES;
+        s_over = 0;
+    }
+    s_driven = driven;
+    portEXIT_CRITICAL(&s_sense_lock);
+}
+
+bool current_sense_stall_cut(void)
+{
+    const int64_t now = esp_timer_get_time();
+    bool pending;
+
+    portENTER_CRITICAL(&s_sense_lock);
+    pending = s_stall_pending;
+    if (pending) {
+        s_stall_pending = false;
+        s_stats.stalls++;
+        s_stats.latency_us = (uint32_t)(now - s_stall_us);
+        if (s_stats.latency_us > s_stats.latency_max_us) {
+            s_stats.latency_max_us = s_stats.latency_us;
+        }
+    }
+    portEXIT_CRITICAL(&s_sense_lock);
+
+    if (pending) {
+        ESP_LOGW(TAG, "Utyk silnika, mostek odcięty po %" PRIu32 " us od przekroczenia progu",
+                 s_stats.latency_us);
+    }
+    return pending;
+}
+
+void current_sense_get_stats(current_sense_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_sense_lock);
+    *stats = s_stats;
+    uint32_t filtered = s_filter_q >> CURRENT_SENSE_FILTER_SHIFT;
+    portEXIT_CRITICAL(&s_sense_lock);
+    stats->current_ma = current_sense_raw_to_ma(filtered);
+}
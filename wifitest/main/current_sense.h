@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// Pomiar prądu silnika na ADC1 w trybie ciągłym (DMA). Próbki są
+// filtrowane w przerwaniu końca ramki prosto z bufora DMA sterownika,
+// bez kopiowania, i porównywane z progiem utyku CONFIG_MOTOR_STALL_CURRENT_MA.
+
+// Utyk wykryty - wywoływane z przerwania ADC, więc nie może blokować.
+// Zwraca true, gdy trzeba przełączyć zadanie.
+typedef bool (*current_sense_stall_cb_t)(void *arg);
+
+// Migawka pomiaru do telemetrii
+typedef struct {
+    uint32_t current_ma;        // prąd po filtrze
+    uint32_t stalls;            // liczba odcięć po utyku
+    uint32_t latency_us;        // ostatni utyk: przekroczenie progu -> odcięcie mostka
+    uint32_t latency_max_us;
+} current_sense_stats_t;
+
+// Konfiguracja ADC i start próbkowania
+esp_err_t current_sense_init(current_sense_stall_cb_t cb, void *arg);
+
+// Stan mostka (z zadania). Po włączeniu detekcja jest wygaszona na
+// CONFIG_MOTOR_STALL_BLANK_MS - prąd rozruchu przekracza próg utyku.
+void current_sense_set_driven(bool driven);
+
+// Mostek odcięty po utyku - zapis opóźnienia detekcji. Zwraca false,
+// gdy utyku nie zgłoszono (np. już obsłużony inną drogą).
+bool current_sense_stall_cut(void);
+
+void current_sense_get_stats(current_sense_stats_t *stats);
@@ -0,0 +1,138 @@
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "driver/pulse_cnt.h"
+#include "encoder.h"
+
+static const char *TAG = "encoder";
+
+// Zakres licznika sprzętowego; po jego osiągnięciu sterownik przenosi
+// wartość do akumulatora (flags.accum_count)
+#define ENCODER_PCNT_LIMIT 30000
+// Impulsy krótsze są odrzucane jako zakłócenia z mostka
+#define ENCODER_GLITCH_NS 1000
+
+static pcnt_unit_handle_t s_unit;
+
+// Pozycja odpowiadająca zeru licznika. Przy uzbrajaniu celu zero
+// przesuwa się do bieżącej pozycji, aby punkt obserwacji (liczony
+// od zera licznika) mieścił się w jego zakresie.
+static portMUX_TYPE s_encoder_lock = portMUX_INITIALIZER_UNLOCKED;
+static int32_t s_offset;
+static int s_watch;             // punkt obserwacji celu, 0 - nieuzbrojony
+static encoder_reach_cb_t s_reach_cb;
+static void *s_reach_arg;
+
+// Punkt obserwacji osiągnięty (przerwanie PCNT); punkty na granicach
+// zakresu obsługuje akumulacja sterownika
+static bool IRAM_ATTR encoder_on_reach(pcnt_unit_handle_t unit, const pcnt_watch_event_data_t *edata, void *user_ctx)
+{
+    if (s_watch == 0 || edata->watch_point_value != s_watch || s_reach_cb == NULL) {
+        return false;
+    }
+    return s_reach_cb(s_reach_arg);
+}
+
+esp_err_t encoder_init(void)
+{
+    pcnt_unit_config_t unit_config = {
+        .high_limit = ENCODER_PCNT_LIMIT,
+        .low_limit = -ENCODER_PCNT_LIMIT,
+        .flags.accum_count = true
+    };
+    ESP_ERROR_CHECK(pcnt_new_unit(&unit_config, &s_unit));
+
+    pcnt_glitch_filter_config_t filter_config = {
+        .max_glitch_ns = ENCODER_GLITCH_NS
+    };
+    ESP_ERROR_CHECK(pcnt_unit_set_glitch_filter(s_unit, &filter_config));
+
+    // Dekodowanie x4: każdy kanał liczy zbocza jednego sygnału,
+    // a poziom drugiego wyznacza kierunek
+    pcnt_chan_config_t chan_a_config = {
+        .edge_gpio_num = CONFIG_ENCODER_GPIO_A,
+        .level_gpio_num = CONFIG_ENCODER_GPIO_B
+    };
+    pcnt_channel_handle_t chan_a;
+    ESP_ERROR_CHECK(pcnt_new_channel(s_unit, &chan_a_config, &chan_a));
+
+    pcnt_chan_config_t chan_b_config = {
+        .edge_gpio_num = CONFIG_ENCODER_GPIO_B,
+        .level_gpio_num = CONFIG_ENCODER_GPIO_A
+    };
+    pcnt_channel_handle_t chan_b;
+    ESP_ERROR_CHECK(pcnt_new_channel(s_unit, &chan_b_config, &chan_b));
+
+    ESP_ERROR_CHECK(pcnt_channel_set_edge_action(chan_a, PCNT_CHANNEL_EDGE_ACTION_DECREASE, PCNT_CHANNEL_EDGE_ACTION_INCREASE));
+    ESP_ERROR_CHECK(pcnt_channel_set_level_action(chan_a, PCNT_CHANNEL_LEVEL_ACTION_KEEP, PCNT_CHANNEL_LEVEL_ACTION_INVERSE));
+    ESP_ERROR_CHECK(pcnt_channel_set_edge_action(chan_b, PCNT_CHANNEL_EDGE_ACTION_INCREASE, PCNT_CHANNEL_EDGE_ACTION_DECREASE));
+    ESP_ERROR_CHECK(pcnt_channel_set_level_action(chan_b, PCNT_CHANNEL_LEVEL_ACTION_KEEP, PCNT_CHANNEL_LEVEL_ACTION_INVERSE));
+
+    // Punkty na granicach zakresu są wymagane do akumulacji przepełnień
+    ESP_ERROR_CHECK(pcnt_unit_add_watch_point(s_unit, ENCODER_PCNT_LIMIT));
+    ESP_ERROR_CHECK(pcnt_unit_add_watch_point(s_unit, -ENCODER_PCNT_LIMIT));
+
+    // Callback można zarejestrować tylko przed włączeniem jednostki
+    pcnt_event_callbacks_t cbs = {
+        .on_reach = encoder_on_reach
+    };
+    ESP_ERROR_CHECK(pcnt_unit_register_event_callbacks(s_unit, &cbs, NULL));
+
+    ESP_ERROR_CHECK(pcnt_unit_enable(s_unit));
+    ESP_ERROR_CHECK(pcnt_unit_clear_count(s_unit));
+    ESP_ERROR_CHECK(pcnt_unit_start(s_unit));
+
+    ESP_LOGI(TAG, "Enkoder: A GPIO%d, B GPIO%d, %d zliczeń/obrót",
+             CONFIG_ENCODER_GPIO_A, CONFIG_ENCODER_GPIO_B, CONFIG_ENCODER_CPR);
+    return ESP_OK;
+}
+
+int32_t encoder_get_count(void)
+{
+    int count = 0;
+    portENTER_CRITICAL(&s_encoder_lock);
+    pcnt_unit_get_count(s_unit, &count);
+    int32_t pos = s_offset + count;
+    portEXIT_CRITICAL(&s_encoder_lock);
+    return pos;
+}
+
+esp_err_t encoder_set_target(int32_t target, encoder_reach_cb_t cb, void *arg)
+{
+    encoder_clear_target();
+
+    int count = 0;
+    portENTER_CRITICAL(&s_encoder_lock);
+    pcnt_unit_get_count(s_unit, &count);
+    int32_t delta = target - (s_offset + count);
+    if (delta != 0 && delta <= ENCODER_MAX_MOVE && delta >= -ENCODER_MAX_MOVE) {
+        s_offset += count;
+        pcnt_unit_clear_count(s_unit);
+    }
+    portEXIT_CRITICAL(&s_encoder_lock);
+
+    if (delta == 0 || delta > ENCODER_MAX_MOVE || delta < -ENCODER_MAX_MOVE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    s_reach_cb = cb;
+    s_reach_arg = arg;
+    esp_err_t err = pcnt_unit_add_watch_point(s_unit, delta);
+    if (err != ESP_OK) {
+        s_reach_cb = NULL;
+        return err;
+    }
+    s_watch = delta;
+    return ESP_OK;
+}
+
+void encoder_clear_target(void)
+{
+    if (s_watch == 0) {
+        return;
+    }
+    int watch = s_watch;
+    s_watch = 0;
+    s_reach_cb = NULL;
+    pcnt_unit_remove_watch_point(s_unit, watch);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// Enkoder kwadraturowy silnika na liczniku impulsów (PCNT).
+// Oba kanały zliczają oba zbocza - CONFIG_ENCODER_CPR to liczba
+// zliczeń (x4) na obrót wału. Dodatnie zliczanie = kierunek FORWARD.
+// Przy CONFIG_MOTOR_HW_SIM pozycja wynika z modelu silnika zasilanego
+// symulowanym wypełnieniem (encoder_sim.c).
+
+// Największa odległość celu od bieżącej pozycji - punkt obserwacji
+// musi się zmieścić w zakresie licznika sprzętowego
+#define ENCODER_MAX_MOVE 29999
+
+// Osiągnięcie celu - wywoływane z przerwania PCNT (lub zadania esp_timer
+// w symulacji), więc nie może blokować. Zwraca true, gdy trzeba przełączyć zadanie.
+typedef bool (*encoder_reach_cb_t)(void *arg);
+
+// Konfiguracja jednostki PCNT, filtra zakłóceń i start zliczania
+esp_err_t encoder_init(void);
+
+// Pozycja w zliczeniach od startu, z przepełnieniami licznika sprzętowego
+int32_t encoder_get_count(void);
+
+// Uzbrojenie punktu obserwacji w pozycji target (bezwzględnej).
+// ESP_ERR_INVALID_ARG, gdy cel jest dalej niż ENCODER_MAX_MOVE.
+esp_err_t encoder_set_target(int32_t target, encoder_reach_cb_t cb, void *arg);
+
+// Rozbrojenie punktu obserwacji (z zadania)
+void encoder_clear_target(void);
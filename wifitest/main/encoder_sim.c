@@ -0,0 +1,102 @@
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "motor.h"
+#include "motor_hw.h"
+#include "encoder.h"
+
+// Enkoder w symulacji: silnik pierwszego rzędu zasilany symulowanym
+// wypełnieniem mostka. Prędkość ustalona jest proporcjonalna do
+// wypełnienia (PWM_DUTY = CONFIG_MOTOR_MAX_RPM), a po odcięciu silnik
+// wybiega ze stałą czasową ENCODER_SIM_TAU_US - tak jak prawdziwy wał
+// przejeżdża cel o kilka zliczeń.
+
+static const char *TAG = "encoder_sim";
+
+#define ENCODER_SIM_PERIOD_US 1000
+#define ENCODER_SIM_TAU_US 50000
+
+static esp_timer_handle_t s_timer;
+static portMUX_TYPE s_encoder_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t s_pos_ucounts;   // pozycja w milionowych częściach zliczenia
+static int64_t s_speed_cps;     // prędkość w zliczeniach na sekundę
+static int32_t s_watch;
+static bool s_watch_armed;
+static encoder_reach_cb_t s_reach_cb;
+static void *s_reach_arg;
+
+// Krok modelu (zadanie esp_timer); przejście przez cel odpowiada
+// przerwaniu punktu obserwacji PCNT
+static void encoder_sim_step(void *arg)
+{
+    int64_t duty = (int64_t)motor_hw_get_duty(MOTOR_PRIMARY, MOTOR_HW_IN1) -
+                   (int64_t)motor_hw_get_duty(MOTOR_PRIMARY, MOTOR_HW_IN2);
+    int64_t target_cps = duty * CONFIG_MOTOR_MAX_RPM * CONFIG_ENCODER_CPR / (60 * PWM_DUTY);
+    encoder_reach_cb_t cb = NULL;
+
+    portENTER_CRITICAL(&s_encoder_lock);
+    // Gdy krok zaokrągla się do zera, prędkość dochodzi do ustalonej
+    int64_t step = (target_cps - s_speed_cps) * ENCODER_SIM_PERIOD_US / ENCODER_SIM_TAU_US;
+    s_speed_cps = (step == 0) ? target_cps : s_speed_cps + step;
+    int32_t before = (int32_t)(s_pos_ucounts / 1000000);
+    s_pos_ucounts += s_speed_cps * ENCODER_SIM_PERIOD_US;
+    int32_t after = (int32_t)(s_pos_ucounts / 1000000);
+
+    if (s_watch_armed && before != after &&
+        ((before < s_watch && after >= s_watch) || (before > s_watch && after <= s_watch))) {
+        s_watch_armed = false;
+        cb = s_reach_cb;
+    }
+    portEXIT_CRITICAL(&s_encoder_lock);
+
+    if (cb) {
+        cb(s_reach_arg);
+    }
+}
+
+esp_err_t encoder_init(void)
+{
+    const esp_timer_create_args_t timer_args = {
+        .callback = encoder_sim_step,
+        .name = "encoder_sim"
+    };
+    esp_err_t err = esp_timer_create(&timer_args, &s_timer);
+    if (err != ESP_OK) {
+        return err;
+    }
+    ESP_LOGI(TAG, "Symulacja enkodera: %d zliczeń/obrót, %d obr/min przy pełnym wypełnieniu",
+             CONFIG_ENCODER_CPR, CONFIG_MOTOR_MAX_RPM);
+    return esp_timer_start_periodic(s_timer, ENCODER_SIM_PERIOD_US);
+}
+
+int32_t encoder_get_count(void)
+{
+    portENTER_CRITICAL(&s_encoder_lock);
+    int32_t pos = (int32_t)(s_pos_ucounts / 1000000);
+    portEXIT_CRITICAL(&s_encoder_lock);
+    return pos;
+}
+
+esp_err_t encoder_set_target(int32_t target, encoder_reach_cb_t cb, void *arg)
+{
+    int32_t delta = target - encoder_get_count();
+    if (delta == 0 || delta > ENCODER_MAX_MOVE || delta < -ENCODER_MAX_MOVE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&s_encoder_lock);
+    s_watch = target;
+    s_reach_cb = cb;
+    s_reach_arg = arg;
+    s_watch_armed = true;
+    portEXIT_CRITICAL(&s_encoder_lock);
+    return ESP_OK;
+}
+
+void encoder_clear_target(void)
+{
+    portENTER_CRITICAL(&s_encoder_lock);
+    s_watch_armed = false;
+    s_reach_cb = NULL;
+    portEXIT_CRITICAL(&s_encoder_lock);
+}
@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "http_pool.h"
+
+static const char *TAG = "http_pool";
+
+// Trasy w puli i żądania czekające na wolne zadanie
+#define HTTP_POOL_ROUTES_MAX 8
+#define HTTP_POOL_QUEUE_LEN 4
+// Priorytet jak zadanie serwera (HTTPD_DEFAULT_CONFIG)
+#define HTTP_POOL_TASK_PRIO (tskIDLE_PRIORITY + 5)
+
+#if CONFIG_HTTP_WORKER_CORE < 0
+#define HTTP_POOL_CORE tskNO_AFFINITY
+#else
+#define HTTP_POOL_CORE CONFIG_HTTP_WORKER_CORE
+#endif
+
+// Właściwy handler trasy - user_ctx zarejestrowanego URI wskazuje na wpis
+typedef struct {
+    esp_err_t (*handler)(httpd_req_t *req);
+    void *user_ctx;
+} http_pool_route_t;
+
+typedef struct {
+    httpd_req_t *req;       // kopia z httpd_req_async_handler_begin
+    const http_pool_route_t *route;
+} http_pool_job_t;
+
+static http_pool_route_t s_routes[HTTP_POOL_ROUTES_MAX];
+static size_t s_route_count;
+static QueueHandle_t s_jobs;
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static http_pool_stats_t s_stats = { .workers = CONFIG_HTTP_WORKERS };
+
+#if CONFIG_HTTP_WORKERS > 0
+static void http_pool_worker(void *arg)
+{
+    http_pool_job_t job;
+
+    for (;;) {
+        if (xQueueReceive(s_jobs, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        portENTER_CRITICAL(&s_stats_lock);
+        s_stats.busy++;
+        portEXIT_CRITICAL(&s_stats_lock);
+
+        job.req->user_ctx = job.route->user_ctx;
+        // Błąd handlera zamyka połączenie jak w zadaniu serwera
+        if (job.route->handler(job.req) != ESP_OK) {
+            httpd_sess_trigger_close(job.req->handle, httpd_req_to_sockfd(job.req));
+        }
+        httpd_req_async_handler_complete(job.req);
+
+        portENTER_CRITICAL(&s_stats_lock);
+        s_stats.busy--;
+        s_stats.handled++;
+        portEXIT_CRITICAL(&s_stats_lock);
+    }
+}
+#endif
+
+// Handler trasy w zadaniu serwera: przekazanie kopii żądania do puli.
+// Pełna kolejka to 503 od razu - zadanie serwera nigdy nie czeka.
+static esp_err_t http_pool_dispatch(httpd_req_t *req)
+{
+    const http_pool_route_t *route = req->user_ctx;
+    httpd_req_t *copy;
+
+    if (httpd_req_async_handler_begin(req, &copy) != ESP_OK) {
+        ESP_LOGW(TAG, "Brak pamięci na kopię żądania %s", req->uri);
+        req->user_ctx = route->user_ctx;
+        return route->handler(req);
+    }
+
+    const http_pool_job_t job = { .req = copy, .route = route };
+    if (xQueueSend(s_jobs, &job, 0) != pdTRUE) {
+        portENTER_CRITICAL(&s_stats_lock);
+        s_stats.rejected++;
+        portEXIT_CRITICAL(&s_stats_lock);
+        httpd_resp_set_status(copy, "503 Service Unavailable");
+        httpd_resp_set_hdr(copy, "Retry-After", "1");
+        httpd_resp_send(copy, "Serwer zajęty", HTTPD_RESP_USE_STRLEN);
+        httpd_req_async_handler_complete(copy);
+    }
+    return ESP_OK;
+}
+
+esp_err_t http_pool_init(void)
+{
+#if CONFIG_HTTP_WORKERS > 0
+    s_jobs = xQueueCreate(HTTP_POOL_QUEUE_LEN, sizeof(http_pool_job_t));
+    if (s_jobs == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (int i = 0; i < CONFIG_HTTP_WORKERS; i++) {
+        char name[configMAX_TASK_NAME_LEN];
+        snprintf(name, sizeof(name), "httpw%d", i);
+        if (xTaskCreatePinnedToCore(http_pool_worker, name, CONFIG_HTTP_WORKER_STACK, NULL,
+                                    HTTP_POOL_TASK_PRIO, NULL, HTTP_POOL_CORE) != pdPASS) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    ESP_LOGI(TAG, "Pula HTTP: %d zadań, stos %d B", CONFIG_HTTP_WORKERS, CONFIG_HTTP_WORKER_STACK);
+#endif
+    return ESP_OK;
+}
+
+esp_err_t http_pool_register(httpd_handle_t server, const httpd_uri_t *uri)
+{
+    if (s_jobs == NULL) {
+        return httpd_register_uri_handler(server, uri);
+    }
+    if (s_route_count >= HTTP_POOL_ROUTES_MAX) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    http_pool_route_t *route = &s_routes[s_route_count++];
+    route->handler = uri->handler;
+    route->user_ctx = uri->user_ctx;
+
+    httpd_uri_t pooled = *uri;
+    pooled.handler = http_pool_dispatch;
+    pooled.user_ctx = route;
+    return httpd_register_uri_handler(server, &pooled);
+}
+
+void http_pool_get_stats(http_pool_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_stats_lock);
+    stats->queued = s_jobs ? (uint32_t)uxQueueMessagesWaiting(s_jobs) : 0;
+}
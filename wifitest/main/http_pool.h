@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+// Pula zadań roboczych serwera HTTP dla tras długich lub strumieniowych
+// (ciało od wolnego klienta, zapis NVS). Handler takiej trasy dostaje
+// kopię żądania z httpd_req_async_handler_begin i wykonuje się w jednym
+// z CONFIG_HTTP_WORKERS zadań, a zadanie serwera od razu wraca do
+// pozostałych gniazd. Szybkie trasy zostają w zadaniu serwera.
+// Handlery trasy w puli mogą się wykonywać równolegle - nie mogą
+// korzystać z buforów statycznych bez blokady.
+
+// Liczniki do telemetrii
+typedef struct {
+    uint32_t workers;       // CONFIG_HTTP_WORKERS (0 - pula wyłączona)
+    uint32_t busy;          // zadania obsługujące teraz żądanie
+    uint32_t queued;        // żądania czekające na wolne zadanie
+    uint32_t handled;
+    uint32_t rejected;      // 503 przy pełnej kolejce puli
+} http_pool_stats_t;
+
+// Uruchomienie zadań puli (przed rejestracją tras)
+esp_err_t http_pool_init(void);
+
+// Rejestracja trasy obsługiwanej w puli; przy CONFIG_HTTP_WORKERS = 0
+// zwykła rejestracja w zadaniu serwera. user_ctx trasy trafia do handlera.
+esp_err_t http_pool_register(httpd_handle_t server, const httpd_uri_t *uri);
+
+void http_pool_get_stats(http_pool_stats_t *stats);
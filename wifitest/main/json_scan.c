@@ -0,0 +1,280 @@
+#include <string.h>
+#include "json_scan.h"
+
+typedef enum {
+    SCAN_OBJECT,            // przed '{' albo '['
+    SCAN_ELEMENT,           // w tablicy przed '{' (albo ']' w pustej)
+    SCAN_ELEMENT_NEXT,      // w tablicy po obiekcie: ',' albo ']'
+    SCAN_KEY_START,         // przed kluczem (albo '}' w pustym obiekcie)
+    SCAN_KEY,
+    SCAN_KEY_ESCAPE,
+    SCAN_COLON,
+    SCAN_VALUE_START,
+    SCAN_STRING,
+    SCAN_STRING_ESCAPE,
+    SCAN_LITERAL,           // liczba, true, false, null
+    SCAN_NEXT,              // po wartości: ',' albo '}'
+    SCAN_DONE,
+} scan_state_t;
+
+static bool scan_is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool scan_is_literal(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' || c == '+' || c == '.' || c == 'E';
+}
+
+// Znak po '\' - tylko krótkie sekwencje
+static int scan_unescape(char c)
+{
+    switch (c) {
+    case '"':
+    case '\\':
+    case '/':
+        return c;
+    case 'b':
+        return '\b';
+    case 'f':
+        return '\f';
+    case 'n':
+        return '\n';
+    case 'r':
+        return '\r';
+    case 't':
+        return '\t';
+    default:
+        return -1;
+    }
+}
+
+static esp_err_t scan_append(char *dst, size_t *len, size_t max, char c)
+{
+    if (*len + 1 >= max) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    dst[(*len)++] = c;
+    dst[*len] = '\0';
+    return ESP_OK;
+}
+
+static esp_err_t scan_emit_literal(json_scan_t *scan)
+{
+    const char *v = scan->value;
+    json_scan_type_t type;
+    if (strcmp(v, "true") == 0) {
+        type = JSON_SCAN_TRUE;
+    } else if (strcmp(v, "false") == 0) {
+        type = JSON_SCAN_FALSE;
+    } else if (strcmp(v, "null") == 0) {
+        type = JSON_SCAN_NULL;
+    } else if (v[0] == '-' || (v[0] >= '0' && v[0] <= '9')) {
+        type = JSON_SCAN_NUMBER;
+    } else {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return scan->cb(scan->key, type, v, scan->arg);
+}
+
+void json_scan_init(json_scan_t *scan, json_scan_field_cb_t cb, void *arg)
+{
+    *scan = (json_scan_t){
+        .state = SCAN_OBJECT,
+        .cb = cb,
+        .arg = arg
+    };
+}
+
+void json_scan_set_object_cb(json_scan_t *scan, json_scan_object_cb_t cb)
+{
+    scan->object_cb = cb;
+}
+
+// Zamknięcie obiektu: w tablicy czekają kolejne elementy
+static esp_err_t scan_end_object(json_scan_t *scan)
+{
+    scan->state = scan->array ? SCAN_ELEMENT_NEXT : SCAN_DONE;
+    return scan->object_cb ? scan->object_cb(scan->arg) : ESP_OK;
+}
+
+// Jeden znak; literał kończy dopiero znak spoza niego, który jest
+// potem przetwarzany jeszcze raz w stanie SCAN_NEXT
+static esp_err_t scan_char(json_scan_t *scan, char c)
+{
+    switch ((scan_state_t)scan->state) {
+    case SCAN_OBJECT:
+        if (scan_is_space(c)) {
+            return ESP_OK;
+        }
+        if (c == '[') {
+            scan->array = true;
+            scan->state = SCAN_ELEMENT;
+            return ESP_OK;
+        }
+        if (c != '{') {
+            return ESP_ERR_INVALID_ARG;
+        }
+        scan->state = SCAN_KEY_START;
+        return ESP_OK;
+
+    case SCAN_ELEMENT:
+        if (scan_is_space(c)) {
+            return ESP_OK;
+        }
+        if (c == ']' && !scan->any) {
+            scan->state = SCAN_DONE;
+            return ESP_OK;
+        }
+        if (c != '{') {
+            return (c == '[') ? ESP_ERR_NOT_SUPPORTED : ESP_ERR_INVALID_ARG;
+        }
+        scan->any = false;
+        scan->state = SCAN_KEY_START;
+        return ESP_OK;
+
+    case SCAN_ELEMENT_NEXT:
+        if (scan_is_space(c)) {
+            return ESP_OK;
+        }
+        if (c == ',') {
+            // Po przecinku musi być obiekt - ']' zamyka tylko pustą tablicę
+            scan->any = true;
+            scan->state = SCAN_ELEMENT;
+            return ESP_OK;
+        }
+        if (c == ']') {
+            scan->state = SCAN_DONE;
+            return ESP_OK;
+        }
+        return ESP_ERR_INVALID_ARG;
+
+    case SCAN_KEY_START:
+        if (scan_is_space(c)) {
+            return ESP_OK;
+        }
+        if (c == '}' && !scan->any) {
+            return scan_end_object(scan);
+        }
+        if (c != '"') {
+            return ESP_ERR_INVALID_ARG;
+        }
+        scan->key_len = 0;
+        scan->key[0] = '\0';
+        scan->state = SCAN_KEY;
+        return ESP_OK;
+
+    case SCAN_KEY:
+        if (c == '"') {
+            scan->state = SCAN_COLON;
+            return ESP_OK;
+        }
+        if (c == '\\') {
+            scan->state = SCAN_KEY_ESCAPE;
+            return ESP_OK;
+        }
+        return scan_append(scan->key, &scan->key_len, sizeof(scan->key), c);
+
+    case SCAN_KEY_ESCAPE:
+    case SCAN_STRING_ESCAPE: {
+        int u = scan_unescape(c);
+        if (u < 0) {
+            return (c == 'u') ? ESP_ERR_NOT_SUPPORTED : ESP_ERR_INVALID_ARG;
+        }
+        if (scan->state == SCAN_KEY_ESCAPE) {
+            scan->state = SCAN_KEY;
+            return scan_append(scan->key, &scan->key_len, sizeof(scan->key), (char)u);
+        }
+        scan->state = SCAN_STRING;
+        return scan_append(scan->value, &scan->value_len, sizeof(scan->value), (char)u);
+    }
+
+    case SCAN_COLON:
+        if (scan_is_space(c)) {
+            return ESP_OK;
+        }
+        if (c != ':') {
+            return ESP_ERR_INVALID_ARG;
+        }
+        scan->state = SCAN_VALUE_START;
+        return ESP_OK;
+
+    case SCAN_VALUE_START:
+        if (scan_is_space(c)) {
+            return ESP_OK;
+        }
+        scan->value_len = 0;
+        scan->value[0] = '\0';
+        if (c == '"') {
+            scan->state = SCAN_STRING;
+            return ESP_OK;
+        }
+        if (c == '{' || c == '[') {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        if (!scan_is_literal(c)) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        scan->state = SCAN_LITERAL;
+        return scan_append(scan->value, &scan->value_len, sizeof(scan->value), c);
+
+    case SCAN_STRING:
+        if (c == '"') {
+            scan->state = SCAN_NEXT;
+            scan->any = true;
+            return scan->cb(scan->key, JSON_SCAN_STRING, scan->value, scan->arg);
+        }
+        if (c == '\\') {
+            scan->state = SCAN_STRING_ESCAPE;
+            return ESP_OK;
+        }
+        if ((unsigned char)c < 0x20) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        return scan_append(scan->value, &scan->value_len, sizeof(scan->value), c);
+
+    case SCAN_LITERAL: {
+        if (scan_is_literal(c)) {
+            return scan_append(scan->value, &scan->value_len, sizeof(scan->value), c);
+        }
+        scan->state = SCAN_NEXT;
+        scan->any = true;
+        esp_err_t err = scan_emit_literal(scan);
+        return (err == ESP_OK) ? scan_char(scan, c) : err;
+    }
+
+    case SCAN_NEXT:
+        if (scan_is_space(c)) {
+            return ESP_OK;
+        }
+        if (c == ',') {
+            scan->state = SCAN_KEY_START;
+            return ESP_OK;
+        }
+        if (c == '}') {
+            return scan_end_object(scan);
+        }
+        return ESP_ERR_INVALID_ARG;
+
+    case SCAN_DONE:
+        return scan_is_space(c) ? ESP_OK : ESP_ERR_INVALID_ARG;
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t json_scan_feed(json_scan_t *scan, const char *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        esp_err_t err = scan_char(scan, buf[i]);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t json_scan_finish(json_scan_t *scan)
+{
+    return (scan->state == SCAN_DONE) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
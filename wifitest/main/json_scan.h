@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// Strumieniowy parser płaskiego obiektu JSON (albo tablicy takich obiektów)
+// bez sterty. Ciało żądania można podawać dowolnymi kawałkami prosto
+// z httpd_req_recv; każde pole trafia do callbacku zaraz po odczytaniu
+// wartości, a koniec każdego obiektu - do json_scan_object_cb_t.
+// Głębsze zagnieżdżenie nie jest obsługiwane, tak jak sekwencje \uXXXX.
+
+// Najdłuższy klucz i wartość (z terminatorem)
+#define JSON_SCAN_KEY_MAX   16
+#define JSON_SCAN_VALUE_MAX 24
+
+typedef enum {
+    JSON_SCAN_STRING,
+    JSON_SCAN_NUMBER,       // tekst liczby, do zamiany przez odbiorcę
+    JSON_SCAN_TRUE,
+    JSON_SCAN_FALSE,
+    JSON_SCAN_NULL,
+} json_scan_type_t;
+
+// Pole obiektu; błąd przerywa parsowanie i wraca z json_scan_feed
+typedef esp_err_t (*json_scan_field_cb_t)(const char *key, json_scan_type_t type, const char *value, void *arg);
+
+// Koniec obiektu (w tablicy - każdego elementu)
+typedef esp_err_t (*json_scan_object_cb_t)(void *arg);
+
+typedef struct {
+    int state;
+    bool array;             // na najwyższym poziomie jest tablica obiektów
+    bool any;               // w obiekcie jest już co najmniej jedno pole
+    size_t key_len;
+    size_t value_len;
+    char key[JSON_SCAN_KEY_MAX];
+    char value[JSON_SCAN_VALUE_MAX];
+    json_scan_field_cb_t cb;
+    json_scan_object_cb_t object_cb;
+    void *arg;
+} json_scan_t;
+
+void json_scan_init(json_scan_t *scan, json_scan_field_cb_t cb, void *arg);
+
+// Opcjonalne powiadomienie o końcu obiektu
+void json_scan_set_object_cb(json_scan_t *scan, json_scan_object_cb_t cb);
+
+// Kolejny kawałek tekstu. ESP_ERR_INVALID_ARG - błąd składni,
+// ESP_ERR_INVALID_SIZE - za długi klucz lub wartość, ESP_ERR_NOT_SUPPORTED -
+// zagnieżdżenie lub \u; inne kody pochodzą z callbacku.
+esp_err_t json_scan_feed(json_scan_t *scan, const char *buf, size_t len);
+
+// Koniec danych: ESP_ERR_INVALID_ARG, gdy obiekt lub tablica nie zostały zamknięte
+esp_err_t json_scan_finish(json_scan_t *scan);
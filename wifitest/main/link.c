@@ -0,0 +1,69 @@
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "link.h"
+
+// Stan łącza i powiadamianie odbiorców - wspólne dla obu implementacji
+
+static const char *TAG = "link";
+
+static portMUX_TYPE s_link_lock = portMUX_INITIALIZER_UNLOCKED;
+static link_state_t s_state = LINK_STATE_DOWN;
+
+static struct {
+    link_state_cb_t cb;
+    void *arg;
+} s_subscribers[LINK_MAX_SUBSCRIBERS];
+
+static const char *s_state_names[] = {
+    [LINK_STATE_DOWN] = "down",
+    [LINK_STATE_CONNECTING] = "connecting",
+    [LINK_STATE_ASSOCIATED] = "associated",
+    [LINK_STATE_UP] = "up",
+    [LINK_STATE_BACKOFF] = "backoff",
+};
+
+const char *link_state_name(link_state_t state)
+{
+    return state <= LINK_STATE_BACKOFF ? s_state_names[state] : "?";
+}
+
+link_state_t link_get_state(void)
+{
+    return s_state;
+}
+
+esp_err_t link_subscribe(link_state_cb_t cb, void *arg)
+{
+    esp_err_t err = ESP_ERR_NO_MEM;
+
+    portENTER_CRITICAL(&s_link_lock);
+    for (int i = 0; i < LINK_MAX_SUBSCRIBERS; i++) {
+        if (s_subscribers[i].cb == NULL) {
+            s_subscribers[i].cb = cb;
+            s_subscribers[i].arg = arg;
+            err = ESP_OK;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_link_lock);
+    return err;
+}
+
+void link_set_state(link_state_t state)
+{
+    portENTER_CRITICAL(&s_link_lock);
+    bool changed = (s_state != state);
+    s_state = state;
+    portEXIT_CRITICAL(&s_link_lock);
+
+    if (!changed) {
+        return;
+    }
+    ESP_LOGI(TAG, "Łącze: %s", link_state_name(state));
+    for (int i = 0; i < LINK_MAX_SUBSCRIBERS; i++) {
+        if (s_subscribers[i].cb) {
+            s_subscribers[i].cb(state, s_subscribers[i].arg);
+        }
+    }
+}
+
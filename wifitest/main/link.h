@@ -0,0 +1,42 @@
+#pragma once
+
+#include "esp_err.h"
+
+// Łącze sieciowe: Wi-Fi STA (link_wifi.c) albo w kompilacji na hosta
+// symulacja, w której sieć jest dostępna od razu (link_sim.c).
+
+// Stan łącza Wi-Fi
+typedef enum {
+    LINK_STATE_DOWN,        // sterownik nie wystartował
+    LINK_STATE_CONNECTING,  // trwa skanowanie / asocjacja
+    LINK_STATE_ASSOCIATED,  // połączono z AP, brak adresu IP
+    LINK_STATE_UP,          // jest adres IP
+    LINK_STATE_BACKOFF,     // rozłączono, czekamy na kolejną próbę
+} link_state_t;
+
+// Powiadomienie o zmianie stanu - wywoływane z zadania pętli zdarzeń
+// albo z zadania esp_timer, więc nie może blokować
+typedef void (*link_state_cb_t)(link_state_t state, void *arg);
+
+#define LINK_MAX_SUBSCRIBERS 4
+
+// Stos TCP/IP, domyślna pętla zdarzeń i interfejs STA.
+// Po tym etapie serwer HTTP może już nasłuchiwać.
+esp_err_t link_netif_init(void);
+
+// Start sterownika Wi-Fi. Nie czeka na połączenie - łączenie
+// i ponawianie z wykładniczym odstępem odbywa się w tle.
+esp_err_t link_start(void);
+
+// Rejestracja odbiorcy zmian stanu łącza
+esp_err_t link_subscribe(link_state_cb_t cb, void *arg);
+
+link_state_t link_get_state(void);
+
+// Siła sygnału AP w dBm, 0 gdy brak połączenia
+int link_get_rssi(void);
+
+const char *link_state_name(link_state_t state);
+
+// Zmiana stanu z powiadomieniem odbiorców - tylko dla implementacji łącza
+void link_set_state(link_state_t state);
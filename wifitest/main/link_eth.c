@@ -0,0 +1,65 @@
+#include <inttypes.h>
+#include "esp_event.h"
+#include "esp_eth.h"
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
+#include "link.h"
+
+// Łącze Ethernet open_eth emulowane przez QEMU (CONFIG_LINK_OPENETH).
+// Adres z DHCP sieci użytkownika QEMU; ta sama maszyna stanów co Wi-Fi.
+
+static const char *TAG = "link_eth";
+
+static esp_netif_t *s_eth_netif;
+static esp_eth_handle_t s_eth;
+
+static void eth_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
+{
+    if (event_base == ETH_EVENT && event_id == ETHERNET_EVENT_START) {
+        link_set_state(LINK_STATE_CONNECTING);
+    } else if (event_base == ETH_EVENT && event_id == ETHERNET_EVENT_CONNECTED) {
+        link_set_state(LINK_STATE_ASSOCIATED);
+    } else if (event_base == ETH_EVENT && event_id == ETHERNET_EVENT_DISCONNECTED) {
+        link_set_state(LINK_STATE_CONNECTING);
+    } else if (event_base == IP_EVENT && event_id == IP_EVENT_ETH_GOT_IP) {
+        ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
+        ESP_LOGI(TAG, "got ip:" IPSTR " po %" PRId64 " ms od startu", IP2STR(&event->ip_info.ip),
+                 esp_timer_get_time() / 1000);
+        link_set_state(LINK_STATE_UP);
+    }
+}
+
+esp_err_t link_netif_init(void)
+{
+    ESP_ERROR_CHECK(esp_netif_init());
+    ESP_ERROR_CHECK(esp_event_loop_create_default());
+    esp_netif_config_t cfg = ESP_NETIF_DEFAULT_ETH();
+    s_eth_netif = esp_netif_new(&cfg);
+    return s_eth_netif ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t link_start(void)
+{
+    eth_mac_config_t mac_config = ETH_MAC_DEFAULT_CONFIG();
+    eth_phy_config_t phy_config = ETH_PHY_DEFAULT_CONFIG();
+    // PHY w QEMU nie negocjuje, nie ma na co czekać
+    phy_config.autonego_timeout_ms = 100;
+
+    esp_eth_mac_t *mac = esp_eth_mac_new_openeth(&mac_config);
+    esp_eth_phy_t *phy = esp_eth_phy_new_dp83848(&phy_config);
+    esp_eth_config_t config = ETH_DEFAULT_CONFIG(mac, phy);
+    ESP_ERROR_CHECK(esp_eth_driver_install(&config, &s_eth));
+    ESP_ERROR_CHECK(esp_netif_attach(s_eth_netif, esp_eth_new_netif_glue(s_eth)));
+
+    ESP_ERROR_CHECK(esp_event_handler_register(ETH_EVENT, ESP_EVENT_ANY_ID, &eth_event_handler, NULL));
+    ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_ETH_GOT_IP, &eth_event_handler, NULL));
+
+    ESP_LOGI(TAG, "Start open_eth (QEMU)");
+    return esp_eth_start(s_eth);
+}
+
+int link_get_rssi(void)
+{
+    return 0;
+}
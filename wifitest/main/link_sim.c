@@ -0,0 +1,29 @@
+#include "esp_event.h"
+#include "esp_log.h"
+#include "link.h"
+
+// Łącze w kompilacji na hosta: serwer HTTP korzysta z gniazd systemu,
+// więc sieć jest gotowa od razu, bez Wi-Fi i DHCP
+
+static const char *TAG = "link_sim";
+
+// Stała wartość, aby telemetria z symulacji była powtarzalna
+#define LINK_SIM_RSSI (-50)
+
+esp_err_t link_netif_init(void)
+{
+    return esp_event_loop_create_default();
+}
+
+esp_err_t link_start(void)
+{
+    ESP_LOGI(TAG, "Symulacja łącza - sieć hosta");
+    link_set_state(LINK_STATE_CONNECTING);
+    link_set_state(LINK_STATE_UP);
+    return ESP_OK;
+}
+
+int link_get_rssi(void)
+{
+    return link_get_state() == LINK_STATE_UP ? LINK_SIM_RSSI : 0;
+}
@@ -0,0 +1,248 @@
+#include <string.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "wifi_cache.h"
+#include "link.h"
+
+// Wi-Fi konfiguracja
+#define EXAMPLE_ESP_WIFI_SSID      CONFIG_ESP_WIFI_SSID
+#define EXAMPLE_ESP_WIFI_PASS      CONFIG_ESP_WIFI_PASSWORD
+
+static const char *TAG = "wifi station";
+
+static esp_netif_t *s_sta_netif;
+static bool s_fast_connect;     // trwa próba z zapisanym BSSID, kanałem i IP
+static bool s_fast_connected;   // szybkie połączenie się udało
+static bool s_ap_pinned;        // konfiguracja wskazuje zapisany BSSID i kanał
+static wifi_cache_t s_link;     // parametry bieżącego połączenia
+
+static uint32_t s_attempt;      // kolejne nieudane próby od ostatniego IP
+static esp_timer_handle_t s_backoff_timer;
+
+int link_get_rssi(void)
+{
+    wifi_ap_record_t ap;
+    if (esp_wifi_sta_get_ap_info(&ap) != ESP_OK) {
+        return 0;
+    }
+    return ap.rssi;
+}
+
+// Odstęp przed kolejną próbą: wykładniczy, ograniczony z góry, z losową
+// połową zakresu, aby wiele urządzeń po restarcie AP nie łączyło się naraz.
+// Liczba prób nie jest ograniczona.
+static uint32_t link_backoff_ms(uint32_t attempt)
+{
+    uint32_t ceiling = CONFIG_WIFI_BACKOFF_MAX_MS;
+    if (attempt < 16 && ((uint32_t)CONFIG_WIFI_BACKOFF_MIN_MS << attempt) < ceiling) {
+        ceiling = (uint32_t)CONFIG_WIFI_BACKOFF_MIN_MS << attempt;
+    }
+    return ceiling / 2 + esp_random() % (ceiling / 2 + 1);
+}
+
+static void link_connect(void)
+{
+    link_set_state(LINK_STATE_CONNECTING);
+    esp_err_t err = esp_wifi_connect();
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "esp_wifi_connect: %s", esp_err_to_name(err));
+    }
+}
+
+static void link_backoff_cb(void *arg)
+{
+    link_connect();
+}
+
+static void link_schedule_retry(void)
+{
+    uint32_t delay_ms = link_backoff_ms(s_attempt);
+    s_attempt++;
+    ESP_LOGI(TAG, "retry to connect to the AP za %" PRIu32 " ms (próba %" PRIu32 ")", delay_ms, s_attempt);
+
+    link_set_state(LINK_STATE_BACKOFF);
+    esp_timer_stop(s_backoff_timer);
+    esp_timer_start_once(s_backoff_timer, (uint64_t)delay_ms * 1000);
+}
+
+// Kolejne próby bez zapisanego BSSID i kanału - AP może zmienić kanał
+// albo klient może przejść do innego AP z tym samym SSID
+static void wifi_unpin_ap(void)
+{
+    if (!s_ap_pinned) {
+        return;
+    }
+    s_ap_pinned = false;
+
+    wifi_config_t wifi_config;
+    esp_wifi_get_config(WIFI_IF_STA, &wifi_config);
+    wifi_config.sta.bssid_set = false;
+    wifi_config.sta.channel = 0;
+    esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+}
+
+// Powrót do pełnego skanowania i DHCP. Zapisany wpis jest usuwany
+// tylko wtedy, gdy szybkie połączenie w ogóle się nie udało.
+static void wifi_fast_connect_fallback(void)
+{
+    if (!s_fast_connected) {
+        ESP_LOGW(TAG, "Szybkie połączenie nieudane - pełne skanowanie i DHCP");
+        wifi_cache_clear();
+    }
+    s_fast_connect = false;
+    wifi_unpin_ap();
+    esp_netif_dhcpc_start(s_sta_netif);
+}
+
+// Szybkie połączenie działa na adresie z poprzedniej dzierżawy. DHCP
+// startuje od razu, aby serwer potwierdził (albo zmienił) adres -
+// inaczej statyczny adres zostałby do restartu, także po wygaśnięciu
+// dzierżawy. Adres znika tylko na czas wymiany DHCP, a GOT_IP z nowej
+// dzierżawy zapisuje wpis jak po pełnej ścieżce.
+static void wifi_fast_connect_confirm(void)
+{
+    s_fast_connected = true;
+    s_fast_connect = false;
+    esp_err_t err = esp_netif_dhcpc_start(s_sta_netif);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Nie można uruchomić DHCP: %s", esp_err_to_name(err));
+    }
+}
+
+// Zapis parametrów połączenia uzyskanego pełną ścieżką (skan + DHCP)
+static void wifi_save_link(const ip_event_got_ip_t *event)
+{
+    esp_netif_dns_info_t dns = { 0 };
+    esp_netif_get_dns_info(event->esp_netif, ESP_NETIF_DNS_MAIN, &dns);
+
+    strlcpy(s_link.ssid, EXAMPLE_ESP_WIFI_SSID, sizeof(s_link.ssid));
+    s_link.ip = event->ip_info.ip.addr;
+    s_link.netmask = event->ip_info.netmask.addr;
+    s_link.gw = event->ip_info.gw.addr;
+    s_link.dns = dns.ip.u_addr.ip4.addr;
+    if (wifi_cache_save(&s_link) != ESP_OK) {
+        ESP_LOGW(TAG, "Nie można zapisać parametrów połączenia");
+    }
+}
+
+// Ustawienie docelowego BSSID/kanału i tymczasowego statycznego IP
+// z poprzedniej dzierżawy. Zwraca false, gdy brak zapisanego połączenia.
+static bool wifi_apply_cache(wifi_config_t *wifi_config)
+{
+#if CONFIG_WIFI_FAST_RECONNECT
+    wifi_cache_t cache;
+    if (wifi_cache_load(EXAMPLE_ESP_WIFI_SSID, &cache) != ESP_OK) {
+        return false;
+    }
+
+    wifi_config->sta.channel = cache.channel;
+    wifi_config->sta.bssid_set = true;
+    memcpy(wifi_config->sta.bssid, cache.bssid, sizeof(cache.bssid));
+
+    esp_netif_ip_info_t ip_info = {
+        .ip.addr = cache.ip,
+        .netmask.addr = cache.netmask,
+        .gw.addr = cache.gw
+    };
+    ESP_ERROR_CHECK(esp_netif_dhcpc_stop(s_sta_netif));
+    ESP_ERROR_CHECK(esp_netif_set_ip_info(s_sta_netif, &ip_info));
+    if (cache.dns != 0) {
+        esp_netif_dns_info_t dns = {
+            .ip.u_addr.ip4.addr = cache.dns,
+            .ip.type = ESP_IPADDR_TYPE_V4
+        };
+        esp_netif_set_dns_info(s_sta_netif, ESP_NETIF_DNS_MAIN, &dns);
+    }
+
+    ESP_LOGI(TAG, "Szybkie połączenie: kanał %d, IP " IPSTR, cache.channel, IP2STR(&ip_info.ip));
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Event handler dla Wi-Fi
+static void event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
+        link_connect();
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
+        wifi_event_sta_connected_t* event = (wifi_event_sta_connected_t*) event_data;
+        memcpy(s_link.bssid, event->bssid, sizeof(s_link.bssid));
+        s_link.channel = event->channel;
+        link_set_state(LINK_STATE_ASSOCIATED);
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        wifi_event_sta_disconnected_t* event = (wifi_event_sta_disconnected_t*) event_data;
+        ESP_LOGI(TAG, "connect to the AP fail (reason %d)", event->reason);
+        if (s_fast_connect) {
+            // Inna strategia, a nie powtórka - bez odczekiwania
+            wifi_fast_connect_fallback();
+            link_connect();
+            return;
+        }
+        // Po udanym szybkim połączeniu zwykłe ponowienia z odczekiwaniem,
+        // już bez zapisanego BSSID i kanału
+        wifi_unpin_ap();
+        link_schedule_retry();
+    } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+        ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
+        ESP_LOGI(TAG, "got ip:" IPSTR " po %" PRId64 " ms od startu (%s)", IP2STR(&event->ip_info.ip),
+                 esp_timer_get_time() / 1000, s_fast_connect ? "szybkie połączenie" : "skan + DHCP");
+        if (s_fast_connect) {
+            wifi_fast_connect_confirm();
+        } else {
+            wifi_save_link(event);
+        }
+        s_attempt = 0;
+        link_set_state(LINK_STATE_UP);
+    } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_LOST_IP) {
+        if (link_get_state() == LINK_STATE_UP) {
+            link_set_state(LINK_STATE_ASSOCIATED);
+        }
+    }
+}
+
+esp_err_t link_netif_init(void)
+{
+    ESP_ERROR_CHECK(esp_netif_init());
+    ESP_ERROR_CHECK(esp_event_loop_create_default());
+    s_sta_netif = esp_netif_create_default_wifi_sta();
+    return s_sta_netif ? ESP_OK : ESP_FAIL;
+}
+
+// Funkcja inicjująca Wi-Fi
+esp_err_t link_start(void)
+{
+    const esp_timer_create_args_t backoff_args = {
+        .callback = link_backoff_cb,
+        .name = "link_backoff"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&backoff_args, &s_backoff_timer));
+
+    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_wifi_init(&cfg));
+
+    esp_event_handler_instance_t instance_any_id;
+    esp_event_handler_instance_t instance_ip;
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &event_handler, NULL, &instance_any_id));
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT, ESP_EVENT_ANY_ID, &event_handler, NULL, &instance_ip));
+
+    wifi_config_t wifi_config = {
+        .sta = {
+            .ssid = EXAMPLE_ESP_WIFI_SSID,
+            .password = EXAMPLE_ESP_WIFI_PASS,
+            .threshold.authmode = WIFI_AUTH_WPA2_PSK,
+        },
+    };
+    s_fast_connect = wifi_apply_cache(&wifi_config);
+    s_ap_pinned = s_fast_connect;
+    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
+    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
+    ESP_ERROR_CHECK(esp_wifi_start());
+
+    ESP_LOGI(TAG, "wifi_init_sta finished.");
+    return ESP_OK;
+}
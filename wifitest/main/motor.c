@@ -0,0 +1,1216 @@
+#include <stdio.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "motor.h"
+#include "motor_hw.h"
+#include "motor_ramp.h"
+#include "motor_seq.h"
+#include "motor_queue.h"
+#include "motor_prog.h"
+#include "motor_routine.h"
+#if CONFIG_MOTOR_ENCODER
+#include "encoder.h"
+#include "motor_speed.h"
+#endif
+#if CONFIG_MOTOR_CURRENT_SENSE
+#include "current_sense.h"
+#endif
+#if CONFIG_MOTOR_WATCHDOG
+#include "motor_watchdog.h"
+#endif
+
+static const char *TAG = "motor";
+
+// Zadania silników - priorytet wyższy niż serwer HTTP i stos lwIP (18),
+// bo to one ustawiają mostki na granicach kroków sekwencji
+#define MOTOR_TASK_STACK 3072
+#define MOTOR_TASK_PRIO (configMAX_PRIORITIES - 5)
+
+// Ruch do pozycji: bit powiadomienia zadania silnika (poza bitami
+// sekwencera), domyślny limit czasu i czas na wybieg po odcięciu
+#define MOTOR_MOVE_REACHED_BIT BIT(30)
+#define MOTOR_MOVE_TIMEOUT_MS 10000
+#define MOTOR_MOVE_SETTLE_MS 200
+
+// Utyk i komenda STOP przerywają sekwencję i ruch do pozycji jak granica kroku
+#define MOTOR_STALL_BIT MOTOR_SEQ_ABORT_BIT
+#define MOTOR_PREEMPT_BIT MOTOR_SEQ_ABORT_BIT
+
+// Ruch skoordynowany: czas na zebranie zadań osi i przesunięcie bitów
+// drugiej bariery (koniec ruchu) w grupie zdarzeń. Osie są bezczynne
+// przy wstawieniu ruchu, więc limit to tylko zabezpieczenie.
+#define MOTOR_GROUP_SYNC_MS 1000
+#define MOTOR_GROUP_DONE_SHIFT 8
+#define MOTOR_GROUP_BITS (MOTOR_MASK_ALL | (MOTOR_MASK_ALL << MOTOR_GROUP_DONE_SHIFT))
+
+// Stan jednego silnika - zmieniany tylko przez jego zadanie
+typedef struct {
+    uint8_t id;
+    motor_queue_t queue;
+    TaskHandle_t task;
+    SemaphoreHandle_t fade_done;
+    motor_seq_t seq;
+    uint32_t duty[2];       // aktualne wypełnienie IN1/IN2
+    volatile motor_phase_t phase;
+    volatile motor_dir_t dir;
+
+    // Stan pracy ciągłej (komendy RUN / SET_DUTY / SET_DIR / STOP)
+    bool running;
+    motor_dir_t run_dir;
+    uint32_t run_duty;
+
+    // Program lub procedura w toku (0 - brak), zmieniane pod s_post_lock
+    uint32_t job;
+} motor_t;
+
+static motor_t s_motors[MOTOR_COUNT];
+
+// Regulacja prędkości (komenda SPEED, MOTOR_PRIMARY) - mostkiem steruje zadanie regulatora
+static bool s_speed_mode;
+static uint32_t s_speed_rpm;
+static int32_t s_move_error;
+
+// Ruch skoordynowany w toku - wypełniany przez motor_post_group, czytany
+// przez zadania osi do zwolnienia przez ostatnią z nich
+static struct {
+    motor_group_cmd_t cmd;
+    uint32_t mask;
+    EventGroupHandle_t ev;
+    bool busy;
+    uint32_t left;          // osie, które zakończyły udział (albo ich komendę usunięto)
+    bool aborted;           // ruch przerwany albo osie niezebrane na barierze
+    motor_group_stats_t stats;
+} s_group;
+static portMUX_TYPE s_group_lock = portMUX_INITIALIZER_UNLOCKED;
+// Wstawianie komend z zadań: serwer HTTP, pula HTTP (motor_prog), watchdog
+static SemaphoreHandle_t s_post_lock;
+
+// Funkcja inicjująca PWM
+void pwm_init(void) {
+    ESP_LOGI(TAG, "Inicjalizacja PWM...");
+    ESP_ERROR_CHECK(motor_hw_init());
+    ESP_LOGI(TAG, "PWM skonfigurowane pomyślnie");
+}
+
+// Koniec zanikania na jednym z kanałów (przerwanie LEDC lub symulacja)
+static bool IRAM_ATTR motor_fade_done_cb(uint8_t motor, motor_hw_ch_t ch, void *arg)
+{
+    BaseType_t need_yield = pdFALSE;
+    xSemaphoreGiveFromISR(s_motors[motor].fade_done, &need_yield);
+    return need_yield == pdTRUE;
+}
+
+#if CONFIG_MOTOR_CURRENT_SENSE
+// Utyk (przerwanie ADC). Sekwencja i ruch czekają na powiadomienie,
+// praca ciągła i regulator - na komendę, która jak STOP ma pierwszeństwo.
+static bool IRAM_ATTR motor_stall_cb(void *arg)
+{
+    motor_t *m = &s_motors[MOTOR_PRIMARY];
+    BaseType_t need_yield = pdFALSE;
+    const motor_cmd_t stall = { .type = MOTOR_CMD_STALL };
+    xTaskNotifyFromISR(m->task, MOTOR_STALL_BIT, eSetBits, &need_yield);
+    motor_queue_push(&m->queue, &stall, &need_yield);
+    xSemaphoreGiveFromISR(m->fade_done, &need_yield);
+    return need_yield == pdTRUE;
+}
+#endif
+
+// Stan mostka dla detekcji utyku
+static void motor_sense_driven(const motor_t *m, bool driven)
+{
+#if CONFIG_MOTOR_CURRENT_SENSE
+    if (m->id == MOTOR_PRIMARY) {
+        current_sense_set_driven(driven);
+    }
+#endif
+}
+
+// Wołane po odcięciu mostka - true, gdy przyczyną był utyk
+static bool motor_stall_handled(void)
+{
+#if CONFIG_MOTOR_CURRENT_SENSE
+    return current_sense_stall_cut();
+#else
+    return false;
+#endif
+}
+
+// Faza i kierunek wynikające z ustalonego stanu mostka
+static void motor_update_phase(motor_t *m)
+{
+    motor_sense_driven(m, m->duty[0] > 0 || m->duty[1] > 0);
+    if (m->duty[0] > 0 || m->duty[1] > 0) {
+        m->dir = (m->duty[0] > 0) ? MOTOR_DIR_FORWARD : MOTOR_DIR_REVERSE;
+        m->phase = MOTOR_PHASE_RUN;
+    } else {
+        m->phase = MOTOR_PHASE_IDLE;
+    }
+}
+
+// Ustawienie wypełnienia obu wejść mostka H
+static void motor_set_bridge(motor_t *m, uint32_t in1, uint32_t in2)
+{
+    motor_hw_set(m->id, in1, in2);
+    m->duty[0] = in1;
+    m->duty[1] = in2;
+    motor_update_phase(m);
+}
+
+// Komenda z pierwszeństwem w kolejce albo anulowanie zadania w toku
+static bool motor_preempt_pending(motor_t *m)
+{
+    return motor_queue_priority_pending(&m->queue) || (m->job != 0 && motor_prog_cancelled(m->job));
+}
+
+// Rampa przerwana przez STOP, utyk lub anulowanie: mostek zostaje na
+// wypełnieniu z chwili przerwania, resztę robi obsługa komendy
+// z pierwszeństwem albo koniec zadania
+static bool motor_fade_preempted(motor_t *m)
+{
+    if (!motor_preempt_pending(m)) {
+        return false;
+    }
+    motor_hw_fade_stop(m->id);
+    m->duty[0] = motor_hw_get_duty(m->id, MOTOR_HW_IN1);
+    m->duty[1] = motor_hw_get_duty(m->id, MOTOR_HW_IN2);
+    motor_update_phase(m);
+    return true;
+}
+
+// Przejście mostka do nowego stanu po odcinkach profilu rampy
+// (MOTOR_RAMP_NONE lub zerowy czas - skokowo).
+// Każdy odcinek to zanikanie sprzętowe LEDC bez udziału CPU;
+// zadanie jedynie czeka na przerwania końca zanikania. motor_preempt
+// i utyk też zwalniają fade_done, więc rampa kończy się od razu.
+// Zwraca false, gdy rampę przerwano.
+static bool motor_fade_bridge(motor_t *m, uint32_t in1, uint32_t in2, motor_ramp_t profile, uint32_t ramp_ms)
+{
+    const uint32_t from[2] = { m->duty[0], m->duty[1] };
+    const uint32_t to[2] = { in1, in2 };
+    const size_t segments = motor_ramp_segments(profile, ramp_ms);
+    uint32_t elapsed_ms = 0;
+
+    if (profile == MOTOR_RAMP_NONE || ramp_ms == 0) {
+        motor_set_bridge(m, in1, in2);
+        return true;
+    }
+    // Końce zanikań przerwanych wcześniej i pobudki po obsłużonym STOP
+    while (xSemaphoreTake(m->fade_done, 0) == pdTRUE) {
+    }
+
+    m->phase = MOTOR_PHASE_RAMP;
+    motor_sense_driven(m, in1 > 0 || in2 > 0 || from[0] > 0 || from[1] > 0);
+    if (in1 > 0 || in2 > 0) {
+        m->dir = (in1 > 0) ? MOTOR_DIR_FORWARD : MOTOR_DIR_REVERSE;
+    }
+    for (size_t k = 1; k <= segments; k++) {
+        if (motor_fade_preempted(m)) {
+            return false;
+        }
+        int32_t progress = motor_ramp_point(profile, k, segments);
+        // Końce odcinków od początku rampy - reszty z dzielenia nie skracają jej
+        uint32_t seg_ms = ramp_ms * k / segments - elapsed_ms;
+        elapsed_ms += seg_ms;
+        int started = 0;
+
+        for (int ch = 0; ch < 2; ch++) {
+            if (from[ch] == to[ch]) {
+                continue;
+            }
+            int32_t delta = (int32_t)to[ch] - (int32_t)from[ch];
+            uint32_t target = from[ch] + delta * progress / MOTOR_RAMP_SCALE;
+            if (motor_hw_fade(m->id, (motor_hw_ch_t)ch, target, seg_ms) == ESP_OK) {
+                started++;
+            }
+        }
+        while (started-- > 0) {
+            xSemaphoreTake(m->fade_done, pdMS_TO_TICKS(seg_ms) + 2);
+            if (motor_fade_preempted(m)) {
+                return false;
+            }
+        }
+    }
+    m->duty[0] = in1;
+    m->duty[1] = in2;
+    motor_update_phase(m);
+    return true;
+}
+
+// Dodanie do sekwencji jednej fazy ruchu w danym kierunku
+static size_t motor_add_phase(motor_step_t *steps, size_t n, const motor_cmd_t *cmd, motor_dir_t dir)
+{
+    const uint32_t in1 = (dir == MOTOR_DIR_FORWARD) ? cmd->duty : 0;
+    const uint32_t in2 = (dir == MOTOR_DIR_FORWARD) ? 0 : cmd->duty;
+    return motor_seq_add_phase(steps, n, in1, in2, cmd->phase_ms, cmd->ramp, cmd->ramp_ms);
+}
+
+// Start sekwencji lub ruchu kasuje powiadomienia zadania - STOP wstawiony
+// tuż przed nim ani anulowanie zadania nie może zginąć razem ze swoim bitem
+static void motor_recheck_preempt(motor_t *m)
+{
+    if (motor_preempt_pending(m)) {
+        xTaskNotify(m->task, MOTOR_PREEMPT_BIT, eSetBits);
+    }
+}
+
+// Cykl wysuw + cofanie albo (PULSE) jedna faza w kierunku cmd->dir.
+// Granice kroków wyznacza sekwencer z timera sprzętowego, zadanie
+// ustawia mostek lub uruchamia rampę. Zwraca false, gdy ruch przerwano.
+static bool motor_run_cycle(motor_t *m, const motor_cmd_t *cmd)
+{
+    ESP_LOGI(TAG, "Uruchomienie silnika %u (rampa %s, %" PRIu32 " ms)",
+             m->id, motor_ramp_name(cmd->ramp), cmd->ramp_ms);
+
+    motor_step_t steps[MOTOR_SEQ_MAX_STEPS];
+    size_t n = 0;
+    if (cmd->type == MOTOR_CMD_PULSE) {
+        n = motor_add_phase(steps, n, cmd, cmd->dir);
+    } else {
+        n = motor_add_phase(steps, n, cmd, MOTOR_DIR_FORWARD);     // wysuw
+        n = motor_add_phase(steps, n, cmd, MOTOR_DIR_REVERSE);     // cofanie
+    }
+
+    esp_err_t err = motor_seq_start(&m->seq, steps, n, cmd->start_us);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Nie można uruchomić sekwencji: %s", esp_err_to_name(err));
+        motor_set_bridge(m, 0, 0);
+        return false;
+    }
+    motor_recheck_preempt(m);
+
+    const motor_step_t *step;
+    while ((err = motor_seq_next(&m->seq, portMAX_DELAY, &step)) == ESP_OK && step != NULL) {
+        motor_fade_bridge(m, step->in1, step->in2, step->ramp, step->ramp_ms);
+    }
+    motor_set_bridge(m, 0, 0);
+    if (m->id == MOTOR_PRIMARY && motor_stall_handled()) {
+        ESP_LOGW(TAG, "Cykl silnika przerwany przez utyk");
+        return false;
+    }
+    if (err == ESP_ERR_INVALID_STATE) {
+        ESP_LOGI(TAG, "Cykl silnika %u przerwany komendą stop", m->id);
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Cykl silnika %u zakończony, max opóźnienie przełączenia %" PRId64 " us",
+             m->id, motor_seq_last_lateness_us(&m->seq));
+    return true;
+}
+
+// Praca ciągła: przejście mostka do zadanego kierunku i wypełnienia.
+// Zmiana kierunku zawsze przechodzi przez zero.
+static void motor_drive(motor_t *m, motor_dir_t dir, uint32_t duty, const motor_cmd_t *cmd)
+{
+    const uint32_t in1 = (dir == MOTOR_DIR_FORWARD) ? duty : 0;
+    const uint32_t in2 = (dir == MOTOR_DIR_FORWARD) ? 0 : duty;
+
+    if ((in1 > 0 && m->duty[1] > 0) || (in2 > 0 && m->duty[0] > 0)) {
+        if (motor_ramp_has_decel(cmd->ramp)) {
+            if (!motor_fade_bridge(m, 0, 0, cmd->ramp, cmd->ramp_ms)) {
+                return;
+            }
+        } else {
+            motor_set_bridge(m, 0, 0);
+        }
+    }
+    motor_fade_bridge(m, in1, in2, cmd->ramp, cmd->ramp_ms);
+}
+
+#if CONFIG_MOTOR_ENCODER
+// Wyjście regulatora prędkości - kierunek z ostatniej komendy SPEED
+static void motor_speed_out(uint32_t duty)
+{
+    motor_t *m = &s_motors[MOTOR_PRIMARY];
+
+    if (m->run_dir == MOTOR_DIR_FORWARD) {
+        motor_set_bridge(m, duty, 0);
+    } else {
+        motor_set_bridge(m, 0, duty);
+    }
+}
+
+// Przekazanie mostka regulatorowi. Zmiana kierunku przechodzi przez zero,
+// w tym samym kierunku regulator startuje od bieżącego wypełnienia.
+static void motor_run_speed(motor_t *m, motor_dir_t dir, uint32_t rpm, const motor_cmd_t *cmd)
+{
+    if (s_speed_mode && dir == m->run_dir) {
+        s_speed_rpm = rpm;
+        motor_speed_set_target(rpm);
+        return;
+    }
+
+    motor_speed_stop();
+    const int ch = (dir == MOTOR_DIR_FORWARD) ? 0 : 1;
+    if (m->duty[1 - ch] > 0) {
+        if (motor_ramp_has_decel(cmd->ramp)) {
+            if (!motor_fade_bridge(m, 0, 0, cmd->ramp, cmd->ramp_ms)) {
+                return;
+            }
+        } else {
+            motor_set_bridge(m, 0, 0);
+        }
+    }
+
+    m->running = false;
+    s_speed_mode = true;
+    m->run_dir = dir;
+    s_speed_rpm = rpm;
+    motor_speed_start(rpm, m->duty[ch]);
+}
+#endif
+
+// Odczekanie z przerwaniem przez STOP lub utyk - false, gdy przerwano
+static bool motor_wait_ticks(TickType_t ticks)
+{
+    TimeOut_t timeout;
+    vTaskSetTimeOutState(&timeout);
+    while (xTaskCheckForTimeOut(&timeout, &ticks) == pdFALSE) {
+        uint32_t bits = 0;
+        if (xTaskNotifyWait(0, MOTOR_PREEMPT_BIT, &bits, ticks) == pdTRUE && (bits & MOTOR_PREEMPT_BIT)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#if CONFIG_MOTOR_ENCODER
+// Cel ruchu osiągnięty (przerwanie punktu obserwacji PCNT)
+static bool IRAM_ATTR motor_move_reached_cb(void *arg)
+{
+    BaseType_t need_yield = pdFALSE;
+    xTaskNotifyFromISR(s_motors[MOTOR_PRIMARY].task, MOTOR_MOVE_REACHED_BIT, eSetBits, &need_yield);
+    return need_yield == pdTRUE;
+}
+
+// Ruch do pozycji zamiast na czas. Mostek jest włączany skokowo - zadanie
+// blokowane przez rampę nie odcięłoby go na czas - i wyłączany, gdy tylko
+// punkt obserwacji PCNT zgłosi cel. Enkoder nie jest odpytywany.
+// Zwraca false, gdy celu nie osiągnięto.
+static bool motor_run_move(motor_t *m, const motor_cmd_t *cmd)
+{
+    const int32_t start = encoder_get_count();
+    const motor_dir_t dir = (cmd->position > start) ? MOTOR_DIR_FORWARD : MOTOR_DIR_REVERSE;
+    const uint32_t duty = cmd->duty ? cmd->duty : PWM_DUTY;
+
+    if (cmd->position == start) {
+        s_move_error = 0;
+        return true;
+    }
+
+    xTaskNotifyWait(0, MOTOR_MOVE_REACHED_BIT | MOTOR_STALL_BIT, NULL, 0);
+    motor_recheck_preempt(m);
+    esp_err_t err = encoder_set_target(cmd->position, motor_move_reached_cb, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Cel %" PRId32 " poza zasięgiem z pozycji %" PRId32, cmd->position, start);
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Ruch do pozycji %" PRId32 " (z %" PRId32 ")", cmd->position, start);
+    m->running = false;
+    motor_set_bridge(m, 0, 0);
+    motor_set_bridge(m, dir == MOTOR_DIR_FORWARD ? duty : 0, dir == MOTOR_DIR_FORWARD ? 0 : duty);
+
+    uint32_t bits = 0;
+    bool reached = false;
+    bool interrupted = true;
+    TickType_t timeout = pdMS_TO_TICKS(cmd->phase_ms ? cmd->phase_ms : MOTOR_MOVE_TIMEOUT_MS);
+    BaseType_t notified = xTaskNotifyWait(0, MOTOR_MOVE_REACHED_BIT | MOTOR_STALL_BIT, &bits, timeout);
+    motor_set_bridge(m, 0, 0);
+    encoder_clear_target();
+
+    if (motor_stall_handled()) {
+        ESP_LOGW(TAG, "Ruch przerwany przez utyk, pozycja %" PRId32, encoder_get_count());
+    } else if (bits & MOTOR_PREEMPT_BIT) {
+        ESP_LOGI(TAG, "Ruch przerwany komendą stop, pozycja %" PRId32, encoder_get_count());
+    } else if (notified != pdTRUE || !(bits & MOTOR_MOVE_REACHED_BIT)) {
+        ESP_LOGW(TAG, "Cel nie osiągnięty w czasie, pozycja %" PRId32, encoder_get_count());
+        interrupted = false;
+    } else {
+        reached = true;
+        interrupted = false;
+    }
+
+    // Błąd zatrzymania mierzony po wybiegu wału. Po STOP lub utyku
+    // kolejna komenda nie czeka na wybieg; STOP w trakcie wybiegu też
+    // go skraca.
+    if (!interrupted) {
+        motor_wait_ticks(pdMS_TO_TICKS(MOTOR_MOVE_SETTLE_MS));
+    }
+    s_move_error = encoder_get_count() - cmd->position;
+    ESP_LOGI(TAG, "Ruch zakończony, błąd pozycji %" PRId32 " zliczeń", s_move_error);
+    return reached;
+}
+#endif
+
+// Początek i koniec wykonania zadania programu lub procedury. Numer
+// zmienia się pod s_post_lock, więc motor_preempt_job nie przerwie
+// komendy, która przyszła po zadaniu.
+static void motor_job_enter(motor_t *m, uint32_t job)
+{
+    xSemaphoreTake(s_post_lock, portMAX_DELAY);
+    m->job = job;
+    xSemaphoreGive(s_post_lock);
+}
+
+static void motor_job_leave(motor_t *m)
+{
+    xSemaphoreTake(s_post_lock, portMAX_DELAY);
+    m->job = 0;
+    xSemaphoreGive(s_post_lock);
+    // Bit anulowania, które nie zdążyło przed końcem zadania; STOP
+    // wstawiony w międzyczasie wraca przez motor_recheck_preempt
+    xTaskNotifyWait(0, MOTOR_PREEMPT_BIT, NULL, 0);
+    motor_recheck_preempt(m);
+}
+
+// Program zadania job: kroki po kolei bez udziału sieci. Każdy krok to
+// zwykły PULSE lub MOVE, więc STOP i utyk przerywają go tak samo; między
+// krokami program sprawdza anulowanie i komendy z pierwszeństwem.
+static void motor_run_program(motor_t *m, uint32_t job)
+{
+    const motor_prog_step_t *steps;
+    size_t count;
+    if (!motor_prog_begin(job, &steps, &count)) {
+        ESP_LOGI(TAG, "Program %" PRIu32 " anulowany przed startem", job);
+        return;
+    }
+    ESP_LOGI(TAG, "Program %" PRIu32 " na silniku %u: %u kroków", job, m->id, (unsigned)count);
+
+    bool completed = true;
+    for (size_t i = 0; i < count && completed; i++) {
+        const motor_prog_step_t *s = &steps[i];
+        if (!motor_prog_step(job, i) || motor_queue_priority_pending(&m->queue)) {
+            completed = false;
+            break;
+        }
+        motor_cmd_t cmd = {
+            .dir = (motor_dir_t)s->dir,
+            .duty = s->duty,
+            .ramp = (motor_ramp_t)s->ramp,
+            .ramp_ms = s->ramp_ms
+        };
+        if (s->op == MOTOR_PROG_RUN) {
+            cmd.type = MOTOR_CMD_PULSE;
+            cmd.phase_ms = (uint32_t)s->arg;
+            completed = motor_run_cycle(m, &cmd);
+#if CONFIG_MOTOR_ENCODER
+        } else if (m->id == MOTOR_PRIMARY) {
+            cmd.type = MOTOR_CMD_MOVE;
+            cmd.position = s->arg;
+            completed = motor_run_move(m, &cmd);
+#endif
+        } else {
+            ESP_LOGW(TAG, "Krok %u: ruch do pozycji wymaga enkodera", (unsigned)i);
+            completed = false;
+        }
+    }
+    if (completed && !motor_prog_step(job, count - 1)) {
+        completed = false;
+    }
+    motor_prog_end(job, completed);
+    ESP_LOGI(TAG, "Program %" PRIu32 " %s", job, completed ? "zakończony" : "przerwany");
+}
+
+// Warunek czujnika procedury - walidator dopuszcza tylko dostępne
+static bool motor_sensor_cond(uint8_t cond, int32_t arg)
+{
+#if CONFIG_MOTOR_CURRENT_SENSE
+    current_sense_stats_t sense;
+#endif
+    switch (cond) {
+#if CONFIG_MOTOR_ENCODER
+    case MOTOR_COND_POS_GE:
+        return encoder_get_count() >= arg;
+    case MOTOR_COND_POS_LT:
+        return encoder_get_count() < arg;
+#endif
+#if CONFIG_MOTOR_CURRENT_SENSE
+    case MOTOR_COND_CUR_GE:
+    case MOTOR_COND_CUR_LT:
+        current_sense_get_stats(&sense);
+        return (sense.current_ma >= (uint32_t)arg) == (cond == MOTOR_COND_CUR_GE);
+#endif
+    default:
+        return false;
+    }
+}
+
+// Czekanie na warunek czujnika, sprawdzany co takt systemu
+static bool motor_wait_cond(uint8_t cond, int32_t arg, uint32_t timeout_ms)
+{
+    TickType_t left = pdMS_TO_TICKS(timeout_ms);
+    TimeOut_t timeout;
+    vTaskSetTimeOutState(&timeout);
+    while (!motor_sensor_cond(cond, arg)) {
+        if (xTaskCheckForTimeOut(&timeout, &left) != pdFALSE) {
+            ESP_LOGW(TAG, "Warunek %u nie spełniony w ciągu %" PRIu32 " ms", cond, timeout_ms);
+            return false;
+        }
+        if (!motor_wait_ticks(1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#if CONFIG_MOTOR_ENCODER
+// Czekanie na pozycję przy pracy zleconej wcześniej (DRIVE) - punkt
+// obserwacji PCNT jak w ruchu MOVE, bez odpytywania enkodera
+static bool motor_wait_pos(int32_t pos, uint32_t timeout_ms)
+{
+    if (encoder_get_count() == pos) {
+        return true;
+    }
+    xTaskNotifyWait(0, MOTOR_MOVE_REACHED_BIT, NULL, 0);
+    if (encoder_set_target(pos, motor_move_reached_cb, NULL) != ESP_OK) {
+        ESP_LOGW(TAG, "Pozycja %" PRId32 " poza zasięgiem", pos);
+        return false;
+    }
+    uint32_t bits = 0;
+    BaseType_t notified = xTaskNotifyWait(0, MOTOR_MOVE_REACHED_BIT | MOTOR_PREEMPT_BIT, &bits,
+                                          pdMS_TO_TICKS(timeout_ms));
+    encoder_clear_target();
+    if (notified != pdTRUE || (bits & MOTOR_PREEMPT_BIT)) {
+        ESP_LOGW(TAG, "Pozycja %" PRId32 " nie osiągnięta, jest %" PRId32, pos, encoder_get_count());
+        return false;
+    }
+    return true;
+}
+#endif
+
+// Interpreter procedury z NVS. Instrukcje ruchu korzystają z tych samych
+// funkcji co komendy, więc STOP i utyk przerywają je jak zwykle; przed
+// każdą instrukcją sprawdzane są anulowanie i komendy z pierwszeństwem.
+// Walidator gwarantuje skończoną liczbę kroków, a koniec procedury
+// zawsze wyłącza mostek.
+static void motor_run_routine(motor_t *m, uint32_t job)
+{
+    const motor_routine_t *r;
+    if (!motor_prog_begin_routine(job, &r)) {
+        ESP_LOGI(TAG, "Procedura %" PRIu32 " anulowana przed startem", job);
+        return;
+    }
+    ESP_LOGI(TAG, "Procedura %" PRIu32 " na silniku %u: %u instrukcji", job, m->id, (unsigned)r->count);
+
+    uint32_t loops[MOTOR_ROUTINE_LOOP_REGS] = { 0 };
+    bool ok = true;
+    size_t pc = 0;
+    xTaskNotifyWait(0, MOTOR_PREEMPT_BIT, NULL, 0);
+    while (ok && pc < r->count && r->code[pc].op != MOTOR_OP_END) {
+        const motor_insn_t *in = &r->code[pc];
+        if (!motor_prog_step(job, pc) || motor_queue_priority_pending(&m->queue)) {
+            ok = false;
+            break;
+        }
+        size_t next = pc + 1;
+        motor_cmd_t cmd = {
+            .dir = (motor_dir_t)in->a,
+            .duty = in->b,
+            .ramp = MOTOR_RAMP_DEFAULT,
+            .ramp_ms = CONFIG_MOTOR_RAMP_MS
+        };
+        switch (in->op) {
+        case MOTOR_OP_DRIVE:
+            motor_drive(m, cmd.dir, cmd.duty, &cmd);
+            break;
+        case MOTOR_OP_STOP:
+            motor_set_bridge(m, 0, 0);
+            break;
+        case MOTOR_OP_RUN:
+            cmd.type = MOTOR_CMD_PULSE;
+            cmd.phase_ms = (uint32_t)in->arg;
+            ok = motor_run_cycle(m, &cmd);
+            break;
+        case MOTOR_OP_WAIT:
+            ok = motor_wait_ticks(pdMS_TO_TICKS(in->arg));
+            break;
+        case MOTOR_OP_WAIT_CUR:
+            ok = motor_wait_cond(in->a, in->arg, in->b);
+            break;
+#if CONFIG_MOTOR_ENCODER
+        case MOTOR_OP_MOVE:
+            cmd.type = MOTOR_CMD_MOVE;
+            cmd.position = in->arg;
+            ok = motor_run_move(m, &cmd);
+            break;
+        case MOTOR_OP_WAIT_POS:
+            ok = motor_wait_pos(in->arg, in->b);
+            break;
+#endif
+        case MOTOR_OP_LOOP:
+            if (++loops[in->a] < (uint32_t)in->arg) {
+                next = in->b;
+            } else {
+                loops[in->a] = 0;
+            }
+            break;
+        case MOTOR_OP_JUMP_IF:
+            if (motor_sensor_cond(in->a, in->arg)) {
+                // Pętle, których LOOP zostaje przeskoczony, zaczną od nowa
+                for (size_t i = next; i < in->b; i++) {
+                    if (r->code[i].op == MOTOR_OP_LOOP) {
+                        loops[r->code[i].a] = 0;
+                    }
+                }
+                next = in->b;
+            }
+            break;
+        default:
+            ESP_LOGW(TAG, "Instrukcja %u niedostępna w tej konfiguracji", in->op);
+            ok = false;
+            break;
+        }
+        pc = next;
+    }
+    motor_set_bridge(m, 0, 0);
+    if (ok && !motor_prog_step(job, pc < r->count ? pc : r->count - 1)) {
+        ok = false;
+    }
+    motor_prog_end(job, ok);
+    ESP_LOGI(TAG, "Procedura %" PRIu32 " %s", job, ok ? "zakończona" : "przerwana");
+}
+
+// Zapis grupowy mostków i stan ich zadań. Pozostałe osie czekają na
+// barierze, więc ich pola zmienia tu tylko prowadzący.
+static void motor_group_commit(const motor_hw_bridge_t *bridges, size_t count)
+{
+    int64_t t0 = esp_timer_get_time();
+    motor_hw_set_group(bridges, count);
+    int64_t t1 = esp_timer_get_time();
+
+    for (size_t i = 0; i < count; i++) {
+        motor_t *a = &s_motors[bridges[i].motor];
+        a->duty[0] = bridges[i].in1;
+        a->duty[1] = bridges[i].in2;
+        motor_update_phase(a);
+    }
+    ESP_LOGD(TAG, "Zapis grupowy %u mostków: %" PRId64 " us", (unsigned)count, t1 - t0);
+}
+
+// Ruch prowadzony przez zadanie osi o najniższym numerze. Bez ramp:
+// wszystkie osie ruszają i stają skokowo, więc proporcje ich prędkości
+// nie zmieniają się w trakcie ruchu. Zwraca false, gdy ruch przerwano.
+static bool motor_group_drive(motor_t *leader)
+{
+    const motor_group_cmd_t *g = &s_group.cmd;
+    motor_hw_bridge_t on[MOTOR_COUNT];
+    motor_hw_bridge_t off[MOTOR_COUNT];
+
+    for (size_t i = 0; i < g->count; i++) {
+        const motor_axis_t *a = &g->axes[i];
+        on[i] = (motor_hw_bridge_t){
+            .motor = a->motor,
+            .in1 = (a->dir == MOTOR_DIR_FORWARD) ? a->duty : 0,
+            .in2 = (a->dir == MOTOR_DIR_FORWARD) ? 0 : a->duty
+        };
+        off[i] = (motor_hw_bridge_t){ .motor = a->motor };
+    }
+
+    // Jeden krok sekwencera wyznacza czas ruchu; STOP dowolnej osi
+    // (motor_preempt) i utyk osi MOTOR_PRIMARY przerywają go jak cykl.
+    // Start sekwencji kasuje powiadomienia, więc STOP wstawiony którejś
+    // osi w czasie bariery jest sprawdzany po nim.
+    const motor_step_t step = { .duration_us = g->duration_ms * 1000 };
+    esp_err_t err = motor_seq_start(&leader->seq, &step, 1, 0);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Nie można uruchomić sekwencji: %s", esp_err_to_name(err));
+        return false;
+    }
+    for (size_t i = 0; i < g->count; i++) {
+        if (motor_queue_priority_pending(&s_motors[g->axes[i].motor].queue)) {
+            xTaskNotify(leader->task, MOTOR_PREEMPT_BIT, eSetBits);
+        }
+    }
+
+    const motor_step_t *next;
+    bool completed = false;
+    if (motor_seq_next(&leader->seq, portMAX_DELAY, &next) == ESP_OK && next != NULL) {
+        motor_group_commit(on, g->count);
+        completed = (motor_seq_next(&leader->seq, portMAX_DELAY, &next) == ESP_OK);
+    }
+    motor_group_commit(off, g->count);
+
+    if (leader->id == MOTOR_PRIMARY && motor_stall_handled()) {
+        ESP_LOGW(TAG, "Ruch skoordynowany przerwany przez utyk");
+        return false;
+    }
+    if (!completed) {
+        ESP_LOGI(TAG, "Ruch skoordynowany przerwany komendą stop");
+        return false;
+    }
+    ESP_LOGI(TAG, "Ruch skoordynowany %u osi zakończony", (unsigned)g->count);
+    return true;
+}
+
+// Koniec udziału osi id; ostatnia zwalnia ruch i zapisuje jego wynik.
+// Także z przerwania (motor_group_dropped).
+static void IRAM_ATTR motor_group_leave(uint8_t id, bool aborted)
+{
+    portENTER_CRITICAL_SAFE(&s_group_lock);
+    s_group.aborted |= aborted;
+    s_group.left |= BIT(id);
+    if (s_group.left == s_group.mask) {
+        s_group.busy = false;
+        if (s_group.aborted) {
+            s_group.stats.aborted++;
+        } else {
+            s_group.stats.done++;
+        }
+    }
+    portEXIT_CRITICAL_SAFE(&s_group_lock);
+}
+
+static bool motor_group_aborted(void)
+{
+    portENTER_CRITICAL(&s_group_lock);
+    bool aborted = s_group.aborted;
+    portEXIT_CRITICAL(&s_group_lock);
+    return aborted;
+}
+
+void IRAM_ATTR motor_group_dropped(motor_queue_t *q, BaseType_t *need_yield)
+{
+    uint8_t id = 0;
+    while (id < MOTOR_COUNT - 1 && &s_motors[id].queue != q) {
+        id++;
+    }
+    motor_group_leave(id, true);
+    // Bit osi w pierwszej barierze - pozostałe osie od razu widzą przerwanie
+    if (need_yield) {
+        xEventGroupSetBitsFromISR(s_group.ev, BIT(id), need_yield);
+    } else {
+        xEventGroupSetBits(s_group.ev, BIT(id));
+    }
+}
+
+// Udział zadania osi w ruchu skoordynowanym. Pierwsza bariera zbiera
+// wszystkie osie, druga trzyma je do końca ruchu, aby w tym czasie nie
+// ruszały swoich mostków. Ruch przerwany lub niezebrany jest liczony
+// w motor_get_group_stats - klient dostał już 202.
+static void motor_run_group(motor_t *m)
+{
+    const uint32_t mask = s_group.mask;
+    const bool leader = (m->id == __builtin_ctz(mask));
+
+    m->running = false;
+    EventBits_t bits = xEventGroupSync(s_group.ev, BIT(m->id), mask, pdMS_TO_TICKS(MOTOR_GROUP_SYNC_MS));
+    if ((bits & mask) != mask) {
+        xEventGroupClearBits(s_group.ev, BIT(m->id));
+        ESP_LOGW(TAG, "Silnik %u: nie wszystkie osie dołączyły do ruchu skoordynowanego", m->id);
+        motor_group_leave(m->id, true);
+        return;
+    }
+    if (motor_group_aborted()) {
+        ESP_LOGW(TAG, "Silnik %u: ruch skoordynowany przerwany przed startem", m->id);
+        motor_group_leave(m->id, true);
+        return;
+    }
+
+    bool completed = true;
+    if (leader) {
+        completed = motor_group_drive(m);
+    }
+    xEventGroupSync(s_group.ev, BIT(m->id) << MOTOR_GROUP_DONE_SHIFT,
+                    mask << MOTOR_GROUP_DONE_SHIFT, portMAX_DELAY);
+    motor_group_leave(m->id, !completed);
+}
+
+static void motor_handle_cmd(motor_t *m, const motor_cmd_t *cmd)
+{
+#if CONFIG_MOTOR_ENCODER
+    if (s_speed_mode && m->id == MOTOR_PRIMARY) {
+        if (cmd->type == MOTOR_CMD_SPEED || cmd->type == MOTOR_CMD_SET_DIR) {
+            motor_run_speed(m, cmd->dir, cmd->type == MOTOR_CMD_SPEED ? cmd->rpm : s_speed_rpm, cmd);
+            return;
+        }
+        // Każda inna komenda odbiera mostek regulatorowi;
+        // SET_DUTY przechodzi do pracy ciągłej w pętli otwartej
+        motor_speed_stop();
+        s_speed_mode = false;
+        m->running = (cmd->type == MOTOR_CMD_SET_DUTY);
+    }
+#endif
+
+    switch (cmd->type) {
+    case MOTOR_CMD_CYCLE:
+    case MOTOR_CMD_PULSE:
+        m->running = false;
+        motor_run_cycle(m, cmd);
+        break;
+    case MOTOR_CMD_RUN:
+        m->running = true;
+        m->run_dir = cmd->dir;
+        m->run_duty = cmd->duty;
+        motor_drive(m, m->run_dir, m->run_duty, cmd);
+        break;
+    case MOTOR_CMD_STOP:
+        m->running = false;
+        // Po zadziałaniu watchdoga ruch w toku jest już porzucony. Blokada
+        // schodzi przed zapisem zera, aby zero trafiło do sprzętu.
+        if (motor_hw_release(m->id)) {
+            ESP_LOGW(TAG, "Silnik %u zatrzymany przez watchdog łącza", m->id);
+        }
+        motor_set_bridge(m, 0, 0);
+        break;
+    case MOTOR_CMD_STALL:
+        // Po sekwencji lub ruchu utyk jest już obsłużony - wtedy to zwykły stop
+        m->running = false;
+        motor_set_bridge(m, 0, 0);
+        motor_stall_handled();
+        break;
+    case MOTOR_CMD_GROUP:
+        motor_run_group(m);
+        break;
+    case MOTOR_CMD_PROGRAM:
+        m->running = false;
+        motor_job_enter(m, cmd->job);
+        motor_run_program(m, cmd->job);
+        motor_job_leave(m);
+        break;
+    case MOTOR_CMD_ROUTINE:
+        m->running = false;
+        motor_job_enter(m, cmd->job);
+        motor_run_routine(m, cmd->job);
+        motor_job_leave(m);
+        break;
+    case MOTOR_CMD_SET_DUTY:
+        m->run_duty = cmd->duty;
+        if (m->running) {
+            motor_drive(m, m->run_dir, m->run_duty, cmd);
+        }
+        break;
+    case MOTOR_CMD_SET_DIR:
+        m->run_dir = cmd->dir;
+        if (m->running) {
+            motor_drive(m, m->run_dir, m->run_duty, cmd);
+        }
+        break;
+#if CONFIG_MOTOR_ENCODER
+    case MOTOR_CMD_SPEED:
+    case MOTOR_CMD_MOVE:
+        if (m->id != MOTOR_PRIMARY) {
+            ESP_LOGW(TAG, "Silnik %u nie ma enkodera (komenda %d)", m->id, cmd->type);
+        } else if (cmd->type == MOTOR_CMD_SPEED) {
+            motor_run_speed(m, cmd->dir, cmd->rpm, cmd);
+        } else {
+            motor_run_move(m, cmd);
+        }
+        break;
+#else
+    case MOTOR_CMD_SPEED:
+    case MOTOR_CMD_MOVE:
+        ESP_LOGW(TAG, "Komenda %d wymaga enkodera (CONFIG_MOTOR_ENCODER)", cmd->type);
+        break;
+#endif
+    default:
+        ESP_LOGW(TAG, "Nieznana komenda %d", cmd->type);
+        break;
+    }
+}
+
+static void motor_task(void *arg)
+{
+    motor_t *m = arg;
+    motor_cmd_t cmd;
+
+    for (;;) {
+        if (!motor_queue_pop(&m->queue, &cmd, portMAX_DELAY)) {
+            continue;
+        }
+        motor_handle_cmd(m, &cmd);
+        motor_queue_done(&m->queue);
+    }
+}
+
+esp_err_t motor_init(void)
+{
+    s_post_lock = xSemaphoreCreateMutex();
+    if (s_post_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+        motor_t *m = &s_motors[i];
+        m->id = (uint8_t)i;
+        m->run_duty = PWM_DUTY;
+
+        esp_err_t err = motor_seq_init(&m->seq);
+        if (err != ESP_OK) {
+            return err;
+        }
+        err = motor_queue_init(&m->queue);
+        if (err != ESP_OK) {
+            return err;
+        }
+        m->fade_done = xSemaphoreCreateCounting(2, 0);
+        if (m->fade_done == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    s_group.ev = xEventGroupCreate();
+    if (s_group.ev == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_ERROR_CHECK(motor_hw_set_fade_cb(motor_fade_done_cb, NULL));
+
+#if CONFIG_MOTOR_ENCODER
+    esp_err_t err = motor_speed_init(motor_speed_out);
+    if (err != ESP_OK) {
+        return err;
+    }
+#endif
+
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+        char name[configMAX_TASK_NAME_LEN];
+        snprintf(name, sizeof(name), "motor%d", i);
+        if (xTaskCreate(motor_task, name, MOTOR_TASK_STACK, &s_motors[i], MOTOR_TASK_PRIO, &s_motors[i].task) != pdPASS) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+#if CONFIG_MOTOR_CURRENT_SENSE
+    // Callback utyku używa kolejki i zadania silnika
+    esp_err_t sense_err = current_sense_init(motor_stall_cb, NULL);
+    if (sense_err != ESP_OK) {
+        return sense_err;
+    }
+#endif
+
+#if CONFIG_MOTOR_WATCHDOG
+    esp_err_t watchdog_err = motor_watchdog_init();
+    if (watchdog_err != ESP_OK) {
+        return watchdog_err;
+    }
+#endif
+    return ESP_OK;
+}
+
+// Przerwanie ruchu w toku przed komendą z pierwszeństwem. Rampa czeka
+// na fade_done, a oś ruchu skoordynowanego na barierze, więc budzone są
+// oba oczekiwania i zadanie prowadzące.
+static void motor_preempt(motor_t *m)
+{
+    xTaskNotify(m->task, MOTOR_PREEMPT_BIT, eSetBits);
+    xSemaphoreGive(m->fade_done);
+
+    portENTER_CRITICAL(&s_group_lock);
+    uint32_t mask = s_group.busy ? s_group.mask : 0;
+    portEXIT_CRITICAL(&s_group_lock);
+    if (mask & BIT(m->id)) {
+        xTaskNotify(s_motors[__builtin_ctz(mask)].task, MOTOR_PREEMPT_BIT, eSetBits);
+    }
+}
+
+void motor_preempt_job(uint8_t motor, uint32_t job)
+{
+    motor_t *m = &s_motors[motor];
+
+    xSemaphoreTake(s_post_lock, portMAX_DELAY);
+    if (job != 0 && m->job == job) {
+        motor_preempt(m);
+    }
+    xSemaphoreGive(s_post_lock);
+}
+
+// Wstawienie według polityki kolejki - handler HTTP nigdy nie czeka
+static esp_err_t motor_post_one(motor_t *m, const motor_cmd_t *cmd, int session)
+{
+    esp_err_t err = motor_queue_push(&m->queue, cmd, NULL);
+    if (err == ESP_OK && motor_queue_is_priority(cmd->type)) {
+        motor_preempt(m);
+    }
+#if CONFIG_MOTOR_WATCHDOG
+    // Praca bez końca (RUN, SPEED) wymaga żywego klienta niezależnie od
+    // drogi komendy; silnik należy odtąd do sesji session. Inne komendy
+    // zdejmują go z watchdoga (zmiana wypełnienia lub kierunku nie),
+    // a komenda właściciela przesuwa termin.
+    if (err == ESP_OK) {
+        if (cmd->type == MOTOR_CMD_RUN || cmd->type == MOTOR_CMD_SPEED) {
+            motor_watchdog_arm(m->id, session);
+        } else if (cmd->type != MOTOR_CMD_SET_DUTY && cmd->type != MOTOR_CMD_SET_DIR) {
+            motor_watchdog_disarm(m->id);
+        } else {
+            motor_watchdog_feed(m->id, session);
+        }
+    }
+#endif
+    return err;
+}
+
+bool IRAM_ATTR motor_stop_from_isr(uint8_t motor)
+{
+    const motor_cmd_t stop = { .type = MOTOR_CMD_STOP };
+    motor_t *m = &s_motors[motor];
+    BaseType_t need_yield = pdFALSE;
+
+    motor_queue_push(&m->queue, &stop, &need_yield);
+    xTaskNotifyFromISR(m->task, MOTOR_PREEMPT_BIT, eSetBits, &need_yield);
+    xSemaphoreGiveFromISR(m->fade_done, &need_yield);
+
+    // Oś ruchu skoordynowanego czeka na barierze albo prowadzi ruch -
+    // jak w motor_preempt powiadomienie dostaje też zadanie prowadzące
+    portENTER_CRITICAL_SAFE(&s_group_lock);
+    uint32_t mask = s_group.busy ? s_group.mask : 0;
+    portEXIT_CRITICAL_SAFE(&s_group_lock);
+    if (mask & BIT(motor)) {
+        xTaskNotifyFromISR(s_motors[__builtin_ctz(mask)].task, MOTOR_PREEMPT_BIT, eSetBits, &need_yield);
+    }
+    return need_yield == pdTRUE;
+}
+
+esp_err_t motor_post_session(uint8_t motor, const motor_cmd_t *cmd, int session)
+{
+    if (motor >= MOTOR_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreTake(s_post_lock, portMAX_DELAY);
+    esp_err_t err = motor_post_one(&s_motors[motor], cmd, session);
+    xSemaphoreGive(s_post_lock);
+    return err;
+}
+
+esp_err_t motor_post(uint8_t motor, const motor_cmd_t *cmd)
+{
+    return motor_post_session(motor, cmd, MOTOR_SESSION_NONE);
+}
+
+// Wstawienie komendy do kolejek silników z maski - wszystkich albo żadnej.
+// Wołane pod s_post_lock.
+static esp_err_t motor_post_mask_locked(uint32_t mask, const motor_cmd_t *cmd)
+{
+    // Zadania wstawiają komendy pod s_post_lock, więc miejsce sprawdzone
+    // tutaj nie zniknie przed wstawieniem. Komendy z przerwania (utyk,
+    // watchdog) tylko zwalniają miejsce (czyszczą kolejkę).
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+        if ((mask & BIT(i)) && !motor_queue_can_accept(&s_motors[i].queue, cmd)) {
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+        if (mask & BIT(i)) {
+            motor_post_one(&s_motors[i], cmd, MOTOR_SESSION_NONE);
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t motor_post_mask(uint32_t mask, const motor_cmd_t *cmd)
+{
+    xSemaphoreTake(s_post_lock, portMAX_DELAY);
+    esp_err_t err = motor_post_mask_locked(mask, cmd);
+    xSemaphoreGive(s_post_lock);
+    return err;
+}
+
+esp_err_t motor_post_sync(uint32_t mask, const motor_cmd_t *cmd)
+{
+    mask &= MOTOR_MASK_ALL;
+    if (mask == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    motor_cmd_t sync = *cmd;
+    sync.start_us = esp_timer_get_time() + MOTOR_SYNC_LEAD_US;
+    return motor_post_mask(mask, &sync);
+}
+
+esp_err_t motor_post_group(const motor_group_cmd_t *group)
+{
+    if (group->count == 0 || group->count > MOTOR_COUNT ||
+        group->duration_ms == 0 || group->duration_ms > UINT32_MAX / 1000) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t mask = 0;
+    for (size_t i = 0; i < group->count; i++) {
+        const motor_axis_t *a = &group->axes[i];
+        if (a->motor >= MOTOR_COUNT || (mask & BIT(a->motor)) || a->duty > PWM_DUTY ||
+            (a->dir != MOTOR_DIR_FORWARD && a->dir != MOTOR_DIR_REVERSE)) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        mask |= BIT(a->motor);
+    }
+
+    // Oś zajęta wcześniejszą komendą dołączyłaby do bariery dopiero po
+    // niej, a ruch potwierdzony już klientowi przepadłby po limicie
+    // bariery - odmowa od razu. s_post_lock trzyma osie bez nowych komend
+    // do wstawienia ruchu.
+    xSemaphoreTake(s_post_lock, portMAX_DELAY);
+    portENTER_CRITICAL(&s_group_lock);
+    bool busy = s_group.busy;
+    portEXIT_CRITICAL(&s_group_lock);
+    for (int i = 0; i < MOTOR_COUNT && !busy; i++) {
+        busy = (mask & BIT(i)) && !motor_queue_idle(&s_motors[i].queue);
+    }
+    if (busy) {
+        xSemaphoreGive(s_post_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_group.cmd = *group;
+    s_group.mask = mask;
+    s_group.left = 0;
+    s_group.aborted = false;
+    xEventGroupClearBits(s_group.ev, MOTOR_GROUP_BITS);
+    portENTER_CRITICAL(&s_group_lock);
+    s_group.busy = true;
+    portEXIT_CRITICAL(&s_group_lock);
+
+    const motor_cmd_t cmd = { .type = MOTOR_CMD_GROUP };
+    esp_err_t err = motor_post_mask_locked(mask, &cmd);
+    if (err != ESP_OK) {
+        portENTER_CRITICAL(&s_group_lock);
+        s_group.busy = false;
+        portEXIT_CRITICAL(&s_group_lock);
+    }
+    xSemaphoreGive(s_post_lock);
+    return err;
+}
+
+void motor_get_group_stats(motor_group_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_group_lock);
+    *stats = s_group.stats;
+    stats->busy = s_group.busy;
+    portEXIT_CRITICAL(&s_group_lock);
+}
+
+void motor_get_state(uint8_t motor, motor_state_t *state)
+{
+    motor_t *m = &s_motors[motor];
+
+    state->duty_in1 = motor_hw_get_duty(motor, MOTOR_HW_IN1);
+    state->duty_in2 = motor_hw_get_duty(motor, MOTOR_HW_IN2);
+    state->dir = m->dir;
+    state->phase = m->phase;
+
+    motor_queue_stats_t queue;
+    motor_queue_get_stats(&m->queue, &queue);
+    state->queue_depth = queue.depth;
+    state->queue_coalesced = queue.coalesced;
+    state->queue_flushed = queue.flushed;
+    state->queue_dropped = queue.dropped;
+#if CONFIG_MOTOR_ENCODER
+    state->position = (motor == MOTOR_PRIMARY) ? encoder_get_count() : 0;
+    state->move_error = (motor == MOTOR_PRIMARY) ? s_move_error : 0;
+#endif
+}
+
+const char *motor_phase_name(motor_phase_t phase)
+{
+    switch (phase) {
+    case MOTOR_PHASE_IDLE:
+        return "idle";
+    case MOTOR_PHASE_RAMP:
+        return "ramp";
+    case MOTOR_PHASE_RUN:
+        return "run";
+    default:
+        return "?";
+    }
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "motor_ramp.h"
+
+// Wypełnienie PWM przy pełnej mocy (rozdzielczość 12 bitów)
+#define PWM_DUTY 4095
+
+// Czas trwania jednej fazy cyklu (wysuw / cofanie)
+#define MOTOR_PHASE_MS 3000
+
+// Liczba mostków H (podnośniki, stopień) - mapa kanałów w motor_hw
+#define MOTOR_COUNT CONFIG_MOTOR_COUNT
+
+// Silnik z enkoderem i pomiarem prądu - regulacja prędkości, ruch do
+// pozycji i wykrywanie utyku dotyczą tylko jego
+#define MOTOR_PRIMARY 0
+
+// Wyprzedzenie wspólnej chwili startu komend synchronicznych - zadania
+// wszystkich silników muszą zdążyć odebrać komendę i zaplanować sekwencję
+#define MOTOR_SYNC_LEAD_US 20000
+
+// Profil rampy używany, gdy żądanie go nie wybiera
+#if CONFIG_MOTOR_RAMP_DEFAULT_NONE
+#define MOTOR_RAMP_DEFAULT MOTOR_RAMP_NONE
+#elif CONFIG_MOTOR_RAMP_DEFAULT_LINEAR
+#define MOTOR_RAMP_DEFAULT MOTOR_RAMP_LINEAR
+#elif CONFIG_MOTOR_RAMP_DEFAULT_SCURVE
+#define MOTOR_RAMP_DEFAULT MOTOR_RAMP_SCURVE
+#else
+#define MOTOR_RAMP_DEFAULT MOTOR_RAMP_TRAPEZOID
+#endif
+
+// Kierunek obrotów: FORWARD = IN1 (wysuw), REVERSE = IN2 (cofanie)
+typedef enum {
+    MOTOR_DIR_FORWARD,
+    MOTOR_DIR_REVERSE,
+} motor_dir_t;
+
+// Faza ruchu raportowana w telemetrii
+typedef enum {
+    MOTOR_PHASE_IDLE,   // mostek wyłączony
+    MOTOR_PHASE_RAMP,   // trwa zanikanie sprzętowe
+    MOTOR_PHASE_RUN,    // stałe wypełnienie
+} motor_phase_t;
+
+// Migawka stanu silnika
+typedef struct {
+    uint32_t duty_in1;      // bieżące wypełnienie IN1 (odczyt z motor_hw)
+    uint32_t duty_in2;      // bieżące wypełnienie IN2
+    motor_dir_t dir;
+    motor_phase_t phase;
+    uint32_t queue_depth;       // komendy oczekujące w kolejce (motor_queue)
+    uint32_t queue_coalesced;   // zastąpione nowszą komendą tego samego rodzaju
+    uint32_t queue_flushed;     // usunięte przez STOP lub utyk
+    uint32_t queue_dropped;     // odrzucone przy pełnej kolejce
+#if CONFIG_MOTOR_ENCODER
+    // Enkoder ma tylko MOTOR_PRIMARY - dla pozostałych silników 0
+    int32_t position;       // pozycja enkodera w zliczeniach
+    int32_t move_error;     // pozycja po ostatnim ruchu MOVE minus cel
+#endif
+} motor_state_t;
+
+// Rodzaje komend obsługiwanych przez zadanie silnika
+typedef enum {
+    MOTOR_CMD_CYCLE,    // wysuw, a następnie cofanie
+    MOTOR_CMD_RUN,      // ciągła praca w kierunku dir z wypełnieniem duty
+    MOTOR_CMD_STOP,     // zatrzymanie
+    MOTOR_CMD_SET_DUTY, // zmiana wypełnienia (także w trakcie pracy)
+    MOTOR_CMD_SET_DIR,  // zmiana kierunku (także w trakcie pracy)
+    MOTOR_CMD_SPEED,    // regulacja prędkości rpm w kierunku dir (CONFIG_MOTOR_ENCODER)
+    MOTOR_CMD_MOVE,     // ruch do pozycji position w zliczeniach enkodera (CONFIG_MOTOR_ENCODER)
+    MOTOR_CMD_PULSE,    // praca w kierunku dir przez phase_ms (z rampą), potem stop
+    MOTOR_CMD_PROGRAM,  // program kroków zadania job (motor_prog)
+    MOTOR_CMD_ROUTINE,  // procedura z NVS w zadaniu job (motor_routine)
+    MOTOR_CMD_STALL,    // wewnętrzna: utyk wykryty przez pomiar prądu (CONFIG_MOTOR_CURRENT_SENSE)
+    MOTOR_CMD_GROUP,    // wewnętrzna: udział w ruchu skoordynowanym (motor_post_group)
+} motor_cmd_type_t;
+
+// Komenda przekazywana przez kolejkę do zadania silnika
+typedef struct {
+    motor_cmd_type_t type;
+    motor_dir_t dir;        // kierunek dla RUN / SET_DIR / PULSE
+    uint32_t duty;          // wypełnienie 0..PWM_DUTY
+    uint32_t phase_ms;      // czas trwania fazy w ms
+    motor_ramp_t ramp;      // profil rozruchu/hamowania
+    uint16_t ramp_ms;       // czas rampy w ms
+    uint16_t rpm;           // prędkość zadana dla SPEED, obr/min
+    int32_t position;       // cel dla MOVE; phase_ms to wtedy limit czasu (0 - domyślny)
+    int64_t start_us;       // chwila startu CYCLE (esp_timer_get_time), 0 - od razu
+    uint32_t job;           // numer zadania dla PROGRAM i ROUTINE
+} motor_cmd_t;
+
+// Oś ruchu skoordynowanego
+typedef struct {
+    uint8_t motor;
+    motor_dir_t dir;
+    uint32_t duty;          // wypełnienie 0..PWM_DUTY - proporcje prędkości osi
+} motor_axis_t;
+
+// Ruch skoordynowany: wszystkie osie ruszają i stają w tym samym okresie
+// PWM, każda ze swoim wypełnieniem przez cały ruch
+typedef struct {
+    uint32_t duration_ms;
+    size_t count;
+    motor_axis_t axes[MOTOR_COUNT];
+} motor_group_cmd_t;
+
+// Konfiguracja kanałów PWM sterujących mostkiem H (motor_hw)
+void pwm_init(void);
+
+// Uruchomienie zadań sterujących silnikami i ich kolejek.
+// Każdy silnik ma własne zadanie, więc wykonują komendy równolegle.
+esp_err_t motor_init(void);
+
+// Wstawienie komendy do kolejki silnika motor bez blokowania.
+// Zwraca ESP_ERR_TIMEOUT, gdy kolejka jest pełna. Z CONFIG_MOTOR_WATCHDOG
+// RUN i SPEED uzbrajają watchdog łącza dla tego silnika, a termin
+// przesuwają następne komendy dla niego; inne komendy go zdejmują.
+esp_err_t motor_post(uint8_t motor, const motor_cmd_t *cmd);
+
+// Droga bez sesji sterującej (HTTP, REST, programy)
+#define MOTOR_SESSION_NONE (-1)
+
+// motor_post z gniazda sesji session (WebSocket). Silnik uruchomiony przez
+// RUN lub SPEED należy do tej sesji: watchdog łącza liczy tylko jej ramki,
+// a zamknięcie gniazda go zatrzymuje (motor_watchdog.h).
+esp_err_t motor_post_session(uint8_t motor, const motor_cmd_t *cmd, int session);
+
+// STOP dla silnika motor z przerwania (watchdog łącza): bez s_post_lock
+// i czekania, tylko wywołania FromISR. Zwraca true, gdy trzeba przełączyć
+// zadanie.
+bool motor_stop_from_isr(uint8_t motor);
+
+// Przerwanie programu lub procedury job w toku na silniku motor
+// (motor_prog_cancel) bez czyszczenia kolejki - zadania czekające za nim
+// ruszą normalnie. Nic nie robi, gdy silnik wykonuje już co innego.
+void motor_preempt_job(uint8_t motor, uint32_t job);
+
+// Ta sama komenda dla silników z maski (bit n - silnik n), z jedną chwilą
+// startu MOTOR_SYNC_LEAD_US od teraz. Komenda trafia do wszystkich kolejek
+// albo do żadnej (ESP_ERR_TIMEOUT).
+esp_err_t motor_post_sync(uint32_t mask, const motor_cmd_t *cmd);
+
+// Ruch skoordynowany trafia do kolejek wszystkich swoich osi albo do żadnej
+// (ESP_ERR_TIMEOUT). Naraz trwa jeden, a każda oś musi być bezczynna (bez
+// komend w kolejce i w toku) - inaczej ESP_ERR_INVALID_STATE;
+// ESP_ERR_INVALID_ARG dla złych lub powtórzonych osi. Ruch przyjęty,
+// a potem przerwany (STOP, utyk) liczy motor_get_group_stats.
+esp_err_t motor_post_group(const motor_group_cmd_t *group);
+
+// Ruchy skoordynowane od startu (telemetria)
+typedef struct {
+    bool busy;              // ruch w toku
+    uint32_t done;          // zakończone w całości
+    uint32_t aborted;       // przerwane albo z osiami niezebranymi na barierze
+} motor_group_stats_t;
+
+void motor_get_group_stats(motor_group_stats_t *stats);
+
+// Maska wszystkich silników dla motor_post_sync
+#define MOTOR_MASK_ALL ((1u << MOTOR_COUNT) - 1)
+
+// Odczyt stanu silnika - bezpieczny z dowolnego zadania
+void motor_get_state(uint8_t motor, motor_state_t *state);
+
+const char *motor_phase_name(motor_phase_t phase);
@@ -0,0 +1,639 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "motor.h"
+#include "motor_ramp.h"
+#include "json_scan.h"
+#include "motor_prog.h"
+#include "motor_routine.h"
+#include "motor_api.h"
+#include "http_pool.h"
+#if CONFIG_MOTOR_API_HEAP_TRACE
+#include "esp_heap_trace.h"
+#endif
+
+static const char *TAG = "motor_api";
+
+// Dłuższe ciało jest odrzucane bez czytania
+#define MOTOR_API_BODY_MAX 256
+// Program: do MOTOR_PROG_MAX_STEPS obiektów po ok. 100 znaków
+#define MOTOR_API_PROG_BODY_MAX 4096
+// Kawałek ciała czytany naraz z gniazda
+#define MOTOR_API_CHUNK 64
+#define MOTOR_API_DURATION_MAX_MS 60000
+#define MOTOR_API_RESP_MAX 224
+
+// Żądanie POST po parsowaniu
+typedef struct {
+    uint8_t motor;
+    motor_dir_t dir;
+    uint32_t duty;
+    uint32_t duration_ms;       // 0 - praca ciągła
+    motor_ramp_t ramp;
+    uint32_t ramp_ms;
+    const char *error;          // opis złego pola do odpowiedzi 400
+} motor_api_req_t;
+
+// Krok programu w trakcie parsowania
+typedef struct {
+    uint8_t motor;
+    motor_prog_t prog;
+    motor_prog_step_t step;     // bieżący obiekt tablicy
+    bool has_duration;
+    bool has_pos;
+    const char *error;
+} motor_api_prog_req_t;
+
+// Odpowiedzi tras szybkich składane na miejscu. Wykonuje je jedno zadanie
+// serwera HTTP, więc jeden bufor obsługuje kolejno wszystkie połączenia;
+// trasy w puli (http_pool.h) mają bufory na własnym stosie.
+static char s_resp[MOTOR_API_RESP_MAX];
+
+#if CONFIG_MOTOR_API_HEAP_TRACE
+// Śledzenie obejmuje całą obsługę żądania; zapisy trafiają do bufora
+// statycznego, a licznik alokacji do GET (tools/qemu_bench.py)
+#define MOTOR_API_TRACE_RECORDS 16
+static heap_trace_record_t s_trace_records[MOTOR_API_TRACE_RECORDS];
+static uint32_t s_heap_allocs;
+#endif
+
+static const char *motor_api_dir_name(motor_dir_t dir)
+{
+    return dir == MOTOR_DIR_FORWARD ? "fwd" : "rev";
+}
+
+static esp_err_t motor_api_send(httpd_req_t *req, const char *status, const char *body, int len)
+{
+    httpd_resp_set_status(req, status);
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, body, len);
+}
+
+// Wywoływane też z puli - bufor na stosie
+static esp_err_t motor_api_error(httpd_req_t *req, const char *status, const char *msg)
+{
+    char body[80];
+    int len = snprintf(body, sizeof(body), "{\"error\":\"%s\"}", msg);
+    return motor_api_send(req, status, body, len);
+}
+
+// Liczba całkowita 0..max bez znaku i śmieci na końcu
+static bool motor_api_uint(json_scan_type_t type, const char *value, uint32_t max, uint32_t *out)
+{
+    if (type != JSON_SCAN_NUMBER || value[0] == '-') {
+        return false;
+    }
+    char *end;
+    unsigned long v = strtoul(value, &end, 10);
+    if (end == value || *end != '\0' || v > max) {
+        return false;
+    }
+    *out = (uint32_t)v;
+    return true;
+}
+
+static esp_err_t motor_api_bad(motor_api_req_t *r, const char *msg)
+{
+    r->error = msg;
+    return ESP_ERR_INVALID_ARG;
+}
+
+// Liczba z zapytania (?key=N): ESP_ERR_NOT_FOUND - brak klucza,
+// ESP_ERR_INVALID_ARG - zła wartość
+static esp_err_t motor_api_query_uint(httpd_req_t *req, const char *key, uint32_t max, uint32_t *out)
+{
+    char query[48];
+    char value[12];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+        httpd_query_key_value(query, key, value, sizeof(value)) != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return motor_api_uint(JSON_SCAN_NUMBER, value, max, out) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+// Pole ciała POST (callback json_scan)
+static esp_err_t motor_api_field(const char *key, json_scan_type_t type, const char *value, void *arg)
+{
+    motor_api_req_t *r = arg;
+    uint32_t n;
+
+    if (strcmp(key, "motor") == 0) {
+        if (!motor_api_uint(type, value, MOTOR_COUNT - 1, &n)) {
+            return motor_api_bad(r, "Niepoprawny silnik");
+        }
+        r->motor = (uint8_t)n;
+    } else if (strcmp(key, "dir") == 0) {
+        if (type == JSON_SCAN_STRING && strcmp(value, "fwd") == 0) {
+            r->dir = MOTOR_DIR_FORWARD;
+        } else if (type == JSON_SCAN_STRING && strcmp(value, "rev") == 0) {
+            r->dir = MOTOR_DIR_REVERSE;
+        } else {
+            return motor_api_bad(r, "Kierunek fwd lub rev");
+        }
+    } else if (strcmp(key, "duty") == 0) {
+        if (!motor_api_uint(type, value, PWM_DUTY, &r->duty)) {
+            return motor_api_bad(r, "Niepoprawne wypełnienie");
+        }
+    } else if (strcmp(key, "duration_ms") == 0) {
+        if (!motor_api_uint(type, value, MOTOR_API_DURATION_MAX_MS, &r->duration_ms)) {
+            return motor_api_bad(r, "Niepoprawny czas pracy");
+        }
+    } else if (strcmp(key, "ramp") == 0) {
+        r->ramp = (type == JSON_SCAN_STRING) ? motor_ramp_from_name(value) : MOTOR_RAMP_MAX;
+        if (r->ramp == MOTOR_RAMP_MAX) {
+            return motor_api_bad(r, "Nieznany profil rampy");
+        }
+    } else if (strcmp(key, "ramp_ms") == 0) {
+        if (!motor_api_uint(type, value, MOTOR_PHASE_MS, &r->ramp_ms)) {
+            return motor_api_bad(r, "Niepoprawny czas rampy");
+        }
+    } else {
+        return motor_api_bad(r, "Nieznane pole");
+    }
+    return ESP_OK;
+}
+
+// Ciało prosto z gniazda do parsera; resztę po błędzie odrzuca serwer.
+// ESP_FAIL - zerwane połączenie, inne błędy pochodzą z json_scan.
+static esp_err_t motor_api_recv_json(httpd_req_t *req, json_scan_t *scan)
+{
+    char chunk[MOTOR_API_CHUNK];
+    size_t left = req->content_len;
+    esp_err_t err = ESP_OK;
+    while (left > 0 && err == ESP_OK) {
+        int got = httpd_req_recv(req, chunk, left < sizeof(chunk) ? left : sizeof(chunk));
+        if (got == HTTPD_SOCK_ERR_TIMEOUT) {
+            continue;
+        }
+        if (got <= 0) {
+            return ESP_FAIL;
+        }
+        left -= (size_t)got;
+        err = json_scan_feed(scan, chunk, (size_t)got);
+    }
+    return (err == ESP_OK) ? json_scan_finish(scan) : err;
+}
+
+static esp_err_t motor_api_post(httpd_req_t *req)
+{
+    if (req->content_len == 0 || req->content_len > MOTOR_API_BODY_MAX) {
+        return motor_api_error(req, "400 Bad Request", "Brak ciała lub za długie");
+    }
+
+    motor_api_req_t r = {
+        .motor = MOTOR_PRIMARY,
+        .dir = MOTOR_DIR_FORWARD,
+        .duty = PWM_DUTY,
+        .ramp = MOTOR_RAMP_DEFAULT,
+        .ramp_ms = CONFIG_MOTOR_RAMP_MS
+    };
+    json_scan_t scan;
+    json_scan_init(&scan, motor_api_field, &r);
+
+    esp_err_t err = motor_api_recv_json(req, &scan);
+    if (err == ESP_FAIL) {
+        return ESP_FAIL;
+    }
+    if (err == ESP_OK && scan.array) {
+        return motor_api_error(req, "400 Bad Request", "Oczekiwano obiektu");
+    }
+    if (err != ESP_OK) {
+        return motor_api_error(req, "400 Bad Request", r.error ? r.error : "Niepoprawny JSON");
+    }
+
+    motor_cmd_t cmd = {
+        .type = (r.duration_ms > 0) ? MOTOR_CMD_PULSE : MOTOR_CMD_RUN,
+        .dir = r.dir,
+        .duty = r.duty,
+        .phase_ms = r.duration_ms,
+        .ramp = r.ramp,
+        .ramp_ms = (uint16_t)r.ramp_ms
+    };
+    if (motor_post(r.motor, &cmd) != ESP_OK) {
+        ESP_LOGW(TAG, "Kolejka silnika %u pełna", r.motor);
+        return motor_api_error(req, "503 Service Unavailable", "Silnik zajęty");
+    }
+
+    int len = snprintf(s_resp, sizeof(s_resp),
+        "{\"motor\":%u,\"dir\":\"%s\",\"duty\":%" PRIu32 ",\"duration_ms\":%" PRIu32 ","
+        "\"ramp\":\"%s\",\"ramp_ms\":%" PRIu32 "}",
+        r.motor, motor_api_dir_name(r.dir), r.duty, r.duration_ms, motor_ramp_name(r.ramp), r.ramp_ms);
+    return motor_api_send(req, "202 Accepted", s_resp, len);
+}
+
+static esp_err_t motor_api_post_handler(httpd_req_t *req)
+{
+#if CONFIG_MOTOR_API_HEAP_TRACE
+    heap_trace_start(HEAP_TRACE_ALL);
+    esp_err_t ret = motor_api_post(req);
+    heap_trace_stop();
+    heap_trace_summary_t summary;
+    if (heap_trace_summary(&summary) == ESP_OK) {
+        s_heap_allocs += summary.total_allocations;
+    }
+    return ret;
+#else
+    return motor_api_post(req);
+#endif
+}
+
+// GET /api/v1/motor?motor=N - stan silnika
+static esp_err_t motor_api_get_handler(httpd_req_t *req)
+{
+    uint32_t motor = MOTOR_PRIMARY;
+    if (motor_api_query_uint(req, "motor", MOTOR_COUNT - 1, &motor) == ESP_ERR_INVALID_ARG) {
+        return motor_api_error(req, "400 Bad Request", "Niepoprawny silnik");
+    }
+
+    motor_state_t state;
+    motor_get_state((uint8_t)motor, &state);
+    int len = snprintf(s_resp, sizeof(s_resp),
+        "{\"motor\":%" PRIu32 ",\"dir\":\"%s\",\"phase\":\"%s\",\"duty_in1\":%" PRIu32 ","
+        "\"duty_in2\":%" PRIu32 ",\"queue_depth\":%" PRIu32,
+        motor, motor_api_dir_name(state.dir), motor_phase_name(state.phase),
+        state.duty_in1, state.duty_in2, state.queue_depth);
+#if CONFIG_MOTOR_API_HEAP_TRACE
+    len += snprintf(s_resp + len, sizeof(s_resp) - len, ",\"heap_allocs\":%" PRIu32, s_heap_allocs);
+#endif
+    len += snprintf(s_resp + len, sizeof(s_resp) - len, "}");
+    return motor_api_send(req, "200 OK", s_resp, len);
+}
+
+static esp_err_t motor_api_prog_bad(motor_api_prog_req_t *r, const char *msg)
+{
+    r->error = msg;
+    return ESP_ERR_INVALID_ARG;
+}
+
+// Pole kroku programu; domyślne wartości ustawia motor_api_prog_reset
+static esp_err_t motor_api_prog_field(const char *key, json_scan_type_t type, const char *value, void *arg)
+{
+    motor_api_prog_req_t *r = arg;
+    motor_prog_step_t *st = &r->step;
+    uint32_t n;
+
+    if (strcmp(key, "dir") == 0) {
+        if (type == JSON_SCAN_STRING && strcmp(value, "fwd") == 0) {
+            st->dir = MOTOR_DIR_FORWARD;
+        } else if (type == JSON_SCAN_STRING && strcmp(value, "rev") == 0) {
+            st->dir = MOTOR_DIR_REVERSE;
+        } else {
+            return motor_api_prog_bad(r, "Kierunek fwd lub rev");
+        }
+    } else if (strcmp(key, "duty") == 0) {
+        if (!motor_api_uint(type, value, PWM_DUTY, &n)) {
+            return motor_api_prog_bad(r, "Niepoprawne wypełnienie");
+        }
+        st->duty = (uint16_t)n;
+    } else if (strcmp(key, "duration_ms") == 0) {
+        if (!motor_api_uint(type, value, MOTOR_API_DURATION_MAX_MS, &n) || n == 0) {
+            return motor_api_prog_bad(r, "Niepoprawny czas pracy");
+        }
+        st->op = MOTOR_PROG_RUN;
+        st->arg = (int32_t)n;
+        r->has_duration = true;
+    } else if (strcmp(key, "pos") == 0) {
+        char *end;
+        long long pos = strtoll(value, &end, 10);
+        if (type != JSON_SCAN_NUMBER || *end != '\0' || pos < INT32_MIN || pos > INT32_MAX) {
+            return motor_api_prog_bad(r, "Niepoprawna pozycja");
+        }
+        st->op = MOTOR_PROG_MOVE;
+        st->arg = (int32_t)pos;
+        r->has_pos = true;
+    } else if (strcmp(key, "ramp") == 0) {
+        motor_ramp_t ramp = (type == JSON_SCAN_STRING) ? motor_ramp_from_name(value) : MOTOR_RAMP_MAX;
+        if (ramp == MOTOR_RAMP_MAX) {
+            return motor_api_prog_bad(r, "Nieznany profil rampy");
+        }
+        st->ramp = (uint8_t)ramp;
+    } else if (strcmp(key, "ramp_ms") == 0) {
+        if (!motor_api_uint(type, value, MOTOR_PHASE_MS, &n)) {
+            return motor_api_prog_bad(r, "Niepoprawny czas rampy");
+        }
+        st->ramp_ms = (uint16_t)n;
+    } else {
+        return motor_api_prog_bad(r, "Nieznane pole");
+    }
+    return ESP_OK;
+}
+
+// Domyślne pola kolejnego kroku - jak w POST /api/v1/motor
+static void motor_api_prog_reset(motor_api_prog_req_t *r)
+{
+    r->step = (motor_prog_step_t){
+        .op = MOTOR_PROG_RUN,
+        .dir = MOTOR_DIR_FORWARD,
+        .ramp = MOTOR_RAMP_DEFAULT,
+        .duty = PWM_DUTY,
+        .ramp_ms = CONFIG_MOTOR_RAMP_MS
+    };
+    r->has_duration = false;
+    r->has_pos = false;
+}
+
+// Koniec obiektu kroku: walidacja całości i dopisanie do programu
+static esp_err_t motor_api_prog_object(void *arg)
+{
+    motor_api_prog_req_t *r = arg;
+
+    if (r->has_duration == r->has_pos) {
+        return motor_api_prog_bad(r, "Krok wymaga duration_ms albo pos");
+    }
+#if CONFIG_MOTOR_ENCODER
+    if (r->has_pos && r->motor != MOTOR_PRIMARY) {
+        return motor_api_prog_bad(r, "Silnik bez enkodera");
+    }
+#else
+    if (r->has_pos) {
+        return motor_api_prog_bad(r, "Ruch do pozycji wymaga enkodera");
+    }
+#endif
+    if (r->prog.count >= MOTOR_PROG_MAX_STEPS) {
+        return motor_api_prog_bad(r, "Za dużo kroków");
+    }
+    r->prog.steps[r->prog.count++] = r->step;
+    motor_api_prog_reset(r);
+    return ESP_OK;
+}
+
+// POST /api/v1/program?motor=N z tablicą kroków:
+//   [{"dir":"fwd","duty":3000,"duration_ms":1500,"ramp":"linear","ramp_ms":300},
+//    {"pos":1200,"duty":2000}, ...]
+// Trasa w puli: ciało do 4 KB od wolnego klienta nie blokuje serwera.
+static esp_err_t motor_api_prog_post_handler(httpd_req_t *req)
+{
+    if (req->content_len == 0 || req->content_len > MOTOR_API_PROG_BODY_MAX) {
+        return motor_api_error(req, "400 Bad Request", "Brak ciała lub za długie");
+    }
+    uint32_t motor = MOTOR_PRIMARY;
+    if (motor_api_query_uint(req, "motor", MOTOR_COUNT - 1, &motor) == ESP_ERR_INVALID_ARG) {
+        return motor_api_error(req, "400 Bad Request", "Niepoprawny silnik");
+    }
+
+    motor_api_prog_req_t prog;
+    motor_api_prog_req_t *r = &prog;
+    r->motor = (uint8_t)motor;
+    r->prog.count = 0;
+    r->error = NULL;
+    motor_api_prog_reset(r);
+    json_scan_t scan;
+    json_scan_init(&scan, motor_api_prog_field, r);
+    json_scan_set_object_cb(&scan, motor_api_prog_object);
+
+    esp_err_t err = motor_api_recv_json(req, &scan);
+    if (err == ESP_FAIL) {
+        return ESP_FAIL;
+    }
+    if (err == ESP_OK && !scan.array) {
+        return motor_api_error(req, "400 Bad Request", "Oczekiwano tablicy kroków");
+    }
+    if (err == ESP_OK && r->prog.count == 0) {
+        return motor_api_error(req, "400 Bad Request", "Pusty program");
+    }
+    if (err != ESP_OK) {
+        return motor_api_error(req, "400 Bad Request", r->error ? r->error : "Niepoprawny JSON");
+    }
+
+    uint32_t job;
+    err = motor_prog_submit(r->motor, &r->prog, &job);
+    if (err == ESP_ERR_NO_MEM) {
+        return motor_api_error(req, "503 Service Unavailable", "Brak wolnego zadania");
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Kolejka silnika %u pełna", r->motor);
+        return motor_api_error(req, "503 Service Unavailable", "Silnik zajęty");
+    }
+
+    char body[64];
+    int len = snprintf(body, sizeof(body), "{\"job\":%" PRIu32 ",\"motor\":%u,\"steps\":%u}",
+                       job, r->motor, (unsigned)r->prog.count);
+    return motor_api_send(req, "202 Accepted", body, len);
+}
+
+static esp_err_t motor_api_job_send(httpd_req_t *req, uint32_t id)
+{
+    motor_job_info_t info;
+    if (motor_prog_get_info(id, &info) != ESP_OK) {
+        return motor_api_error(req, "404 Not Found", "Nieznane zadanie");
+    }
+    int len = snprintf(s_resp, sizeof(s_resp),
+        "{\"job\":%" PRIu32 ",\"motor\":%u,\"state\":\"%s\",\"step\":%u,\"steps\":%u}",
+        info.id, info.motor, motor_job_state_name(info.state), info.step, info.steps);
+    return motor_api_send(req, "200 OK", s_resp, len);
+}
+
+// GET /api/v1/program?id=N - stan zadania
+static esp_err_t motor_api_prog_get_handler(httpd_req_t *req)
+{
+    uint32_t id;
+    if (motor_api_query_uint(req, "id", UINT32_MAX, &id) != ESP_OK) {
+        return motor_api_error(req, "400 Bad Request", "Niepoprawny numer zadania");
+    }
+    return motor_api_job_send(req, id);
+}
+
+// DELETE /api/v1/program?id=N - anulowanie; odpowiedź to stan po anulowaniu
+static esp_err_t motor_api_prog_delete_handler(httpd_req_t *req)
+{
+    uint32_t id;
+    if (motor_api_query_uint(req, "id", UINT32_MAX, &id) != ESP_OK) {
+        return motor_api_error(req, "400 Bad Request", "Niepoprawny numer zadania");
+    }
+    esp_err_t err = motor_prog_cancel(id);
+    if (err == ESP_ERR_NOT_FOUND) {
+        return motor_api_error(req, "404 Not Found", "Nieznane zadanie");
+    }
+    if (err == ESP_ERR_INVALID_STATE) {
+        return motor_api_error(req, "409 Conflict", "Zadanie już zakończone");
+    }
+    if (err != ESP_OK) {
+        return motor_api_error(req, "503 Service Unavailable", "Silnik zajęty");
+    }
+    return motor_api_job_send(req, id);
+}
+
+// Nazwa procedury z zapytania (?name=...)
+static bool motor_api_query_name(httpd_req_t *req, char *name, size_t size)
+{
+    char query[48];
+    return httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+           httpd_query_key_value(query, "name", name, size) == ESP_OK &&
+           motor_routine_name_valid(name);
+}
+
+static esp_err_t motor_api_routine_fault(httpd_req_t *req, const motor_routine_fault_t *fault)
+{
+    char body[96];
+    int len = snprintf(body, sizeof(body), "{\"error\":\"%s\",\"pc\":%u}",
+                       fault->reason, (unsigned)fault->pc);
+    return motor_api_send(req, "400 Bad Request", body, len);
+}
+
+// PUT /api/v1/routine?name=X - zapis procedury; ciało to blob kodu
+// bajtowego (nagłówek motor_routine_hdr_t i instrukcje, tools/routine_asm.py)
+static esp_err_t motor_api_routine_put_handler(httpd_req_t *req)
+{
+    char name[MOTOR_ROUTINE_NAME_MAX];
+    if (!motor_api_query_name(req, name, sizeof(name))) {
+        return motor_api_error(req, "400 Bad Request", "Niepoprawna nazwa");
+    }
+    if (req->content_len == 0 || req->content_len > MOTOR_ROUTINE_BLOB_MAX) {
+        return motor_api_error(req, "400 Bad Request", "Brak ciała lub za długie");
+    }
+
+    uint8_t blob[MOTOR_ROUTINE_BLOB_MAX];
+    size_t got = 0;
+    while (got < req->content_len) {
+        int n = httpd_req_recv(req, (char *)blob + got, req->content_len - got);
+        if (n == HTTPD_SOCK_ERR_TIMEOUT) {
+            continue;
+        }
+        if (n <= 0) {
+            return ESP_FAIL;
+        }
+        got += (size_t)n;
+    }
+
+    motor_routine_fault_t fault;
+    esp_err_t err = motor_routine_store(name, blob, got, &fault);
+    if (err == ESP_ERR_INVALID_ARG) {
+        return motor_api_routine_fault(req, &fault);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Zapis procedury %s: %s", name, esp_err_to_name(err));
+        return motor_api_error(req, "500 Internal Server Error", "Błąd zapisu NVS");
+    }
+    char body[64];
+    int len = snprintf(body, sizeof(body), "{\"routine\":\"%s\",\"insns\":%u}",
+                       name, (unsigned)((got - sizeof(motor_routine_hdr_t)) / sizeof(motor_insn_t)));
+    return motor_api_send(req, "200 OK", body, len);
+}
+
+// POST /api/v1/routine?name=X&motor=N - uruchomienie jako zadanie
+// (stan i anulowanie przez /api/v1/program?id=N)
+static esp_err_t motor_api_routine_post_handler(httpd_req_t *req)
+{
+    char name[MOTOR_ROUTINE_NAME_MAX];
+    if (!motor_api_query_name(req, name, sizeof(name))) {
+        return motor_api_error(req, "400 Bad Request", "Niepoprawna nazwa");
+    }
+    uint32_t motor = MOTOR_PRIMARY;
+    if (motor_api_query_uint(req, "motor", MOTOR_COUNT - 1, &motor) == ESP_ERR_INVALID_ARG) {
+        return motor_api_error(req, "400 Bad Request", "Niepoprawny silnik");
+    }
+
+    motor_routine_t routine;
+    esp_err_t err = motor_routine_get(name, &routine);
+    if (err == ESP_ERR_NOT_FOUND) {
+        return motor_api_error(req, "404 Not Found", "Nieznana procedura");
+    }
+    if (err != ESP_OK) {
+        return motor_api_error(req, "500 Internal Server Error", "Błąd odczytu NVS");
+    }
+    // Zapis sprawdził kod dla MOTOR_PRIMARY - czujniki zależą od silnika
+    motor_routine_fault_t fault;
+    if (motor_routine_validate(&routine, (uint8_t)motor, &fault) != ESP_OK) {
+        return motor_api_routine_fault(req, &fault);
+    }
+
+    uint32_t job;
+    err = motor_prog_submit_routine((uint8_t)motor, &routine, &job);
+    if (err == ESP_ERR_NO_MEM) {
+        return motor_api_error(req, "503 Service Unavailable", "Brak wolnego zadania");
+    }
+    if (err != ESP_OK) {
+        return motor_api_error(req, "503 Service Unavailable", "Silnik zajęty");
+    }
+    char body[80];
+    int len = snprintf(body, sizeof(body), "{\"job\":%" PRIu32 ",\"routine\":\"%s\",\"motor\":%" PRIu32 "}",
+                       job, name, motor);
+    return motor_api_send(req, "202 Accepted", body, len);
+}
+
+// DELETE /api/v1/routine?name=X
+static esp_err_t motor_api_routine_delete_handler(httpd_req_t *req)
+{
+    char name[MOTOR_ROUTINE_NAME_MAX];
+    if (!motor_api_query_name(req, name, sizeof(name))) {
+        return motor_api_error(req, "400 Bad Request", "Niepoprawna nazwa");
+    }
+    esp_err_t err = motor_routine_delete(name);
+    if (err == ESP_ERR_NOT_FOUND) {
+        return motor_api_error(req, "404 Not Found", "Nieznana procedura");
+    }
+    if (err != ESP_OK) {
+        return motor_api_error(req, "500 Internal Server Error", "Błąd zapisu NVS");
+    }
+    char body[48];
+    int len = snprintf(body, sizeof(body), "{\"routine\":\"%s\"}", name);
+    return motor_api_send(req, "200 OK", body, len);
+}
+
+esp_err_t motor_api_register(httpd_handle_t server)
+{
+#if CONFIG_MOTOR_API_HEAP_TRACE
+    esp_err_t err = heap_trace_init_standalone(s_trace_records, MOTOR_API_TRACE_RECORDS);
+    if (err != ESP_OK) {
+        return err;
+    }
+#endif
+    const httpd_uri_t post_uri = {
+        .uri       = "/api/v1/motor",
+        .method    = HTTP_POST,
+        .handler   = motor_api_post_handler
+    };
+    const httpd_uri_t get_uri = {
+        .uri       = "/api/v1/motor",
+        .method    = HTTP_GET,
+        .handler   = motor_api_get_handler
+    };
+    const httpd_uri_t prog_post_uri = {
+        .uri       = "/api/v1/program",
+        .method    = HTTP_POST,
+        .handler   = motor_api_prog_post_handler
+    };
+    const httpd_uri_t prog_get_uri = {
+        .uri       = "/api/v1/program",
+        .method    = HTTP_GET,
+        .handler   = motor_api_prog_get_handler
+    };
+    const httpd_uri_t prog_delete_uri = {
+        .uri       = "/api/v1/program",
+        .method    = HTTP_DELETE,
+        .handler   = motor_api_prog_delete_handler
+    };
+    const httpd_uri_t routine_put_uri = {
+        .uri       = "/api/v1/routine",
+        .method    = HTTP_PUT,
+        .handler   = motor_api_routine_put_handler
+    };
+    const httpd_uri_t routine_post_uri = {
+        .uri       = "/api/v1/routine",
+        .method    = HTTP_POST,
+        .handler   = motor_api_routine_post_handler
+    };
+    const httpd_uri_t routine_delete_uri = {
+        .uri       = "/api/v1/routine",
+        .method    = HTTP_DELETE,
+        .handler   = motor_api_routine_delete_handler
+    };
+    // Szybkie trasy w zadaniu serwera (POST /api/v1/motor bez sterty)
+    const httpd_uri_t *uris[] = {
+        &post_uri, &get_uri, &prog_get_uri, &prog_delete_uri
+    };
+    // Długie ciało albo NVS - w puli zadań
+    const httpd_uri_t *pooled[] = {
+        &prog_post_uri, &routine_put_uri, &routine_post_uri, &routine_delete_uri
+    };
+    esp_err_t ret = motor_routine_init();
+    for (size_t i = 0; i < sizeof(uris) / sizeof(uris[0]) && ret == ESP_OK; i++) {
+        ret = httpd_register_uri_handler(server, uris[i]);
+    }
+    for (size_t i = 0; i < sizeof(pooled) / sizeof(pooled[0]) && ret == ESP_OK; i++) {
+        ret = http_pool_register(server, pooled[i]);
+    }
+    return ret;
+}
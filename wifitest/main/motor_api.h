@@ -0,0 +1,30 @@
+#pragma once
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+// REST API silników w JSON: /api/v1/motor.
+//
+// POST z ciałem (wszystkie pola opcjonalne):
+//   {"motor":0,"dir":"fwd"|"rev","duty":0..4095,"duration_ms":N,
+//    "ramp":"none|linear|trapezoid|scurve","ramp_ms":N}
+// duration_ms > 0 to praca przez zadany czas i stop (MOTOR_CMD_PULSE),
+// 0 lub brak - praca ciągła (MOTOR_CMD_RUN). Odpowiedź 202 powtarza
+// przyjętą komendę; 400 i 503 mają ciało {"error":"..."}.
+//
+// GET ?motor=N - stan silnika.
+//
+// /api/v1/program (motor_prog): POST ?motor=N z tablicą kroków
+//   [{"dir":..,"duty":..,"duration_ms":N albo "pos":N,"ramp":..,"ramp_ms":..}, ...]
+// zwraca 202 {"job":N,...}; GET ?id=N - stan zadania, DELETE ?id=N - anulowanie
+// (404 nieznane, 409 już zakończone).
+//
+// /api/v1/routine (motor_routine): PUT ?name=X z blobem kodu bajtowego -
+// zapis w NVS, POST ?name=X&motor=N - uruchomienie jako zadanie programu,
+// DELETE ?name=X - usunięcie. Zły kod to 400 {"error":"...","pc":N}.
+//
+// Ciało jest parsowane strumieniowo (json_scan) do stałej struktury,
+// a odpowiedzi składa snprintf w buforze statycznym - obsługa żądania
+// nie korzysta ze sterty.
+
+esp_err_t motor_api_register(httpd_handle_t server);
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+
+// Warstwa sprzętowa mostka H. Na układzie ESP32 to kanały LEDC
+// (motor_hw_ledc.c) albo operatory MCPWM z czasem martwym i wyborem
+// hamowania lub wybiegu (motor_hw_mcpwm.c, CONFIG_MOTOR_HW_MCPWM).
+// W kompilacji na hosta (IDF_TARGET linux) i w QEMU (CONFIG_MOTOR_HW_SIM)
+// symulacja zapisująca zmiany wypełnienia ze znacznikiem czasu (motor_hw_sim.c).
+// Mostków jest CONFIG_MOTOR_COUNT; każdy ma parę kanałów IN1/IN2.
+
+// Wejścia mostka
+typedef enum {
+    MOTOR_HW_IN1,
+    MOTOR_HW_IN2,
+    MOTOR_HW_CH_MAX
+} motor_hw_ch_t;
+
+// Koniec zanikania na kanale silnika motor - wywoływane z przerwania (LEDC)
+// albo z zadania esp_timer (symulacja). Zwraca true, gdy trzeba przełączyć zadanie.
+typedef bool (*motor_hw_fade_cb_t)(uint8_t motor, motor_hw_ch_t ch, void *arg);
+
+// Konfiguracja kanałów wszystkich mostków z wypełnieniem 0 i sterownika zanikania
+esp_err_t motor_hw_init(void);
+
+// Rejestracja powiadomienia o końcu zanikania (wspólnego dla silników)
+esp_err_t motor_hw_set_fade_cb(motor_hw_fade_cb_t cb, void *arg);
+
+// Skokowe ustawienie wypełnienia obu wejść mostka motor
+void motor_hw_set(uint8_t motor, uint32_t in1, uint32_t in2);
+
+// Stan jednego mostka w zapisie grupowym
+typedef struct {
+    uint8_t motor;
+    uint32_t in1;
+    uint32_t in2;
+} motor_hw_bridge_t;
+
+// Skokowe ustawienie kilku mostków naraz. Nowe wypełnienia wszystkich
+// kanałów są zatwierdzane jedno po drugim w sekcji krytycznej, więc kanały
+// na wspólnym timerze LEDC przełączają się w tym samym okresie PWM.
+void motor_hw_set_group(const motor_hw_bridge_t *bridges, size_t count);
+
+// Zanikanie do target w czasie fade_ms bez blokowania.
+// Koniec zgłaszany przez motor_hw_fade_cb_t.
+esp_err_t motor_hw_fade(uint8_t motor, motor_hw_ch_t ch, uint32_t target, uint32_t fade_ms);
+
+// Przerwanie zanikania obu kanałów mostka motor (STOP w trakcie rampy).
+// Wypełnienie zostaje na wartości pośredniej; koniec przerwanego
+// zanikania może nie zostać zgłoszony.
+void motor_hw_fade_stop(uint8_t motor);
+
+// Bieżące wypełnienie kanału, także w trakcie zanikania
+uint32_t motor_hw_get_duty(uint8_t motor, motor_hw_ch_t ch);
+
+// Awaryjne wyłączenie mostka z pominięciem kolejki i zadania silnika
+// (watchdog łącza). Wejścia od razu na 0 i blokada mostka: do
+// motor_hw_release zapisy dają 0, a zanikanie zwraca ESP_ERR_INVALID_STATE,
+// więc ruch w toku nie włączy go ponownie. Zanikanie w toku zatrzymuje
+// potem zadanie silnika. Wolno wołać z przerwania (callback ESP_TIMER_ISR):
+// bez mutexów, tylko spinlock i zapisy sterownika z IRAM.
+void motor_hw_trip(uint8_t motor);
+
+// Zdjęcie blokady po motor_hw_trip (zadanie silnika przy obsłudze stopu,
+// przed zapisem zera). true, gdy mostek był zablokowany.
+bool motor_hw_release(uint8_t motor);
+
+// Zakres częstotliwości PWM ustawianej w czasie pracy
+#define MOTOR_HW_FREQ_MIN_HZ 1000
+#define MOTOR_HW_FREQ_MAX_HZ 40000
+
+// Zmiana częstotliwości PWM wszystkich mostków. Rozdzielczość sprzętowa
+// jest największą, jaką daje zegar timera przy tej częstotliwości, a
+// wypełnienia (zawsze 0..PWM_DUTY) są przeliczane na nową skalę, więc
+// silniki nie zmieniają prędkości. ESP_ERR_INVALID_STATE, gdy trwa
+// sprzętowe zanikanie (LEDC).
+esp_err_t motor_hw_set_freq(uint32_t freq_hz);
+
+// Bieżąca częstotliwość PWM i rozdzielczość sprzętowa w bitach
+void motor_hw_get_pwm(uint32_t *freq_hz, uint8_t *bits);
+
+#if CONFIG_MOTOR_HW_SIM
+#include "esp_http_server.h"
+
+// Zapis zmiany wypełnienia w symulacji
+typedef struct {
+    int64_t t_us;           // chwila zmiany (esp_timer_get_time)
+    uint32_t seq;           // numer kolejny zapisu
+    uint16_t duty;          // wypełnienie docelowe
+    uint16_t fade_ms;       // 0 - skokowo, inaczej czas zanikania
+    uint8_t motor;
+    uint8_t ch;             // motor_hw_ch_t
+} motor_hw_sim_event_t;
+
+// Zapisy o numerach >= *since, najwyżej max. Gdy starsze wpisy nadpisano,
+// *since przesuwa się na najstarszy zachowany.
+size_t motor_hw_sim_trace(uint32_t *since, motor_hw_sim_event_t *events, size_t max);
+
+// Endpoint /sim/trace z zapisem zmian wypełnienia do benchmarku
+esp_err_t motor_hw_sim_register(httpd_handle_t server);
+#endif
@@ -0,0 +1,373 @@
+#include <inttypes.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "soc/soc_caps.h"
+#include "driver/ledc.h"
+#include "motor.h"
+#include "motor_hw.h"
+
+static const char *TAG = "motor_hw";
+
+// Timery taktowane z APB - rozdzielczość wynika ze stałej częstotliwości zegara
+#define LEDC_SRC_CLK_HZ 80000000
+
+// Mapa silnik -> timer i kanały LEDC. Silniki w jednym trybie dzielą
+// timer, więc okresy PWM wszystkich mostków są zgodne w fazie. Na ESP32
+// kanały trybu niskiej prędkości wystarczają na cztery mostki, piąty
+// korzysta z trybu wysokiej prędkości.
+typedef struct {
+    ledc_mode_t mode;
+    ledc_timer_t timer;
+    ledc_channel_t channel[MOTOR_HW_CH_MAX];
+    int gpio[MOTOR_HW_CH_MAX];
+} motor_hw_map_t;
+
+#if (CONFIG_MOTOR_COUNT > 4 && !SOC_LEDC_SUPPORT_HS_MODE) || \
+    (CONFIG_MOTOR_COUNT <= 4 && CONFIG_MOTOR_COUNT * 2 > SOC_LEDC_CHANNEL_NUM)
+#error "Za mało kanałów LEDC dla CONFIG_MOTOR_COUNT"
+#endif
+
+// W DRAM, bo czyta ją też motor_hw_trip z przerwania
+static const DRAM_ATTR motor_hw_map_t s_map[CONFIG_MOTOR_COUNT] = {
+    { LEDC_LOW_SPEED_MODE, LEDC_TIMER_0, { LEDC_CHANNEL_0, LEDC_CHANNEL_1 },
+      { CONFIG_MOTOR0_IN1_GPIO, CONFIG_MOTOR0_IN2_GPIO } },
+#if CONFIG_MOTOR_COUNT > 1
+    { LEDC_LOW_SPEED_MODE, LEDC_TIMER_0, { LEDC_CHANNEL_2, LEDC_CHANNEL_3 },
+      { CONFIG_MOTOR1_IN1_GPIO, CONFIG_MOTOR1_IN2_GPIO } },
+#endif
+#if CONFIG_MOTOR_COUNT > 2
+    { LEDC_LOW_SPEED_MODE, LEDC_TIMER_0, { LEDC_CHANNEL_4, LEDC_CHANNEL_5 },
+      { CONFIG_MOTOR2_IN1_GPIO, CONFIG_MOTOR2_IN2_GPIO } },
+#endif
+#if CONFIG_MOTOR_COUNT > 3
+    { LEDC_LOW_SPEED_MODE, LEDC_TIMER_0, { LEDC_CHANNEL_6, LEDC_CHANNEL_7 },
+      { CONFIG_MOTOR3_IN1_GPIO, CONFIG_MOTOR3_IN2_GPIO } },
+#endif
+#if CONFIG_MOTOR_COUNT > 4
+    { LEDC_HIGH_SPEED_MODE, LEDC_TIMER_0, { LEDC_CHANNEL_0, LEDC_CHANNEL_1 },
+      { CONFIG_MOTOR4_IN1_GPIO, CONFIG_MOTOR4_IN2_GPIO } },
+#endif
+};
+
+static motor_hw_fade_cb_t s_fade_cb;
+static void *s_fade_arg;
+static portMUX_TYPE s_commit_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Konfiguracja timerów: zmiana częstotliwości nie może się przeplatać
+// z zapisem wypełnienia w innej skali
+static SemaphoreHandle_t s_cfg_lock;
+static uint32_t s_freq_hz;
+static uint32_t s_bits;
+static uint32_t s_fading;       // bit motor * MOTOR_HW_CH_MAX + ch, pod s_commit_lock
+// Bit silnika zablokowanego przez motor_hw_trip. Ustawiany z przerwania,
+// więc bez s_cfg_lock; zatwierdzenie wypełnienia sprawdza go ponownie
+// pod s_commit_lock, który bierze też motor_hw_trip.
+static _Atomic uint32_t s_tripped;
+
+// Wypełnienie interfejsu (0..PWM_DUTY, 12 bitów) w skali timera i odwrotnie
+static uint32_t ledc_duty_to_hw(uint32_t duty)
+{
+    return (uint32_t)(((uint64_t)duty << s_bits) / (PWM_DUTY + 1));
+}
+
+static uint32_t ledc_duty_from_hw(uint32_t hw)
+{
+    return (uint32_t)(((uint64_t)hw * (PWM_DUTY + 1)) >> s_bits);
+}
+
+// Największa rozdzielczość, przy której licznik timera mieści się
+// w okresie freq_hz; 0 - częstotliwość nieosiągalna
+static uint32_t ledc_resolution(uint32_t freq_hz)
+{
+    uint32_t bits = ledc_find_suitable_duty_resolution(LEDC_SRC_CLK_HZ, freq_hz);
+    return bits > SOC_LEDC_TIMER_BIT_WIDTH ? SOC_LEDC_TIMER_BIT_WIDTH : bits;
+}
+
+// Konfiguracja wszystkich timerów - każdy przy pierwszym używającym go silniku
+static esp_err_t ledc_timers_config(uint32_t freq_hz, uint32_t bits)
+{
+    for (int m = 0; m < CONFIG_MOTOR_COUNT; m++) {
+        const motor_hw_map_t *map = &s_map[m];
+        if (m > 0 && map->mode == s_map[m - 1].mode && map->timer == s_map[m - 1].timer) {
+            continue;
+        }
+        esp_err_t err;
+        if (bits == s_bits) {
+            err = ledc_set_freq(map->mode, map->timer, freq_hz);
+        } else {
+            ledc_timer_config_t timer_conf = {
+                .speed_mode = map->mode,
+                .duty_resolution = (ledc_timer_bit_t)bits,
+                .timer_num = map->timer,
+                .freq_hz = freq_hz,
+                .clk_cfg = LEDC_USE_APB_CLK
+            };
+            err = ledc_timer_config(&timer_conf);
+        }
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+// Argument callbacku LEDC: numer silnika i kanału w jednym słowie
+#define MOTOR_HW_CB_ARG(motor, ch) ((void *)(uintptr_t)((motor) * MOTOR_HW_CH_MAX + (ch)))
+
+esp_err_t motor_hw_init(void)
+{
+    s_cfg_lock = xSemaphoreCreateMutex();
+    if (s_cfg_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_freq_hz = CONFIG_MOTOR_PWM_FREQ_HZ;
+    uint32_t bits = ledc_resolution(s_freq_hz);
+    ESP_ERROR_CHECK(ledc_timers_config(s_freq_hz, bits));
+    s_bits = bits;
+
+    for (int m = 0; m < CONFIG_MOTOR_COUNT; m++) {
+        const motor_hw_map_t *map = &s_map[m];
+
+        for (int ch = 0; ch < MOTOR_HW_CH_MAX; ch++) {
+            ledc_channel_config_t channel_conf = {
+                .gpio_num = map->gpio[ch],
+                .speed_mode = map->mode,
+                .channel = map->channel[ch],
+                .intr_type = LEDC_INTR_DISABLE,
+                .timer_sel = map->timer,
+                .duty = 0,
+                .hpoint = 0
+            };
+            ESP_ERROR_CHECK(ledc_channel_config(&channel_conf));
+        }
+        ESP_LOGI(TAG, "Silnik %d: IN1 GPIO%d, IN2 GPIO%d", m, map->gpio[MOTOR_HW_IN1], map->gpio[MOTOR_HW_IN2]);
+    }
+
+    // Zanikanie sprzętowe dla ramp rozruchu i hamowania
+    ESP_ERROR_CHECK(ledc_fade_func_install(0));
+
+    ESP_LOGI(TAG, "LEDC: %d silników, %" PRIu32 " Hz, %" PRIu32 " bitów", CONFIG_MOTOR_COUNT, s_freq_hz, s_bits);
+    return ESP_OK;
+}
+
+// Koniec zanikania na jednym z kanałów (przerwanie LEDC)
+static bool IRAM_ATTR motor_hw_fade_end_cb(const ledc_cb_param_t *param, void *user_arg)
+{
+    if (param->event != LEDC_FADE_END_EVT || s_fade_cb == NULL) {
+        return false;
+    }
+    uintptr_t id = (uintptr_t)user_arg;
+    portENTER_CRITICAL_ISR(&s_commit_lock);
+    s_fading &= ~BIT(id);
+    // Koniec zanikania zatwierdza wypełnienie docelowe - mostek zablokowany
+    // w jego trakcie zostaje wyłączony
+    if (atomic_load(&s_tripped) & BIT(id / MOTOR_HW_CH_MAX)) {
+        ledc_stop((ledc_mode_t)param->speed_mode, (ledc_channel_t)param->channel, 0);
+    }
+    portEXIT_CRITICAL_ISR(&s_commit_lock);
+    return s_fade_cb((uint8_t)(id / MOTOR_HW_CH_MAX), (motor_hw_ch_t)(id % MOTOR_HW_CH_MAX), s_fade_arg);
+}
+
+esp_err_t motor_hw_set_fade_cb(motor_hw_fade_cb_t cb, void *arg)
+{
+    s_fade_cb = cb;
+    s_fade_arg = arg;
+
+    ledc_cbs_t fade_cbs = {
+        .fade_cb = motor_hw_fade_end_cb
+    };
+    for (int m = 0; m < CONFIG_MOTOR_COUNT; m++) {
+        for (int ch = 0; ch < MOTOR_HW_CH_MAX; ch++) {
+            esp_err_t err = ledc_cb_register(s_map[m].mode, s_map[m].channel[ch], &fade_cbs, MOTOR_HW_CB_ARG(m, ch));
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+void motor_hw_set(uint8_t motor, uint32_t in1, uint32_t in2)
+{
+    const motor_hw_map_t *map = &s_map[motor];
+
+    xSemaphoreTake(s_cfg_lock, portMAX_DELAY);
+    ledc_set_duty(map->mode, map->channel[MOTOR_HW_IN1], ledc_duty_to_hw(in1));
+    ledc_set_duty(map->mode, map->channel[MOTOR_HW_IN2], ledc_duty_to_hw(in2));
+    // Zablokowany mostek: ledc_stop już trzyma wyjścia na 0, a zatwierdzenie
+    // włączyłoby je z powrotem
+    portENTER_CRITICAL(&s_commit_lock);
+    if (!(atomic_load(&s_tripped) & BIT(motor))) {
+        ledc_update_duty(map->mode, map->channel[MOTOR_HW_IN1]);
+        ledc_update_duty(map->mode, map->channel[MOTOR_HW_IN2]);
+    }
+    portEXIT_CRITICAL(&s_commit_lock);
+    xSemaphoreGive(s_cfg_lock);
+}
+
+void motor_hw_set_group(const motor_hw_bridge_t *bridges, size_t count)
+{
+    // Najpierw rejestry wypełnienia, potem same zatwierdzenia - bez przerwań
+    // i przełączeń zadań dzieli je kilkadziesiąt cykli, a sprzęt przejmuje
+    // nowe wartości dopiero na końcu okresu PWM
+    xSemaphoreTake(s_cfg_lock, portMAX_DELAY);
+    for (size_t i = 0; i < count; i++) {
+        const motor_hw_map_t *map = &s_map[bridges[i].motor];
+        ledc_set_duty(map->mode, map->channel[MOTOR_HW_IN1], ledc_duty_to_hw(bridges[i].in1));
+        ledc_set_duty(map->mode, map->channel[MOTOR_HW_IN2], ledc_duty_to_hw(bridges[i].in2));
+    }
+
+    portENTER_CRITICAL(&s_commit_lock);
+    const uint32_t tripped = atomic_load(&s_tripped);
+    for (size_t i = 0; i < count; i++) {
+        const motor_hw_map_t *map = &s_map[bridges[i].motor];
+        if (!(tripped & BIT(bridges[i].motor))) {
+            ledc_update_duty(map->mode, map->channel[MOTOR_HW_IN1]);
+            ledc_update_duty(map->mode, map->channel[MOTOR_HW_IN2]);
+        }
+    }
+    portEXIT_CRITICAL(&s_commit_lock);
+    xSemaphoreGive(s_cfg_lock);
+}
+
+esp_err_t motor_hw_fade(uint8_t motor, motor_hw_ch_t ch, uint32_t target, uint32_t fade_ms)
+{
+    const motor_hw_map_t *map = &s_map[motor];
+
+    xSemaphoreTake(s_cfg_lock, portMAX_DELAY);
+    if (atomic_load(&s_tripped) & BIT(motor)) {
+        xSemaphoreGive(s_cfg_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t err = ledc_set_fade_with_time(map->mode, map->channel[ch], ledc_duty_to_hw(target), fade_ms);
+    if (err == ESP_OK) {
+        portENTER_CRITICAL(&s_commit_lock);
+        s_fading |= BIT(motor * MOTOR_HW_CH_MAX + ch);
+        portEXIT_CRITICAL(&s_commit_lock);
+        err = ledc_fade_start(map->mode, map->channel[ch], LEDC_FADE_NO_WAIT);
+    }
+    // Blokada z przerwania między sprawdzeniem a startem - start zanikania
+    // włączył wyjście, więc wyłącza je ten, kto widzi oba zdarzenia
+    if (atomic_load(&s_tripped) & BIT(motor)) {
+        ledc_fade_stop(map->mode, map->channel[ch]);
+        portENTER_CRITICAL(&s_commit_lock);
+        s_fading &= ~BIT(motor * MOTOR_HW_CH_MAX + ch);
+        ledc_stop(map->mode, map->channel[ch], 0);
+        portEXIT_CRITICAL(&s_commit_lock);
+        err = ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreGive(s_cfg_lock);
+    return err;
+}
+
+void motor_hw_fade_stop(uint8_t motor)
+{
+    const motor_hw_map_t *map = &s_map[motor];
+
+    xSemaphoreTake(s_cfg_lock, portMAX_DELAY);
+    for (int ch = 0; ch < MOTOR_HW_CH_MAX; ch++) {
+        ledc_fade_stop(map->mode, map->channel[ch]);
+    }
+    portENTER_CRITICAL(&s_commit_lock);
+    s_fading &= ~(BIT(motor * MOTOR_HW_CH_MAX + MOTOR_HW_IN1) | BIT(motor * MOTOR_HW_CH_MAX + MOTOR_HW_IN2));
+    portEXIT_CRITICAL(&s_commit_lock);
+    xSemaphoreGive(s_cfg_lock);
+}
+
+void IRAM_ATTR motor_hw_trip(uint8_t motor)
+{
+    const motor_hw_map_t *map = &s_map[motor];
+
+    // ledc_stop (w IRAM przy CONFIG_LEDC_CTRL_FUNC_IN_IRAM) odcina wyjście
+    // na poziom 0 także w trakcie zanikania; samo zanikanie zatrzymuje
+    // zadanie silnika (motor_hw_fade_stop), bo ledc_fade_stop może czekać
+    atomic_fetch_or(&s_tripped, BIT(motor));
+    portENTER_CRITICAL_SAFE(&s_commit_lock);
+    for (int ch = 0; ch < MOTOR_HW_CH_MAX; ch++) {
+        ledc_stop(map->mode, map->channel[ch], 0);
+    }
+    portEXIT_CRITICAL_SAFE(&s_commit_lock);
+}
+
+bool motor_hw_release(uint8_t motor)
+{
+    return (atomic_fetch_and(&s_tripped, ~BIT(motor)) & BIT(motor)) != 0;
+}
+
+uint32_t motor_hw_get_duty(uint8_t motor, motor_hw_ch_t ch)
+{
+    // Rejestry LEDC pokazują też wartości pośrednie w trakcie zanikania
+    xSemaphoreTake(s_cfg_lock, portMAX_DELAY);
+    uint32_t duty = ledc_duty_from_hw(ledc_get_duty(s_map[motor].mode, s_map[motor].channel[ch]));
+    xSemaphoreGive(s_cfg_lock);
+    return duty;
+}
+
+esp_err_t motor_hw_set_freq(uint32_t freq_hz)
+{
+    uint32_t bits = ledc_resolution(freq_hz);
+    if (freq_hz < MOTOR_HW_FREQ_MIN_HZ || freq_hz > MOTOR_HW_FREQ_MAX_HZ || bits == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(s_cfg_lock, portMAX_DELAY);
+    // Cel zanikania w toku jest w starej skali, a ESP32 nie zmienia
+    // wypełnienia kanału w trakcie zanikania
+    portENTER_CRITICAL(&s_commit_lock);
+    bool fading = (s_fading != 0);
+    portEXIT_CRITICAL(&s_commit_lock);
+    if (fading) {
+        xSemaphoreGive(s_cfg_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t duty[CONFIG_MOTOR_COUNT][MOTOR_HW_CH_MAX];
+    for (int m = 0; m < CONFIG_MOTOR_COUNT; m++) {
+        for (int ch = 0; ch < MOTOR_HW_CH_MAX; ch++) {
+            duty[m][ch] = ledc_duty_from_hw(ledc_get_duty(s_map[m].mode, s_map[m].channel[ch]));
+        }
+    }
+
+    esp_err_t err = ledc_timers_config(freq_hz, bits);
+    if (err == ESP_OK) {
+        s_freq_hz = freq_hz;
+        s_bits = bits;
+    } else {
+        ESP_LOGE(TAG, "Nie można ustawić %" PRIu32 " Hz: %s", freq_hz, esp_err_to_name(err));
+    }
+
+    // Te same wypełnienia w nowej skali - silniki nie zmieniają prędkości
+    for (int m = 0; m < CONFIG_MOTOR_COUNT; m++) {
+        for (int ch = 0; ch < MOTOR_HW_CH_MAX; ch++) {
+            ledc_set_duty(s_map[m].mode, s_map[m].channel[ch], ledc_duty_to_hw(duty[m][ch]));
+        }
+    }
+    // Zablokowane mostki zostają odcięte - jak w motor_hw_set
+    portENTER_CRITICAL(&s_commit_lock);
+    const uint32_t tripped = atomic_load(&s_tripped);
+    for (int m = 0; m < CONFIG_MOTOR_COUNT; m++) {
+        if (!(tripped & BIT(m))) {
+            for (int ch = 0; ch < MOTOR_HW_CH_MAX; ch++) {
+                ledc_update_duty(s_map[m].mode, s_map[m].channel[ch]);
+            }
+        }
+    }
+    portEXIT_CRITICAL(&s_commit_lock);
+    xSemaphoreGive(s_cfg_lock);
+
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "PWM %" PRIu32 " Hz, %" PRIu32 " bitów", freq_hz, bits);
+    }
+    return err;
+}
+
+void motor_hw_get_pwm(uint32_t *freq_hz, uint8_t *bits)
+{
+    xSemaphoreTake(s_cfg_lock, portMAX_DELAY);
+    *freq_hz = s_freq_hz;
+    *bits = (uint8_t)s_bits;
+    xSemaphoreGive(s_cfg_lock);
+}
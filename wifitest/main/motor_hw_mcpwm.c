@@ -0,0 +1,489 @@
+#include <inttypes.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "soc/soc_caps.h"
+#include "driver/mcpwm_prelude.h"
+#include "motor.h"
+#include "motor_hw.h"
+
+static const char *TAG = "motor_hw";
+
+// Zegar timerów 10 MHz - przy 5 kHz to 2000 kroków na okres, przy
+// MOTOR_HW_FREQ_MIN_HZ okres mieści się w 16-bitowym liczniku
+#define MCPWM_RESOLUTION_HZ 10000000
+#define MCPWM_DEAD_TIME_TICKS ((uint32_t)((uint64_t)CONFIG_MOTOR_MCPWM_DEAD_TIME_NS * MCPWM_RESOLUTION_HZ / 1000000000))
+
+// MCPWM nie ma sprzętowego zanikania - rampy przesuwa timer co 1 ms
+#define MCPWM_FADE_STEP_US 1000
+
+// Poziom obu wejść mostka w spoczynku i w przerwie impulsu PWM:
+// 0 - wybieg (szybkie wygaszanie prądu), 1 - hamowanie (wolne wygaszanie)
+#if CONFIG_MOTOR_MCPWM_BRAKE
+#define MCPWM_IDLE_LEVEL 1
+#else
+#define MCPWM_IDLE_LEVEL 0
+#endif
+
+// Jeden mostek to jeden operator MCPWM: komparator wyznacza wypełnienie,
+// generator A steruje IN1, generator B - IN2. Operatory grupy dzielą
+// timer, więc okresy PWM mostków są zgodne w fazie.
+#define MCPWM_MOTORS_PER_GROUP SOC_MCPWM_OPERATORS_PER_GROUP
+
+#if CONFIG_MOTOR_COUNT > SOC_MCPWM_GROUPS * SOC_MCPWM_OPERATORS_PER_GROUP
+#error "Za mało operatorów MCPWM dla CONFIG_MOTOR_COUNT"
+#endif
+
+typedef enum {
+    MCPWM_BRIDGE_IDLE,
+    MCPWM_BRIDGE_FORWARD,
+    MCPWM_BRIDGE_REVERSE,
+} mcpwm_bridge_state_t;
+
+typedef struct {
+    uint32_t from;
+    uint32_t to;
+    int64_t t0_us;
+    uint32_t fade_ms;       // 0 - brak zanikania w toku
+} mcpwm_fade_t;
+
+typedef struct {
+    mcpwm_cmpr_handle_t cmpr;
+    mcpwm_gen_handle_t gen[MOTOR_HW_CH_MAX];
+    uint32_t duty[MOTOR_HW_CH_MAX];
+    mcpwm_fade_t fade[MOTOR_HW_CH_MAX];
+    mcpwm_bridge_state_t state;
+} mcpwm_bridge_t;
+
+static const int s_gpio[CONFIG_MOTOR_COUNT][MOTOR_HW_CH_MAX] = {
+    { CONFIG_MOTOR0_IN1_GPIO, CONFIG_MOTOR0_IN2_GPIO },
+#if CONFIG_MOTOR_COUNT > 1
+    { CONFIG_MOTOR1_IN1_GPIO, CONFIG_MOTOR1_IN2_GPIO },
+#endif
+#if CONFIG_MOTOR_COUNT > 2
+    { CONFIG_MOTOR2_IN1_GPIO, CONFIG_MOTOR2_IN2_GPIO },
+#endif
+#if CONFIG_MOTOR_COUNT > 3
+    { CONFIG_MOTOR3_IN1_GPIO, CONFIG_MOTOR3_IN2_GPIO },
+#endif
+#if CONFIG_MOTOR_COUNT > 4
+    { CONFIG_MOTOR4_IN1_GPIO, CONFIG_MOTOR4_IN2_GPIO },
+#endif
+};
+
+// Stan mostków i okres timerów. Funkcje sterownika MCPWM biorą własne
+// blokady i nie mogą być wołane w sekcji krytycznej, więc całość chroni
+// mutex - zapisy idą z zadań silników, HTTP i zadania esp_timer (rampy).
+static SemaphoreHandle_t s_bridge_lock;
+static mcpwm_bridge_t s_bridge[CONFIG_MOTOR_COUNT];
+static mcpwm_timer_handle_t s_timers[SOC_MCPWM_GROUPS];
+static int s_groups;
+static uint32_t s_freq_hz;
+static uint32_t s_period_ticks;     // pod s_bridge_lock
+// Bit silnika zablokowanego przez motor_hw_trip - ustawiany z przerwania,
+// więc poza s_bridge_lock
+static _Atomic uint32_t s_tripped;
+static esp_timer_handle_t s_fade_timer;
+static uint32_t s_fading;       // bit motor * MOTOR_HW_CH_MAX + ch, pod s_bridge_lock
+static motor_hw_fade_cb_t s_fade_cb;
+static void *s_fade_arg;
+
+// Wyjście B przechodzi przez moduł czasu martwego z inwersją, więc
+// generator B pracuje na poziomach odwróconych względem IN2
+static IRAM_ATTR int mcpwm_gen_level(motor_hw_ch_t ch, int level)
+{
+    return (ch == MOTOR_HW_IN2) ? !level : level;
+}
+
+// Przebieg PWM wejścia ch: od początku okresu do komparatora poziom
+// przeciwny do spoczynkowego. Przy wybiegu to impuls zasilanej gałęzi,
+// przy hamowaniu - przerwa w hamowaniu na gałęzi przeciwnej, czyli
+// dopełnienie impulsu zasilania.
+static esp_err_t mcpwm_gen_actions(const mcpwm_bridge_t *b, motor_hw_ch_t ch)
+{
+    const int start = mcpwm_gen_level(ch, !MCPWM_IDLE_LEVEL);
+    esp_err_t err = mcpwm_generator_set_action_on_timer_event(b->gen[ch],
+        MCPWM_GEN_TIMER_EVENT_ACTION(MCPWM_TIMER_DIRECTION_UP, MCPWM_TIMER_EVENT_EMPTY,
+                                     start ? MCPWM_GEN_ACTION_HIGH : MCPWM_GEN_ACTION_LOW));
+    if (err != ESP_OK) {
+        return err;
+    }
+    return mcpwm_generator_set_action_on_compare_event(b->gen[ch],
+        MCPWM_GEN_COMPARE_EVENT_ACTION(MCPWM_TIMER_DIRECTION_UP, b->cmpr,
+                                       start ? MCPWM_GEN_ACTION_LOW : MCPWM_GEN_ACTION_HIGH));
+}
+
+// Czas martwy: opóźnienie narastającego zbocza na obu wyjściach. A przez
+// moduł RED, B przez FED z inwersją (generator B jest odwrócony), więc
+// żadne wejście nie włącza się wcześniej niż MCPWM_DEAD_TIME_TICKS po
+// wyłączeniu drugiego - także przy zmianie kierunku.
+static esp_err_t mcpwm_dead_time(const mcpwm_bridge_t *b)
+{
+    const mcpwm_dead_time_config_t red = {
+        .posedge_delay_ticks = MCPWM_DEAD_TIME_TICKS
+    };
+    esp_err_t err = mcpwm_generator_set_dead_time(b->gen[MOTOR_HW_IN1], b->gen[MOTOR_HW_IN1], &red);
+    if (err != ESP_OK) {
+        return err;
+    }
+    const mcpwm_dead_time_config_t fed = {
+        .negedge_delay_ticks = MCPWM_DEAD_TIME_TICKS,
+        .flags.invert_output = true
+    };
+    return mcpwm_generator_set_dead_time(b->gen[MOTOR_HW_IN2], b->gen[MOTOR_HW_IN2], &fed);
+}
+
+// Wymuszenie poziomu wyjścia (level) albo zwolnienie do przebiegu PWM (-1).
+// mcpwm_generator_set_force_level jest w IRAM przy
+// CONFIG_MCPWM_CTRL_FUNC_IN_IRAM i wolno ją wołać z przerwania.
+static IRAM_ATTR void mcpwm_force(const mcpwm_bridge_t *b, motor_hw_ch_t ch, int level)
+{
+    mcpwm_generator_set_force_level(b->gen[ch], level < 0 ? -1 : mcpwm_gen_level(ch, level), true);
+}
+
+// Przeniesienie wypełnień wejść na operator. Jedna gałąź mostka trzyma
+// poziom spoczynkowy, druga dostaje przebieg PWM: przy wybiegu gałąź
+// zasilana, przy hamowaniu - przeciwna. Wołane pod s_bridge_lock.
+static void mcpwm_apply(mcpwm_bridge_t *b)
+{
+    const uint32_t bit = BIT(b - s_bridge);
+    // Oba wejścia niezerowe (rampa przez zmianę kierunku) - jak w LEDC
+    // napięcie średnie wyznacza różnica wypełnień. Zablokowany mostek
+    // zostaje w spoczynku, także w trakcie rampy.
+    const bool tripped = (atomic_load(&s_tripped) & bit) != 0;
+    const uint32_t in1 = tripped ? 0 : b->duty[MOTOR_HW_IN1];
+    const uint32_t in2 = tripped ? 0 : b->duty[MOTOR_HW_IN2];
+    mcpwm_bridge_state_t state = MCPWM_BRIDGE_IDLE;
+    uint32_t duty = 0;
+    if (in1 > in2) {
+        state = MCPWM_BRIDGE_FORWARD;
+        duty = in1 - in2;
+    } else if (in2 > in1) {
+        state = MCPWM_BRIDGE_REVERSE;
+        duty = in2 - in1;
+    }
+
+    // Nowa wartość komparatora obowiązuje od początku następnego okresu
+    mcpwm_comparator_set_compare_value(b->cmpr, duty * s_period_ticks / PWM_DUTY);
+    if (state == b->state) {
+        return;
+    }
+    b->state = state;
+
+    if (state == MCPWM_BRIDGE_IDLE) {
+        mcpwm_force(b, MOTOR_HW_IN1, MCPWM_IDLE_LEVEL);
+        mcpwm_force(b, MOTOR_HW_IN2, MCPWM_IDLE_LEVEL);
+        return;
+    }
+    const motor_hw_ch_t driven = (state == MCPWM_BRIDGE_FORWARD) ? MOTOR_HW_IN1 : MOTOR_HW_IN2;
+    const motor_hw_ch_t other = (driven == MOTOR_HW_IN1) ? MOTOR_HW_IN2 : MOTOR_HW_IN1;
+    const motor_hw_ch_t pwm = MCPWM_IDLE_LEVEL ? other : driven;
+    mcpwm_force(b, pwm == driven ? other : driven, MCPWM_IDLE_LEVEL);
+    mcpwm_force(b, pwm, -1);
+
+    // motor_hw_trip między sprawdzeniem a zwolnieniem wyjścia - jego
+    // wymuszenie mogło przyjść przed naszym, więc powtórka
+    if (atomic_load(&s_tripped) & bit) {
+        mcpwm_force(b, MOTOR_HW_IN1, MCPWM_IDLE_LEVEL);
+        mcpwm_force(b, MOTOR_HW_IN2, MCPWM_IDLE_LEVEL);
+        b->state = MCPWM_BRIDGE_IDLE;
+    }
+}
+
+// Wypełnienie zanikania w chwili now
+static uint32_t mcpwm_fade_duty(const mcpwm_fade_t *f, int64_t now)
+{
+    int64_t elapsed = now - f->t0_us;
+    int64_t span = (int64_t)f->fade_ms * 1000;
+    if (elapsed >= span) {
+        return f->to;
+    }
+    return (uint32_t)((int64_t)f->from + ((int64_t)f->to - (int64_t)f->from) * elapsed / span);
+}
+
+// Krok ramp (zadanie esp_timer) - liniowo jak sprzętowe zanikanie LEDC
+static void mcpwm_fade_step(void *arg)
+{
+    uint32_t done = 0;
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(s_bridge_lock, portMAX_DELAY);
+    for (int m = 0; m < CONFIG_MOTOR_COUNT; m++) {
+        mcpwm_bridge_t *b = &s_bridge[m];
+        bool changed = false;
+        for (int ch = 0; ch < MOTOR_HW_CH_MAX; ch++) {
+            mcpwm_fade_t *f = &b->fade[ch];
+            if (f->fade_ms == 0) {
+                continue;
+            }
+            b->duty[ch] = mcpwm_fade_duty(f, now);
+            if (now - f->t0_us >= (int64_t)f->fade_ms * 1000) {
+                f->fade_ms = 0;
+                done |= BIT(m * MOTOR_HW_CH_MAX + ch);
+            }
+            changed = true;
+        }
+        if (changed) {
+            mcpwm_apply(b);
+        }
+    }
+    s_fading &= ~done;
+    bool idle = (s_fading == 0);
+    xSemaphoreGive(s_bridge_lock);
+
+    if (idle) {
+        // Rampa rozpoczęta w międzyczasie wznawia timer
+        esp_timer_stop(s_fade_timer);
+        xSemaphoreTake(s_bridge_lock, portMAX_DELAY);
+        idle = (s_fading == 0);
+        xSemaphoreGive(s_bridge_lock);
+        if (!idle) {
+            esp_timer_start_periodic(s_fade_timer, MCPWM_FADE_STEP_US);
+        }
+    }
+    for (int id = 0; done != 0; id++, done >>= 1) {
+        if ((done & 1) && s_fade_cb) {
+            s_fade_cb((uint8_t)(id / MOTOR_HW_CH_MAX), (motor_hw_ch_t)(id % MOTOR_HW_CH_MAX), s_fade_arg);
+        }
+    }
+}
+
+static esp_err_t mcpwm_bridge_init(int m, mcpwm_timer_handle_t timer)
+{
+    mcpwm_bridge_t *b = &s_bridge[m];
+
+    const mcpwm_operator_config_t oper_conf = {
+        .group_id = m / MCPWM_MOTORS_PER_GROUP
+    };
+    mcpwm_oper_handle_t oper;
+    ESP_ERROR_CHECK(mcpwm_new_operator(&oper_conf, &oper));
+    ESP_ERROR_CHECK(mcpwm_operator_connect_timer(oper, timer));
+
+    const mcpwm_comparator_config_t cmpr_conf = {
+        .flags.update_cmp_on_tez = true
+    };
+    ESP_ERROR_CHECK(mcpwm_new_comparator(oper, &cmpr_conf, &b->cmpr));
+    ESP_ERROR_CHECK(mcpwm_comparator_set_compare_value(b->cmpr, 0));
+
+    for (int ch = 0; ch < MOTOR_HW_CH_MAX; ch++) {
+        const mcpwm_generator_config_t gen_conf = {
+            .gen_gpio_num = s_gpio[m][ch]
+        };
+        ESP_ERROR_CHECK(mcpwm_new_generator(oper, &gen_conf, &b->gen[ch]));
+        ESP_ERROR_CHECK(mcpwm_gen_actions(b, (motor_hw_ch_t)ch));
+        // Mostek w spoczynku przed startem timera
+        mcpwm_force(b, (motor_hw_ch_t)ch, MCPWM_IDLE_LEVEL);
+    }
+    ESP_ERROR_CHECK(mcpwm_dead_time(b));
+    b->state = MCPWM_BRIDGE_IDLE;
+
+    ESP_LOGI(TAG, "Silnik %d: IN1 GPIO%d, IN2 GPIO%d", m, s_gpio[m][MOTOR_HW_IN1], s_gpio[m][MOTOR_HW_IN2]);
+    return ESP_OK;
+}
+
+esp_err_t motor_hw_init(void)
+{
+    s_bridge_lock = xSemaphoreCreateMutex();
+    if (s_bridge_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_groups = (CONFIG_MOTOR_COUNT + MCPWM_MOTORS_PER_GROUP - 1) / MCPWM_MOTORS_PER_GROUP;
+    s_freq_hz = CONFIG_MOTOR_PWM_FREQ_HZ;
+    s_period_ticks = MCPWM_RESOLUTION_HZ / s_freq_hz;
+
+    for (int g = 0; g < s_groups; g++) {
+        const mcpwm_timer_config_t timer_conf = {
+            .group_id = g,
+            .clk_src = MCPWM_TIMER_CLK_SRC_DEFAULT,
+            .resolution_hz = MCPWM_RESOLUTION_HZ,
+            .count_mode = MCPWM_TIMER_COUNT_MODE_UP,
+            .period_ticks = s_period_ticks,
+            // Zmiana okresu w czasie pracy bez przerwanego impulsu
+            .flags.update_period_on_empty = true
+        };
+        ESP_ERROR_CHECK(mcpwm_new_timer(&timer_conf, &s_timers[g]));
+    }
+    for (int m = 0; m < CONFIG_MOTOR_COUNT; m++) {
+        ESP_ERROR_CHECK(mcpwm_bridge_init(m, s_timers[m / MCPWM_MOTORS_PER_GROUP]));
+    }
+    for (int g = 0; g < s_groups; g++) {
+        ESP_ERROR_CHECK(mcpwm_timer_enable(s_timers[g]));
+        ESP_ERROR_CHECK(mcpwm_timer_start_stop(s_timers[g], MCPWM_TIMER_START_NO_STOP));
+    }
+
+    const esp_timer_create_args_t fade_args = {
+        .callback = mcpwm_fade_step,
+        .name = "mcpwm_fade"
+    };
+    esp_err_t err = esp_timer_create(&fade_args, &s_fade_timer);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    ESP_LOGI(TAG, "MCPWM: %d silników, %" PRIu32 " Hz, czas martwy %d ns, %s",
+             CONFIG_MOTOR_COUNT, s_freq_hz, CONFIG_MOTOR_MCPWM_DEAD_TIME_NS,
+             MCPWM_IDLE_LEVEL ? "hamowanie" : "wybieg");
+    return ESP_OK;
+}
+
+esp_err_t motor_hw_set_fade_cb(motor_hw_fade_cb_t cb, void *arg)
+{
+    s_fade_cb = cb;
+    s_fade_arg = arg;
+    return ESP_OK;
+}
+
+// Skokowa zmiana przerywa zanikanie w toku (jak ledc_update_duty),
+// bez powiadomienia o jego końcu. Wołane pod s_bridge_lock.
+static void mcpwm_set_locked(uint8_t motor, uint32_t in1, uint32_t in2)
+{
+    mcpwm_bridge_t *b = &s_bridge[motor];
+    if (atomic_load(&s_tripped) & BIT(motor)) {
+        in1 = in2 = 0;
+    }
+    b->duty[MOTOR_HW_IN1] = in1;
+    b->duty[MOTOR_HW_IN2] = in2;
+    for (int ch = 0; ch < MOTOR_HW_CH_MAX; ch++) {
+        b->fade[ch].fade_ms = 0;
+        s_fading &= ~BIT(motor * MOTOR_HW_CH_MAX + ch);
+    }
+    mcpwm_apply(b);
+}
+
+void motor_hw_set(uint8_t motor, uint32_t in1, uint32_t in2)
+{
+    xSemaphoreTake(s_bridge_lock, portMAX_DELAY);
+    mcpwm_set_locked(motor, in1, in2);
+    xSemaphoreGive(s_bridge_lock);
+}
+
+void motor_hw_set_group(const motor_hw_bridge_t *bridges, size_t count)
+{
+    // Komparatory przejmują nowe wartości na początku okresu wspólnego
+    // timera grupy, więc mostki jednej grupy przełączają się razem, jeśli
+    // wszystkie zapisy zmieszczą się w jednym okresie. Wstrzymany planista
+    // nie dopuści innego zadania między nie; wywołania sterownika nie
+    // blokują, więc wolno je wykonać przy wstrzymanym planiście.
+    xSemaphoreTake(s_bridge_lock, portMAX_DELAY);
+    vTaskSuspendAll();
+    for (size_t i = 0; i < count; i++) {
+        mcpwm_set_locked(bridges[i].motor, bridges[i].in1, bridges[i].in2);
+    }
+    xTaskResumeAll();
+    xSemaphoreGive(s_bridge_lock);
+}
+
+esp_err_t motor_hw_fade(uint8_t motor, motor_hw_ch_t ch, uint32_t target, uint32_t fade_ms)
+{
+    if (fade_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    mcpwm_bridge_t *b = &s_bridge[motor];
+
+    xSemaphoreTake(s_bridge_lock, portMAX_DELAY);
+    if (atomic_load(&s_tripped) & BIT(motor)) {
+        xSemaphoreGive(s_bridge_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    b->fade[ch] = (mcpwm_fade_t){
+        .from = b->duty[ch],
+        .to = target,
+        .t0_us = esp_timer_get_time(),
+        .fade_ms = fade_ms
+    };
+    s_fading |= BIT(motor * MOTOR_HW_CH_MAX + ch);
+    xSemaphoreGive(s_bridge_lock);
+
+    // Timer już działa, gdy trwa inna rampa
+    esp_err_t err = esp_timer_start_periodic(s_fade_timer, MCPWM_FADE_STEP_US);
+    return (err == ESP_ERR_INVALID_STATE) ? ESP_OK : err;
+}
+
+void motor_hw_fade_stop(uint8_t motor)
+{
+    mcpwm_bridge_t *b = &s_bridge[motor];
+    int64_t now = esp_timer_get_time();
+
+    // Timer zatrzyma się sam w kroku, który nie znajdzie innych ramp
+    xSemaphoreTake(s_bridge_lock, portMAX_DELAY);
+    for (int ch = 0; ch < MOTOR_HW_CH_MAX; ch++) {
+        mcpwm_fade_t *f = &b->fade[ch];
+        if (f->fade_ms != 0) {
+            b->duty[ch] = mcpwm_fade_duty(f, now);
+            f->fade_ms = 0;
+        }
+        s_fading &= ~BIT(motor * MOTOR_HW_CH_MAX + ch);
+    }
+    mcpwm_apply(b);
+    xSemaphoreGive(s_bridge_lock);
+}
+
+void IRAM_ATTR motor_hw_trip(uint8_t motor)
+{
+    // Bez s_bridge_lock: tylko wymuszenie spoczynku obu wyjść. Rampa
+    // programowa biegnie dalej, ale mcpwm_apply trzyma mostek w spoczynku.
+    atomic_fetch_or(&s_tripped, BIT(motor));
+    mcpwm_force(&s_bridge[motor], MOTOR_HW_IN1, MCPWM_IDLE_LEVEL);
+    mcpwm_force(&s_bridge[motor], MOTOR_HW_IN2, MCPWM_IDLE_LEVEL);
+}
+
+bool motor_hw_release(uint8_t motor)
+{
+    return (atomic_fetch_and(&s_tripped, ~BIT(motor)) & BIT(motor)) != 0;
+}
+
+uint32_t motor_hw_get_duty(uint8_t motor, motor_hw_ch_t ch)
+{
+    if (atomic_load(&s_tripped) & BIT(motor)) {
+        return 0;
+    }
+    xSemaphoreTake(s_bridge_lock, portMAX_DELAY);
+    uint32_t duty = s_bridge[motor].duty[ch];
+    xSemaphoreGive(s_bridge_lock);
+    return duty;
+}
+
+esp_err_t motor_hw_set_freq(uint32_t freq_hz)
+{
+    if (freq_hz < MOTOR_HW_FREQ_MIN_HZ || freq_hz > MOTOR_HW_FREQ_MAX_HZ) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const uint32_t period = MCPWM_RESOLUTION_HZ / freq_hz;
+
+    for (int g = 0; g < s_groups; g++) {
+        esp_err_t err = mcpwm_timer_set_period(s_timers[g], period);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    // Komparatory w nowej skali - obowiązują od tego samego początku okresu
+    xSemaphoreTake(s_bridge_lock, portMAX_DELAY);
+    s_freq_hz = freq_hz;
+    s_period_ticks = period;
+    for (int m = 0; m < CONFIG_MOTOR_COUNT; m++) {
+        mcpwm_apply(&s_bridge[m]);
+    }
+    xSemaphoreGive(s_bridge_lock);
+
+    ESP_LOGI(TAG, "PWM %" PRIu32 " Hz, %" PRIu32 " kroków na okres", freq_hz, period);
+    return ESP_OK;
+}
+
+void motor_hw_get_pwm(uint32_t *freq_hz, uint8_t *bits)
+{
+    xSemaphoreTake(s_bridge_lock, portMAX_DELAY);
+    *freq_hz = s_freq_hz;
+    uint32_t period = s_period_ticks;
+    xSemaphoreGive(s_bridge_lock);
+
+    uint8_t b = 0;
+    while (period >> (b + 1)) {
+        b++;
+    }
+    *bits = b;
+}
@@ -0,0 +1,289 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "motor_hw.h"
+
+static const char *TAG = "motor_hw";
+
+// Pojemność zapisu zmian - starsze wpisy są nadpisywane
+#define SIM_TRACE_LEN 256
+// Wpisy wysyłane w jednej odpowiedzi /sim/trace
+#define SIM_TRACE_CHUNK 32
+
+typedef struct {
+    uint32_t from;
+    uint32_t to;
+    int64_t t0_us;
+    uint32_t fade_ms;       // 0 - brak zanikania w toku
+    esp_timer_handle_t timer;
+} sim_channel_t;
+
+static portMUX_TYPE s_sim_lock = portMUX_INITIALIZER_UNLOCKED;
+static sim_channel_t s_ch[CONFIG_MOTOR_COUNT][MOTOR_HW_CH_MAX];
+static motor_hw_fade_cb_t s_fade_cb;
+static void *s_fade_arg;
+static uint32_t s_tripped;     // bit silnika zablokowanego przez motor_hw_trip, pod s_sim_lock
+
+// Częstotliwość tylko do raportu - rozdzielczość liczona jak dla LEDC z APB
+#define SIM_SRC_CLK_HZ 80000000
+static uint32_t s_freq_hz = CONFIG_MOTOR_PWM_FREQ_HZ;
+
+static motor_hw_sim_event_t s_trace[SIM_TRACE_LEN];
+static uint32_t s_trace_seq;   // liczba wszystkich zapisów
+
+static void sim_record(uint8_t motor, motor_hw_ch_t ch, uint32_t duty, uint32_t fade_ms, int64_t now)
+{
+    motor_hw_sim_event_t *e = &s_trace[s_trace_seq % SIM_TRACE_LEN];
+    e->t_us = now;
+    e->seq = s_trace_seq++;
+    e->duty = (uint16_t)duty;
+    e->fade_ms = (uint16_t)fade_ms;
+    e->motor = motor;
+    e->ch = (uint8_t)ch;
+}
+
+// Koniec zanikania (zadanie esp_timer) - odpowiednik przerwania LEDC.
+// Argument timera: numer silnika i kanału w jednym słowie.
+static void sim_fade_end_cb(void *arg)
+{
+    uintptr_t id = (uintptr_t)arg;
+    uint8_t motor = (uint8_t)(id / MOTOR_HW_CH_MAX);
+    motor_hw_ch_t ch = (motor_hw_ch_t)(id % MOTOR_HW_CH_MAX);
+
+    portENTER_CRITICAL(&s_sim_lock);
+    s_ch[motor][ch].from = s_ch[motor][ch].to;
+    s_ch[motor][ch].fade_ms = 0;
+    portEXIT_CRITICAL(&s_sim_lock);
+
+    if (s_fade_cb) {
+        s_fade_cb(motor, ch, s_fade_arg);
+    }
+}
+
+esp_err_t motor_hw_init(void)
+{
+    for (int m = 0; m < CONFIG_MOTOR_COUNT; m++) {
+        for (int ch = 0; ch < MOTOR_HW_CH_MAX; ch++) {
+            const esp_timer_create_args_t args = {
+                .callback = sim_fade_end_cb,
+                .arg = (void *)(uintptr_t)(m * MOTOR_HW_CH_MAX + ch),
+                .name = "sim_fade"
+            };
+            esp_err_t err = esp_timer_create(&args, &s_ch[m][ch].timer);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+    }
+    ESP_LOGI(TAG, "Symulacja %d mostków H (zapis %d zmian)", CONFIG_MOTOR_COUNT, SIM_TRACE_LEN);
+    return ESP_OK;
+}
+
+esp_err_t motor_hw_set_fade_cb(motor_hw_fade_cb_t cb, void *arg)
+{
+    s_fade_cb = cb;
+    s_fade_arg = arg;
+    return ESP_OK;
+}
+
+// Wypełnienie kanału w chwili now, wołane pod s_sim_lock.
+// Liniowa interpolacja jak w sprzętowym zanikaniu LEDC.
+static uint32_t sim_duty_locked(const sim_channel_t *c, int64_t now)
+{
+    if (c->fade_ms == 0) {
+        return c->to;
+    }
+    int64_t elapsed = now - c->t0_us;
+    int64_t span = (int64_t)c->fade_ms * 1000;
+    if (elapsed >= span) {
+        return c->to;
+    }
+    return (uint32_t)((int64_t)c->from + ((int64_t)c->to - (int64_t)c->from) * elapsed / span);
+}
+
+// Skokowy zapis obu kanałów mostka, wołane pod s_sim_lock
+static void sim_set_locked(uint8_t motor, uint32_t in1, uint32_t in2, int64_t now)
+{
+    const bool tripped = (s_tripped & BIT(motor)) != 0;
+    const uint32_t duty[MOTOR_HW_CH_MAX] = { tripped ? 0 : in1, tripped ? 0 : in2 };
+
+    for (int ch = 0; ch < MOTOR_HW_CH_MAX; ch++) {
+        sim_channel_t *c = &s_ch[motor][ch];
+        c->from = c->to = duty[ch];
+        c->fade_ms = 0;
+        sim_record(motor, ch, duty[ch], 0, now);
+    }
+}
+
+void motor_hw_set(uint8_t motor, uint32_t in1, uint32_t in2)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&s_sim_lock);
+    sim_set_locked(motor, in1, in2, now);
+    portEXIT_CRITICAL(&s_sim_lock);
+}
+
+void motor_hw_set_group(const motor_hw_bridge_t *bridges, size_t count)
+{
+    // Każdy kanał z własnym znacznikiem czasu - zapis pokazuje rzeczywisty
+    // rozrzut zatwierdzeń w grupie
+    portENTER_CRITICAL(&s_sim_lock);
+    for (size_t i = 0; i < count; i++) {
+        sim_set_locked(bridges[i].motor, bridges[i].in1, bridges[i].in2, esp_timer_get_time());
+    }
+    portEXIT_CRITICAL(&s_sim_lock);
+}
+
+esp_err_t motor_hw_fade(uint8_t motor, motor_hw_ch_t ch, uint32_t target, uint32_t fade_ms)
+{
+    sim_channel_t *c = &s_ch[motor][ch];
+    int64_t now = esp_timer_get_time();
+
+    esp_timer_stop(c->timer);
+    portENTER_CRITICAL(&s_sim_lock);
+    if (s_tripped & BIT(motor)) {
+        portEXIT_CRITICAL(&s_sim_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    c->from = c->to;
+    c->to = target;
+    c->t0_us = now;
+    c->fade_ms = fade_ms;
+    sim_record(motor, ch, target, fade_ms, now);
+    portEXIT_CRITICAL(&s_sim_lock);
+
+    return esp_timer_start_once(c->timer, (uint64_t)fade_ms * 1000);
+}
+
+void motor_hw_fade_stop(uint8_t motor)
+{
+    int64_t now = esp_timer_get_time();
+
+    for (int ch = 0; ch < MOTOR_HW_CH_MAX; ch++) {
+        sim_channel_t *c = &s_ch[motor][ch];
+        esp_timer_stop(c->timer);
+        portENTER_CRITICAL(&s_sim_lock);
+        if (c->fade_ms != 0) {
+            c->from = c->to = sim_duty_locked(c, now);
+            c->fade_ms = 0;
+            sim_record(motor, ch, c->to, 0, now);
+        }
+        portEXIT_CRITICAL(&s_sim_lock);
+    }
+}
+
+// Wołane także z przerwania - tylko spinlock, timery zanikania biegną
+// dalej, ale ich koniec nie zmienia zerowego wypełnienia
+void motor_hw_trip(uint8_t motor)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL_SAFE(&s_sim_lock);
+    s_tripped |= BIT(motor);
+    sim_set_locked(motor, 0, 0, now);
+    portEXIT_CRITICAL_SAFE(&s_sim_lock);
+}
+
+bool motor_hw_release(uint8_t motor)
+{
+    portENTER_CRITICAL(&s_sim_lock);
+    bool tripped = (s_tripped & BIT(motor)) != 0;
+    s_tripped &= ~BIT(motor);
+    portEXIT_CRITICAL(&s_sim_lock);
+    return tripped;
+}
+
+uint32_t motor_hw_get_duty(uint8_t motor, motor_hw_ch_t ch)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&s_sim_lock);
+    uint32_t duty = sim_duty_locked(&s_ch[motor][ch], now);
+    portEXIT_CRITICAL(&s_sim_lock);
+    return duty;
+}
+
+esp_err_t motor_hw_set_freq(uint32_t freq_hz)
+{
+    if (freq_hz < MOTOR_HW_FREQ_MIN_HZ || freq_hz > MOTOR_HW_FREQ_MAX_HZ) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&s_sim_lock);
+    s_freq_hz = freq_hz;
+    portEXIT_CRITICAL(&s_sim_lock);
+    return ESP_OK;
+}
+
+void motor_hw_get_pwm(uint32_t *freq_hz, uint8_t *bits)
+{
+    portENTER_CRITICAL(&s_sim_lock);
+    *freq_hz = s_freq_hz;
+    portEXIT_CRITICAL(&s_sim_lock);
+
+    uint8_t b = 0;
+    while ((SIM_SRC_CLK_HZ / *freq_hz) >> (b + 1)) {
+        b++;
+    }
+    *bits = b;
+}
+
+size_t motor_hw_sim_trace(uint32_t *since, motor_hw_sim_event_t *events, size_t max)
+{
+    size_t n = 0;
+
+    portENTER_CRITICAL(&s_sim_lock);
+    uint32_t oldest = s_trace_seq > SIM_TRACE_LEN ? s_trace_seq - SIM_TRACE_LEN : 0;
+    if (*since < oldest) {
+        *since = oldest;
+    }
+    for (uint32_t seq = *since; seq < s_trace_seq && n < max; seq++) {
+        events[n++] = s_trace[seq % SIM_TRACE_LEN];
+    }
+    portEXIT_CRITICAL(&s_sim_lock);
+    return n;
+}
+
+// GET /sim/trace?since=N - zapisy o numerach >= N (najwyżej SIM_TRACE_CHUNK).
+// Pole "next" to numer, od którego należy pytać następnym razem.
+static esp_err_t sim_trace_get_handler(httpd_req_t *req)
+{
+    uint32_t since = 0;
+    char query[32];
+    char value[12];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "since", value, sizeof(value)) == ESP_OK) {
+        since = strtoul(value, NULL, 10);
+    }
+
+    motor_hw_sim_event_t events[SIM_TRACE_CHUNK];
+    const uint32_t asked = since;
+    size_t n = motor_hw_sim_trace(&since, events, SIM_TRACE_CHUNK);
+    uint32_t dropped = since - asked;
+
+    char line[96];
+    httpd_resp_set_type(req, "application/json");
+    int len = snprintf(line, sizeof(line), "{\"next\":%" PRIu32 ",\"dropped\":%" PRIu32 ",\"events\":[",
+                       since + (uint32_t)n, dropped);
+    httpd_resp_send_chunk(req, line, len);
+    for (size_t i = 0; i < n; i++) {
+        len = snprintf(line, sizeof(line), "%s{\"t\":%" PRId64 ",\"motor\":%u,\"ch\":%u,\"duty\":%u,\"fade_ms\":%u}",
+                       i ? "," : "", events[i].t_us, events[i].motor, events[i].ch, events[i].duty, events[i].fade_ms);
+        httpd_resp_send_chunk(req, line, len);
+    }
+    httpd_resp_send_chunk(req, "]}", 2);
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+esp_err_t motor_hw_sim_register(httpd_handle_t server)
+{
+    const httpd_uri_t trace_uri = {
+        .uri       = "/sim/trace",
+        .method    = HTTP_GET,
+        .handler   = sim_trace_get_handler
+    };
+    return httpd_register_uri_handler(server, &trace_uri);
+}
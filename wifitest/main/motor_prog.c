@@ -0,0 +1,260 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "motor_prog.h"
+
+// Zadanie programu lub procedury. Kroki zmienia tylko motor_prog_submit*,
+// gdy slot jest wolny lub zakończony - zadanie silnika czyta je bez blokady.
+typedef struct {
+    uint32_t id;            // 0 - slot nigdy nie użyty
+    uint8_t motor;
+    bool routine;           // kod procedury zamiast kroków programu
+    volatile motor_job_state_t state;
+    volatile bool cancel;   // anulowanie w toku - koniec to CANCELLED
+    uint16_t step;
+    uint16_t steps;
+    union {
+        motor_prog_t prog;
+        motor_routine_t code;
+    };
+} motor_job_t;
+
+static motor_job_t s_jobs[MOTOR_PROG_JOBS];
+static uint32_t s_next_id = 1;
+static portMUX_TYPE s_jobs_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static bool motor_job_finished(motor_job_state_t state)
+{
+    return state == MOTOR_JOB_DONE || state == MOTOR_JOB_CANCELLED || state == MOTOR_JOB_ABORTED;
+}
+
+// Slot zadania o danym numerze albo NULL (woła się w sekcji krytycznej)
+static motor_job_t *IRAM_ATTR motor_job_find(uint32_t job_id)
+{
+    for (size_t i = 0; i < MOTOR_PROG_JOBS; i++) {
+        if (job_id != 0 && s_jobs[i].id == job_id) {
+            return &s_jobs[i];
+        }
+    }
+    return NULL;
+}
+
+// Rezerwacja slotu na nowe zadanie; NULL, gdy wszystkie trwają
+static motor_job_t *motor_job_reserve(uint8_t motor, bool routine, size_t steps)
+{
+    // Wolny slot albo zakończone zadanie o najniższym (najstarszym) numerze
+    portENTER_CRITICAL(&s_jobs_lock);
+    motor_job_t *job = NULL;
+    for (size_t i = 0; i < MOTOR_PROG_JOBS; i++) {
+        motor_job_t *j = &s_jobs[i];
+        if (j->state == MOTOR_JOB_FREE) {
+            job = j;
+            break;
+        }
+        if (motor_job_finished(j->state) && (job == NULL || j->id < job->id)) {
+            job = j;
+        }
+    }
+    if (job) {
+        // Zarezerwowany slot nie jest ani wolny, ani zakończony
+        job->id = s_next_id++;
+        if (s_next_id == 0) {
+            s_next_id = 1;
+        }
+        job->motor = motor;
+        job->routine = routine;
+        job->state = MOTOR_JOB_QUEUED;
+        job->cancel = false;
+        job->step = 0;
+        job->steps = (uint16_t)steps;
+    }
+    portEXIT_CRITICAL(&s_jobs_lock);
+    return job;
+}
+
+// Komenda zadania do kolejki silnika; bez miejsca slot wraca do puli
+static esp_err_t motor_job_post(motor_job_t *job, motor_cmd_type_t type, uint32_t *job_id)
+{
+    const motor_cmd_t cmd = { .type = type, .job = job->id };
+    esp_err_t err = motor_post(job->motor, &cmd);
+    if (err != ESP_OK) {
+        portENTER_CRITICAL(&s_jobs_lock);
+        job->state = MOTOR_JOB_FREE;
+        job->id = 0;
+        portEXIT_CRITICAL(&s_jobs_lock);
+        return err;
+    }
+    *job_id = cmd.job;
+    return ESP_OK;
+}
+
+esp_err_t motor_prog_submit(uint8_t motor, const motor_prog_t *prog, uint32_t *job_id)
+{
+    if (motor >= MOTOR_COUNT || prog->count == 0 || prog->count > MOTOR_PROG_MAX_STEPS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    motor_job_t *job = motor_job_reserve(motor, false, prog->count);
+    if (job == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    job->prog.count = prog->count;
+    memcpy(job->prog.steps, prog->steps, prog->count * sizeof(motor_prog_step_t));
+    return motor_job_post(job, MOTOR_CMD_PROGRAM, job_id);
+}
+
+esp_err_t motor_prog_submit_routine(uint8_t motor, const motor_routine_t *routine, uint32_t *job_id)
+{
+    if (motor >= MOTOR_COUNT || routine->count == 0 || routine->count > MOTOR_ROUTINE_MAX_INSNS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    motor_job_t *job = motor_job_reserve(motor, true, routine->count);
+    if (job == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    job->code.count = routine->count;
+    memcpy(job->code.code, routine->code, routine->count * sizeof(motor_insn_t));
+    return motor_job_post(job, MOTOR_CMD_ROUTINE, job_id);
+}
+
+esp_err_t motor_prog_get_info(uint32_t job_id, motor_job_info_t *info)
+{
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+
+    portENTER_CRITICAL(&s_jobs_lock);
+    const motor_job_t *job = motor_job_find(job_id);
+    if (job) {
+        *info = (motor_job_info_t){
+            .id = job->id,
+            .motor = job->motor,
+            .state = job->state,
+            .step = job->step,
+            .steps = job->steps
+        };
+        err = ESP_OK;
+    }
+    portEXIT_CRITICAL(&s_jobs_lock);
+    return err;
+}
+
+esp_err_t motor_prog_cancel(uint32_t job_id)
+{
+    esp_err_t err = ESP_OK;
+    bool preempt = false;
+    uint8_t motor = 0;
+
+    portENTER_CRITICAL(&s_jobs_lock);
+    motor_job_t *job = motor_job_find(job_id);
+    if (job == NULL) {
+        err = ESP_ERR_NOT_FOUND;
+    } else if (job->state == MOTOR_JOB_QUEUED) {
+        // Komenda zostaje w kolejce, ale motor_prog_begin jej nie uruchomi
+        job->state = MOTOR_JOB_CANCELLED;
+    } else if (job->state == MOTOR_JOB_RUNNING) {
+        job->cancel = true;
+        preempt = true;
+        motor = job->motor;
+    } else {
+        err = ESP_ERR_INVALID_STATE;
+    }
+    portEXIT_CRITICAL(&s_jobs_lock);
+
+    // Tylko to zadanie - STOP wyczyściłby kolejkę z zadaniami czekającymi
+    // za nim. Gdy zadanie skończyło się przed tym wywołaniem, silnik nie
+    // dostaje niczego, a stan zostaje DONE.
+    if (preempt) {
+        motor_preempt_job(motor, job_id);
+    }
+    return err;
+}
+
+// Przejście QUEUED -> RUNNING; NULL, gdy zadanie anulowano w kolejce
+static motor_job_t *motor_job_start(uint32_t job_id, bool routine)
+{
+    portENTER_CRITICAL(&s_jobs_lock);
+    motor_job_t *job = motor_job_find(job_id);
+    if (job != NULL && job->state == MOTOR_JOB_QUEUED && job->routine == routine) {
+        job->state = MOTOR_JOB_RUNNING;
+    } else {
+        job = NULL;
+    }
+    portEXIT_CRITICAL(&s_jobs_lock);
+    return job;
+}
+
+bool motor_prog_begin(uint32_t job_id, const motor_prog_step_t **steps, size_t *count)
+{
+    motor_job_t *job = motor_job_start(job_id, false);
+    if (job) {
+        *steps = job->prog.steps;
+        *count = job->prog.count;
+    }
+    return job != NULL;
+}
+
+bool motor_prog_begin_routine(uint32_t job_id, const motor_routine_t **routine)
+{
+    motor_job_t *job = motor_job_start(job_id, true);
+    if (job) {
+        *routine = &job->code;
+    }
+    return job != NULL;
+}
+
+bool motor_prog_step(uint32_t job_id, size_t step)
+{
+    portENTER_CRITICAL(&s_jobs_lock);
+    motor_job_t *job = motor_job_find(job_id);
+    bool ok = (job != NULL && !job->cancel);
+    if (ok) {
+        job->step = (uint16_t)step;
+    }
+    portEXIT_CRITICAL(&s_jobs_lock);
+    return ok;
+}
+
+bool motor_prog_cancelled(uint32_t job_id)
+{
+    portENTER_CRITICAL(&s_jobs_lock);
+    const motor_job_t *job = motor_job_find(job_id);
+    bool cancelled = (job != NULL && job->cancel);
+    portEXIT_CRITICAL(&s_jobs_lock);
+    return cancelled;
+}
+
+void motor_prog_end(uint32_t job_id, bool completed)
+{
+    portENTER_CRITICAL(&s_jobs_lock);
+    motor_job_t *job = motor_job_find(job_id);
+    if (job) {
+        job->state = completed ? MOTOR_JOB_DONE : job->cancel ? MOTOR_JOB_CANCELLED : MOTOR_JOB_ABORTED;
+    }
+    portEXIT_CRITICAL(&s_jobs_lock);
+}
+
+void IRAM_ATTR motor_prog_dropped(uint32_t job_id)
+{
+    portENTER_CRITICAL_SAFE(&s_jobs_lock);
+    motor_job_t *job = motor_job_find(job_id);
+    if (job && job->state == MOTOR_JOB_QUEUED) {
+        job->state = MOTOR_JOB_ABORTED;
+    }
+    portEXIT_CRITICAL_SAFE(&s_jobs_lock);
+}
+
+const char *motor_job_state_name(motor_job_state_t state)
+{
+    switch (state) {
+    case MOTOR_JOB_QUEUED:
+        return "queued";
+    case MOTOR_JOB_RUNNING:
+        return "running";
+    case MOTOR_JOB_DONE:
+        return "done";
+    case MOTOR_JOB_CANCELLED:
+        return "cancelled";
+    case MOTOR_JOB_ABORTED:
+        return "aborted";
+    default:
+        return "?";
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "motor.h"
+#include "motor_routine.h"
+
+// Programy ruchu: skrypt kroków przesłany jednym żądaniem
+// (POST /api/v1/program) trafia do stałej puli zadań w RAM i jest
+// wykonywany w całości przez zadanie silnika, bez udziału sieci.
+// Zadanie ma numer do odpytywania i anulowania. Tak samo wykonywane są
+// procedury z NVS (motor_routine) - wtedy krok to licznik instrukcji.
+
+#define MOTOR_PROG_MAX_STEPS 32
+// Zadania w puli - zakończone są nadpisywane od najstarszego
+#define MOTOR_PROG_JOBS 4
+
+typedef enum {
+    MOTOR_PROG_RUN,         // praca przez arg ms, potem stop (jak PULSE)
+    MOTOR_PROG_MOVE,        // ruch do pozycji arg (CONFIG_MOTOR_ENCODER, MOTOR_PRIMARY)
+} motor_prog_op_t;
+
+// Krok programu - 12 bajtów
+typedef struct {
+    uint8_t op;             // motor_prog_op_t
+    uint8_t dir;            // motor_dir_t
+    uint8_t ramp;           // motor_ramp_t
+    uint8_t reserved;
+    uint16_t duty;
+    uint16_t ramp_ms;
+    int32_t arg;            // czas w ms albo pozycja w zliczeniach
+} motor_prog_step_t;
+
+typedef struct {
+    size_t count;
+    motor_prog_step_t steps[MOTOR_PROG_MAX_STEPS];
+} motor_prog_t;
+
+typedef enum {
+    MOTOR_JOB_FREE,
+    MOTOR_JOB_QUEUED,       // komenda w kolejce silnika
+    MOTOR_JOB_RUNNING,
+    MOTOR_JOB_DONE,         // wszystkie kroki wykonane
+    MOTOR_JOB_CANCELLED,    // motor_prog_cancel
+    MOTOR_JOB_ABORTED,      // przerwany przez stop lub utyk
+} motor_job_state_t;
+
+typedef struct {
+    uint32_t id;
+    uint8_t motor;
+    motor_job_state_t state;
+    uint16_t step;          // wykonywany (lub ostatni) krok
+    uint16_t steps;
+} motor_job_info_t;
+
+// Zapis programu i wstawienie go do kolejki silnika. ESP_ERR_NO_MEM, gdy
+// wszystkie zadania w puli trwają, ESP_ERR_TIMEOUT przy pełnej kolejce.
+esp_err_t motor_prog_submit(uint8_t motor, const motor_prog_t *prog, uint32_t *job_id);
+
+// Kopia procedury jako zadanie (komenda MOTOR_CMD_ROUTINE) - błędy jak wyżej
+esp_err_t motor_prog_submit_routine(uint8_t motor, const motor_routine_t *routine, uint32_t *job_id);
+
+// ESP_ERR_NOT_FOUND dla nieznanego (lub już nadpisanego) numeru
+esp_err_t motor_prog_get_info(uint32_t job_id, motor_job_info_t *info);
+
+// Anulowanie: zadanie w kolejce nie ruszy, a trwające przerywa bieżący
+// krok i zatrzymuje mostek; następne zadania w kolejce nie są ruszane.
+// ESP_ERR_INVALID_STATE, gdy zadanie już się zakończyło.
+esp_err_t motor_prog_cancel(uint32_t job_id);
+
+const char *motor_job_state_name(motor_job_state_t state);
+
+// Dla zadania silnika: początek wykonania (false, gdy zadanie anulowano
+// w kolejce), bieżący krok i koniec
+bool motor_prog_begin(uint32_t job_id, const motor_prog_step_t **steps, size_t *count);
+bool motor_prog_begin_routine(uint32_t job_id, const motor_routine_t **routine);
+bool motor_prog_step(uint32_t job_id, size_t step);
+void motor_prog_end(uint32_t job_id, bool completed);
+// Anulowanie trwającego zadania - sprawdzane po starcie sekwencji lub
+// ruchu, który kasuje powiadomienie z motor_preempt_job
+bool motor_prog_cancelled(uint32_t job_id);
+
+// Komenda PROGRAM usunięta z kolejki przez STOP lub utyk - zadanie
+// kończy się jako ABORTED (z sekcji krytycznej kolejki, także w przerwaniu)
+void motor_prog_dropped(uint32_t job_id);
@@ -0,0 +1,57 @@
+#include <inttypes.h>
+#include "esp_log.h"
+#include "nvs.h"
+#include "motor_hw.h"
+#include "motor_pwm.h"
+
+static const char *TAG = "motor_pwm";
+
+#define MOTOR_PWM_NAMESPACE "motor"
+#define MOTOR_PWM_KEY "pwm_hz"
+
+esp_err_t motor_pwm_set_freq(uint32_t freq_hz)
+{
+    esp_err_t err = motor_hw_set_freq(freq_hz);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    nvs_handle_t nvs;
+    err = nvs_open(MOTOR_PWM_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err != ESP_OK) {
+        return err;
+    }
+    // Zapis tylko przy zmianie - oszczędza flash
+    uint32_t old;
+    if (nvs_get_u32(nvs, MOTOR_PWM_KEY, &old) != ESP_OK || old != freq_hz) {
+        err = nvs_set_u32(nvs, MOTOR_PWM_KEY, freq_hz);
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs);
+        }
+    }
+    nvs_close(nvs);
+    return err;
+}
+
+esp_err_t motor_pwm_restore(void)
+{
+    nvs_handle_t nvs;
+    uint32_t freq_hz;
+    if (nvs_open(MOTOR_PWM_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return ESP_OK;
+    }
+    esp_err_t err = nvs_get_u32(nvs, MOTOR_PWM_KEY, &freq_hz);
+    nvs_close(nvs);
+    if (err != ESP_OK || freq_hz == CONFIG_MOTOR_PWM_FREQ_HZ) {
+        return ESP_OK;
+    }
+
+    // Zły wpis nie blokuje startu - zostaje częstotliwość domyślna
+    err = motor_hw_set_freq(freq_hz);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Zapisana częstotliwość %" PRIu32 " Hz odrzucona: %s", freq_hz, esp_err_to_name(err));
+        return ESP_OK;
+    }
+    ESP_LOGI(TAG, "Częstotliwość PWM z NVS: %" PRIu32 " Hz", freq_hz);
+    return ESP_OK;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// Częstotliwość PWM mostków wybrana w czasie pracy i zapamiętana w NVS.
+// Bez wpisu obowiązuje CONFIG_MOTOR_PWM_FREQ_HZ.
+
+// Zmiana częstotliwości (motor_hw_set_freq) i zapis w NVS
+esp_err_t motor_pwm_set_freq(uint32_t freq_hz);
+
+// Przywrócenie zapisanej częstotliwości - po inicjalizacji NVS i mostków
+esp_err_t motor_pwm_restore(void);
@@ -0,0 +1,157 @@
+#include <string.h>
+#include "esp_attr.h"
+#include "motor_queue.h"
+#include "motor_prog.h"
+
+#define MOTOR_QUEUE_AT(q, i) (&(q)->cmds[((q)->head + (i)) % MOTOR_QUEUE_LEN])
+
+esp_err_t motor_queue_init(motor_queue_t *q)
+{
+    memset(q, 0, sizeof(*q));
+    portMUX_INITIALIZE(&q->lock);
+    q->ready = xSemaphoreCreateBinary();
+    return q->ready ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+bool IRAM_ATTR motor_queue_is_priority(motor_cmd_type_t type)
+{
+    return type == MOTOR_CMD_STOP || type == MOTOR_CMD_STALL;
+}
+
+// Ruch skoordynowany czeka na barierze z innymi osiami, a program
+// i procedura mają numer zadania zwrócony klientowi - nie scalają się
+static bool IRAM_ATTR motor_queue_coalesces(motor_cmd_type_t type)
+{
+    return type != MOTOR_CMD_GROUP && type != MOTOR_CMD_PROGRAM && type != MOTOR_CMD_ROUTINE &&
+           !motor_queue_is_priority(type);
+}
+
+// Indeks oczekującej komendy tego samego rodzaju albo -1
+static int IRAM_ATTR motor_queue_find(const motor_queue_t *q, motor_cmd_type_t type)
+{
+    for (size_t i = 0; i < q->count; i++) {
+        if (MOTOR_QUEUE_AT(q, i)->type == type) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+bool motor_queue_can_accept(motor_queue_t *q, const motor_cmd_t *cmd)
+{
+    portENTER_CRITICAL(&q->lock);
+    bool ok = motor_queue_is_priority(cmd->type) || q->count < MOTOR_QUEUE_LEN ||
+              (motor_queue_coalesces(cmd->type) && motor_queue_find(q, cmd->type) >= 0);
+    portEXIT_CRITICAL(&q->lock);
+    return ok;
+}
+
+esp_err_t IRAM_ATTR motor_queue_push(motor_queue_t *q, const motor_cmd_t *cmd, BaseType_t *need_yield)
+{
+    esp_err_t err = ESP_OK;
+    bool group_dropped = false;
+
+    portENTER_CRITICAL_SAFE(&q->lock);
+    if (motor_queue_is_priority(cmd->type)) {
+        for (size_t i = 0; i < q->count; i++) {
+            const motor_cmd_t *old = MOTOR_QUEUE_AT(q, i);
+            if (old->type == MOTOR_CMD_PROGRAM || old->type == MOTOR_CMD_ROUTINE) {
+                motor_prog_dropped(old->job);
+            } else if (old->type == MOTOR_CMD_GROUP) {
+                group_dropped = true;
+            }
+        }
+        q->stats.flushed += q->count;
+        q->head = 0;
+        q->count = 1;
+        q->cmds[0] = *cmd;
+    } else {
+        int found = motor_queue_coalesces(cmd->type) ? motor_queue_find(q, cmd->type) : -1;
+        if (found >= 0) {
+            // Starsza komenda wypada, kolejne przesuwają się o jedno miejsce
+            for (size_t i = (size_t)found; i + 1 < q->count; i++) {
+                *MOTOR_QUEUE_AT(q, i) = *MOTOR_QUEUE_AT(q, i + 1);
+            }
+            q->count--;
+            q->stats.coalesced++;
+        }
+        if (q->count < MOTOR_QUEUE_LEN) {
+            *MOTOR_QUEUE_AT(q, q->count) = *cmd;
+            q->count++;
+        } else {
+            q->stats.dropped++;
+            err = ESP_ERR_TIMEOUT;
+        }
+    }
+    if (err == ESP_OK) {
+        q->stats.posted++;
+    }
+    portEXIT_CRITICAL_SAFE(&q->lock);
+
+    // Poza blokadą kolejki - motor_group_dropped ustawia bity bariery
+    if (group_dropped) {
+        motor_group_dropped(q, need_yield);
+    }
+    if (err == ESP_OK) {
+        if (need_yield) {
+            xSemaphoreGiveFromISR(q->ready, need_yield);
+        } else {
+            xSemaphoreGive(q->ready);
+        }
+    }
+    return err;
+}
+
+bool motor_queue_priority_pending(motor_queue_t *q)
+{
+    portENTER_CRITICAL(&q->lock);
+    bool pending = (q->count > 0 && motor_queue_is_priority(q->cmds[q->head].type));
+    portEXIT_CRITICAL(&q->lock);
+    return pending;
+}
+
+bool motor_queue_pop(motor_queue_t *q, motor_cmd_t *cmd, TickType_t timeout)
+{
+    for (;;) {
+        portENTER_CRITICAL(&q->lock);
+        bool found = (q->count > 0);
+        if (found) {
+            *cmd = q->cmds[q->head];
+            q->head = (q->head + 1) % MOTOR_QUEUE_LEN;
+            q->count--;
+            q->busy = true;
+        }
+        portEXIT_CRITICAL(&q->lock);
+
+        // Sygnał mógł zostać po komendach już pobranych - wtedy czekamy dalej
+        if (found) {
+            return true;
+        }
+        if (xSemaphoreTake(q->ready, timeout) != pdTRUE) {
+            return false;
+        }
+    }
+}
+
+void motor_queue_done(motor_queue_t *q)
+{
+    portENTER_CRITICAL(&q->lock);
+    q->busy = false;
+    portEXIT_CRITICAL(&q->lock);
+}
+
+bool motor_queue_idle(motor_queue_t *q)
+{
+    portENTER_CRITICAL(&q->lock);
+    bool idle = (q->count == 0 && !q->busy);
+    portEXIT_CRITICAL(&q->lock);
+    return idle;
+}
+
+void motor_queue_get_stats(motor_queue_t *q, motor_queue_stats_t *stats)
+{
+    portENTER_CRITICAL(&q->lock);
+    *stats = q->stats;
+    stats->depth = (uint32_t)q->count;
+    portEXIT_CRITICAL(&q->lock);
+}
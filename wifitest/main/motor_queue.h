@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "motor.h"
+
+// Kolejka komend jednego silnika z polityką przyjmowania:
+// - STOP i STALL mają pierwszeństwo: usuwają oczekujące komendy i stają
+//   na początku kolejki (przerwanie ruchu w toku zleca motor_post)
+// - komendy ruchu scalają się: oczekująca komenda tego samego rodzaju
+//   jest usuwana, a nowsza trafia na koniec - wygrywa ostatnia
+// - pozostałe (GROUP, PROGRAM, ROUTINE) są dopisywane, przy braku miejsca
+//   odrzucane; program usunięty przez STOP lub utyk kończy się jako przerwany
+// Pięć kliknięć "aktywuj" to więc jeden oczekujący cykl, a nie pięć.
+
+#define MOTOR_QUEUE_LEN 4
+
+// Liczniki do telemetrii (od startu)
+typedef struct {
+    uint32_t depth;         // komendy oczekujące teraz
+    uint32_t posted;        // przyjęte
+    uint32_t coalesced;     // zastąpione nowszą komendą tego samego rodzaju
+    uint32_t flushed;       // usunięte przez STOP lub utyk
+    uint32_t dropped;       // odrzucone przy pełnej kolejce
+} motor_queue_stats_t;
+
+typedef struct {
+    motor_cmd_t cmds[MOTOR_QUEUE_LEN];
+    size_t head;
+    size_t count;
+    portMUX_TYPE lock;
+    SemaphoreHandle_t ready;    // podawany po każdym wstawieniu
+    bool busy;                  // pobrana komenda jeszcze się wykonuje
+    motor_queue_stats_t stats;
+} motor_queue_t;
+
+esp_err_t motor_queue_init(motor_queue_t *q);
+
+// Komenda z pierwszeństwem (przerywa ruch w toku)
+bool motor_queue_is_priority(motor_cmd_type_t type);
+
+// Czy komenda zostałaby przyjęta (wolne miejsce lub scalenie)
+bool motor_queue_can_accept(motor_queue_t *q, const motor_cmd_t *cmd);
+
+// Wstawienie według polityki; ESP_ERR_TIMEOUT przy pełnej kolejce.
+// Z przerwania need_yield != NULL, z zadania NULL.
+esp_err_t motor_queue_push(motor_queue_t *q, const motor_cmd_t *cmd, BaseType_t *need_yield);
+
+// Czy na początku kolejki czeka STOP lub utyk - program sprawdza to
+// między krokami, bo start sekwencji kasuje powiadomienie o przerwaniu
+bool motor_queue_priority_pending(motor_queue_t *q);
+
+// Pobranie najstarszej komendy (zadanie silnika). Do motor_queue_done
+// kolejka nie jest bezczynna, także gdy nic w niej nie czeka.
+bool motor_queue_pop(motor_queue_t *q, motor_cmd_t *cmd, TickType_t timeout);
+
+// Koniec wykonywania komendy pobranej przez motor_queue_pop
+void motor_queue_done(motor_queue_t *q);
+
+// Brak oczekujących komend i żadna się nie wykonuje. Praca ciągła
+// (RUN) i regulator prędkości trwają po zakończeniu swojej komendy.
+bool motor_queue_idle(motor_queue_t *q);
+
+void motor_queue_get_stats(motor_queue_t *q, motor_queue_stats_t *stats);
+
+// Komenda GROUP usunięta z kolejki q przez STOP lub utyk (motor.c) -
+// ruch skoordynowany jest przerywany, pozostałe osie nie czekają na tę
+// oś. Wołane po wyjściu z sekcji krytycznej kolejki; z przerwania
+// need_yield != NULL.
+void motor_group_dropped(motor_queue_t *q, BaseType_t *need_yield);
@@ -0,0 +1,79 @@
+#include <string.h>
+#include "motor_ramp.h"
+
+// Krzywa S: 3t^2 - 2t^3 (zerowe przyspieszenie na obu końcach), tablica
+// liczona offline, aby w czasie ruchu nie liczyć wielomianów. Indeks 0 to
+// początek rampy.
+//
+// Sprzęt odtwarza krzywą N odcinkami liniowymi, więc zryw nie jest
+// ograniczony ściśle - przyspieszenie to impulsy na granicach odcinków.
+// Dla zmiany wypełnienia D w czasie T:
+// - odchylenie wypełnienia od krzywej <= 0,75 / N^2 * D
+//   (N = 32: 0,07 % D; N = 8: 1,2 % D),
+// - skok nachylenia na granicy odcinków <= 6 / N * D / T, czyli 4 / N
+//   nachylenia szczytowego 1,5 * D / T (N = 32: 12,5 %; N = 8: 50 %).
+// Odcinki MOTOR_RAMP_SEG_MIN_MS (4 ms) są krótsze od mechanicznej stałej
+// czasowej silnika (dziesiątki ms), która te skoki wygładza. Granice
+// sprawdza test/host/test_motor_ramp.c.
+static const uint16_t s_ramp_scurve[MOTOR_RAMP_SEGMENTS + 1] = {
+    0, 29, 112, 247, 430, 656, 923, 1226,
+    1562, 1928, 2319, 2733, 3164, 3610, 4067, 4532,
+    5000, 5468, 5933, 6390, 6836, 7267, 7681, 8072,
+    8438, 8774, 9077, 9344, 9570, 9753, 9888, 9971,
+    10000
+};
+
+static const char *s_ramp_names[MOTOR_RAMP_MAX] = {
+    [MOTOR_RAMP_NONE] = "none",
+    [MOTOR_RAMP_LINEAR] = "linear",
+    [MOTOR_RAMP_TRAPEZOID] = "trapezoid",
+    [MOTOR_RAMP_SCURVE] = "scurve",
+};
+
+size_t motor_ramp_segments(motor_ramp_t profile, uint32_t ramp_ms)
+{
+    if (profile != MOTOR_RAMP_SCURVE) {
+        return 1;
+    }
+    size_t n = MOTOR_RAMP_SEGMENTS;
+    while (n > 1 && ramp_ms / n < MOTOR_RAMP_SEG_MIN_MS) {
+        n /= 2;
+    }
+    return n;
+}
+
+uint16_t motor_ramp_point(motor_ramp_t profile, size_t k, size_t segments)
+{
+    if (segments == 0 || segments > MOTOR_RAMP_SEGMENTS || k >= segments) {
+        return MOTOR_RAMP_SCALE;
+    }
+    switch (profile) {
+    case MOTOR_RAMP_LINEAR:
+    case MOTOR_RAMP_TRAPEZOID:
+        return (uint16_t)(MOTOR_RAMP_SCALE * k / segments);
+    case MOTOR_RAMP_SCURVE:
+        return s_ramp_scurve[k * (MOTOR_RAMP_SEGMENTS / segments)];
+    default:
+        return MOTOR_RAMP_SCALE;
+    }
+}
+
+bool motor_ramp_has_decel(motor_ramp_t profile)
+{
+    return profile == MOTOR_RAMP_TRAPEZOID || profile == MOTOR_RAMP_SCURVE;
+}
+
+motor_ramp_t motor_ramp_from_name(const char *name)
+{
+    for (int i = 0; i < MOTOR_RAMP_MAX; i++) {
+        if (strcmp(name, s_ramp_names[i]) == 0) {
+            return (motor_ramp_t)i;
+        }
+    }
+    return MOTOR_RAMP_MAX;
+}
+
+const char *motor_ramp_name(motor_ramp_t profile)
+{
+    return profile < MOTOR_RAMP_MAX ? s_ramp_names[profile] : "?";
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Największa liczba odcinków liniowych, na które dzielona jest krzywa S
+// (potęga dwójki). Każdy odcinek to jedno zanikanie sprzętowe LEDC.
+// Błąd przybliżenia odcinkami - w motor_ramp.c.
+#define MOTOR_RAMP_SEGMENTS 32
+
+// Najkrótszy odcinek: krótsze rampy dostają mniej odcinków
+#define MOTOR_RAMP_SEG_MIN_MS 4
+
+// Pełny postęp rampy w tablicach (0,01 %)
+#define MOTOR_RAMP_SCALE 10000
+
+// Profile rozruchu i hamowania
+typedef enum {
+    MOTOR_RAMP_NONE,        // skok wypełnienia jak dotychczas
+    MOTOR_RAMP_LINEAR,      // liniowy rozruch, zatrzymanie skokowe
+    MOTOR_RAMP_TRAPEZOID,   // liniowy rozruch i liniowe hamowanie
+    MOTOR_RAMP_SCURVE,      // rozruch i hamowanie po krzywej S
+    MOTOR_RAMP_MAX
+} motor_ramp_t;
+
+// Liczba odcinków rampy profile trwającej ramp_ms: 1 dla ramp liniowych
+// (jedno zanikanie jest dokładne), dla krzywej S tyle, by odcinek trwał
+// co najmniej MOTOR_RAMP_SEG_MIN_MS, najwyżej MOTOR_RAMP_SEGMENTS
+size_t motor_ramp_segments(motor_ramp_t profile, uint32_t ramp_ms);
+
+// Postęp rampy (0..MOTOR_RAMP_SCALE) na końcu odcinka k (1..segments)
+// z segments odcinków (wynik motor_ramp_segments)
+uint16_t motor_ramp_point(motor_ramp_t profile, size_t k, size_t segments);
+
+// Czy profil łagodnie wyhamowuje silnik na końcu fazy
+bool motor_ramp_has_decel(motor_ramp_t profile);
+
+// Profil o podanej nazwie ("none", "linear", "trapezoid", "scurve").
+// Dla nieznanej nazwy zwraca MOTOR_RAMP_MAX.
+motor_ramp_t motor_ramp_from_name(const char *name);
+
+const char *motor_ramp_name(motor_ramp_t profile);
@@ -0,0 +1,301 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include "motor.h"
+#include "motor_routine.h"
+
+static const char *TAG = "motor_routine";
+
+#define MOTOR_ROUTINE_NAMESPACE "routines"
+// Procedury trzymane w RAM po pierwszym użyciu
+#define MOTOR_ROUTINE_CACHE 4
+
+// Pamięć podręczna - używają jej handlery HTTP z puli zadań (pod s_lock),
+// a zadanie silnika dostaje kopię w zadaniu motor_prog
+typedef struct {
+    char name[MOTOR_ROUTINE_NAME_MAX];  // "" - wolny
+    uint32_t used;                      // do wyboru najdawniej użytej
+    motor_routine_t routine;
+} motor_routine_slot_t;
+
+static motor_routine_slot_t s_cache[MOTOR_ROUTINE_CACHE];
+static uint32_t s_use_tick;
+// Pamięć podręczna i bufor odczytu NVS; mutex, bo zapis NVS trwa długo
+static SemaphoreHandle_t s_lock;
+
+_Static_assert(sizeof(motor_insn_t) == 8, "instrukcja procedury ma 8 bajtów");
+
+esp_err_t motor_routine_init(void)
+{
+    s_lock = xSemaphoreCreateMutex();
+    return s_lock ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+bool motor_routine_name_valid(const char *name)
+{
+    size_t len = strlen(name);
+    if (len == 0 || len >= MOTOR_ROUTINE_NAME_MAX) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        char c = name[i];
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static esp_err_t motor_routine_fail(motor_routine_fault_t *fault, size_t pc, const char *reason)
+{
+    fault->pc = pc;
+    fault->reason = reason;
+    return ESP_ERR_INVALID_ARG;
+}
+
+// Czujnik warunku dostępny na silniku
+static bool motor_routine_cond_ok(uint8_t cond, uint8_t motor)
+{
+    switch (cond) {
+    case MOTOR_COND_POS_GE:
+    case MOTOR_COND_POS_LT:
+#if CONFIG_MOTOR_ENCODER
+        return motor == MOTOR_PRIMARY;
+#else
+        return false;
+#endif
+    case MOTOR_COND_CUR_GE:
+    case MOTOR_COND_CUR_LT:
+#if CONFIG_MOTOR_CURRENT_SENSE
+        return motor == MOTOR_PRIMARY;
+#else
+        return false;
+#endif
+    default:
+        return false;
+    }
+}
+
+esp_err_t motor_routine_validate(const motor_routine_t *routine, uint8_t motor, motor_routine_fault_t *fault)
+{
+    if (routine->count == 0 || routine->count > MOTOR_ROUTINE_MAX_INSNS) {
+        return motor_routine_fail(fault, 0, "Niepoprawna liczba instrukcji");
+    }
+    const bool encoder = motor_routine_cond_ok(MOTOR_COND_POS_GE, motor);
+
+    for (size_t pc = 0; pc < routine->count; pc++) {
+        const motor_insn_t *in = &routine->code[pc];
+        switch (in->op) {
+        case MOTOR_OP_END:
+        case MOTOR_OP_STOP:
+            break;
+        case MOTOR_OP_DRIVE:
+        case MOTOR_OP_RUN:
+            if (in->a != MOTOR_DIR_FORWARD && in->a != MOTOR_DIR_REVERSE) {
+                return motor_routine_fail(fault, pc, "Niepoprawny kierunek");
+            }
+            if (in->b > PWM_DUTY) {
+                return motor_routine_fail(fault, pc, "Niepoprawne wypełnienie");
+            }
+            if (in->op == MOTOR_OP_RUN && (in->arg <= 0 || in->arg > MOTOR_ROUTINE_TIME_MAX_MS)) {
+                return motor_routine_fail(fault, pc, "Niepoprawny czas pracy");
+            }
+            break;
+        case MOTOR_OP_MOVE:
+        case MOTOR_OP_WAIT_POS:
+            if (!encoder) {
+                return motor_routine_fail(fault, pc, "Instrukcja wymaga enkodera");
+            }
+            if (in->op == MOTOR_OP_MOVE && in->b > PWM_DUTY) {
+                return motor_routine_fail(fault, pc, "Niepoprawne wypełnienie");
+            }
+            if (in->op == MOTOR_OP_WAIT_POS && in->b == 0) {
+                return motor_routine_fail(fault, pc, "Brak limitu czasu");
+            }
+            break;
+        case MOTOR_OP_WAIT:
+            if (in->arg <= 0 || in->arg > MOTOR_ROUTINE_TIME_MAX_MS) {
+                return motor_routine_fail(fault, pc, "Niepoprawny czas");
+            }
+            break;
+        case MOTOR_OP_WAIT_CUR:
+            if ((in->a != MOTOR_COND_CUR_GE && in->a != MOTOR_COND_CUR_LT) || !motor_routine_cond_ok(in->a, motor)) {
+                return motor_routine_fail(fault, pc, "Instrukcja wymaga pomiaru prądu");
+            }
+            if (in->b == 0 || in->arg < 0) {
+                return motor_routine_fail(fault, pc, "Niepoprawny próg lub limit czasu");
+            }
+            break;
+        case MOTOR_OP_LOOP:
+            if (in->a >= MOTOR_ROUTINE_LOOP_REGS || in->b >= pc ||
+                in->arg < 1 || in->arg > MOTOR_ROUTINE_LOOP_MAX) {
+                return motor_routine_fail(fault, pc, "Niepoprawna pętla");
+            }
+            // Licznik pętli wewnętrznej zerowałby się w każdym przebiegu zewnętrznej
+            for (size_t i = in->b; i < pc; i++) {
+                if (routine->code[i].op == MOTOR_OP_LOOP && routine->code[i].a == in->a) {
+                    return motor_routine_fail(fault, pc, "Zagnieżdżona pętla na tym samym liczniku");
+                }
+            }
+            break;
+        case MOTOR_OP_JUMP_IF:
+            if (in->b <= pc || in->b > routine->count) {
+                return motor_routine_fail(fault, pc, "Skok warunkowy tylko w przód");
+            }
+            if (!motor_routine_cond_ok(in->a, motor)) {
+                return motor_routine_fail(fault, pc, "Czujnik niedostępny na tym silniku");
+            }
+            break;
+        default:
+            return motor_routine_fail(fault, pc, "Nieznana instrukcja");
+        }
+    }
+    return ESP_OK;
+}
+
+// Blob NVS na procedurę; ESP_ERR_INVALID_SIZE, gdy format się nie zgadza
+static esp_err_t motor_routine_decode(const void *blob, size_t len, motor_routine_t *routine)
+{
+    motor_routine_hdr_t hdr;
+    if (len < sizeof(hdr)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(&hdr, blob, sizeof(hdr));
+    if (hdr.magic != MOTOR_ROUTINE_MAGIC || hdr.version != MOTOR_ROUTINE_VERSION ||
+        hdr.count == 0 || hdr.count > MOTOR_ROUTINE_MAX_INSNS ||
+        len != sizeof(hdr) + hdr.count * sizeof(motor_insn_t)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    routine->count = hdr.count;
+    memcpy(routine->code, (const uint8_t *)blob + sizeof(hdr), hdr.count * sizeof(motor_insn_t));
+    return ESP_OK;
+}
+
+static motor_routine_slot_t *motor_routine_cached(const char *name)
+{
+    for (size_t i = 0; i < MOTOR_ROUTINE_CACHE; i++) {
+        if (strcmp(s_cache[i].name, name) == 0) {
+            return &s_cache[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t motor_routine_store(const char *name, const void *blob, size_t len, motor_routine_fault_t *fault)
+{
+    if (!motor_routine_name_valid(name)) {
+        return motor_routine_fail(fault, 0, "Niepoprawna nazwa");
+    }
+    motor_routine_t routine;
+    if (motor_routine_decode(blob, len, &routine) != ESP_OK) {
+        return motor_routine_fail(fault, 0, "Niepoprawny nagłówek lub długość");
+    }
+    esp_err_t err = motor_routine_validate(&routine, MOTOR_PRIMARY, fault);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // Pod blokadą, żeby równoległy odczyt nie wczytał starej wersji
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    nvs_handle_t nvs;
+    err = nvs_open(MOTOR_ROUTINE_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs, name, blob, len);
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+
+    // Stara wersja nie może zostać w RAM
+    motor_routine_slot_t *slot = motor_routine_cached(name);
+    if (slot) {
+        slot->name[0] = '\0';
+    }
+    xSemaphoreGive(s_lock);
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "Zapisano procedurę %s (%u instrukcji)", name, (unsigned)routine.count);
+    }
+    return err;
+}
+
+// Wczytanie z NVS do wolnego albo najdawniej użytego slotu
+static esp_err_t motor_routine_load(const char *name, motor_routine_slot_t **out)
+{
+    motor_routine_slot_t *slot = &s_cache[0];
+    for (size_t i = 0; i < MOTOR_ROUTINE_CACHE && slot->name[0] != '\0'; i++) {
+        if (s_cache[i].name[0] == '\0' || s_cache[i].used < slot->used) {
+            slot = &s_cache[i];
+        }
+    }
+
+    static uint8_t blob[MOTOR_ROUTINE_BLOB_MAX];
+    size_t len = sizeof(blob);
+    nvs_handle_t nvs;
+    if (nvs_open(MOTOR_ROUTINE_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    esp_err_t err = nvs_get_blob(nvs, name, blob, &len);
+    nvs_close(nvs);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    slot->name[0] = '\0';
+    if (motor_routine_decode(blob, len, &slot->routine) != ESP_OK) {
+        ESP_LOGW(TAG, "Procedura %s w NVS ma zły format", name);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    strlcpy(slot->name, name, sizeof(slot->name));
+    ESP_LOGI(TAG, "Wczytano procedurę %s z NVS", name);
+    *out = slot;
+    return ESP_OK;
+}
+
+esp_err_t motor_routine_get(const char *name, motor_routine_t *routine)
+{
+    if (!motor_routine_name_valid(name)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    esp_err_t err = ESP_OK;
+    motor_routine_slot_t *slot = motor_routine_cached(name);
+    if (slot == NULL) {
+        err = motor_routine_load(name, &slot);
+    }
+    if (err == ESP_OK) {
+        slot->used = ++s_use_tick;
+        *routine = slot->routine;
+    }
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+esp_err_t motor_routine_delete(const char *name)
+{
+    if (!motor_routine_name_valid(name)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    motor_routine_slot_t *slot = motor_routine_cached(name);
+    if (slot) {
+        slot->name[0] = '\0';
+    }
+
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(MOTOR_ROUTINE_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err == ESP_OK) {
+        err = nvs_erase_key(nvs, name);
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    xSemaphoreGive(s_lock);
+    return (err == ESP_ERR_NVS_NOT_FOUND) ? ESP_ERR_NOT_FOUND : err;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// Procedury ruchu zapisane w urządzeniu ("level", "stow", ...): program
+// w kodzie bajtowym o stałej długości instrukcji, trzymany w NVS jako blob
+// i wczytywany do RAM przy pierwszym użyciu. Interpreter działa w zadaniu
+// silnika (motor.c) jako zadanie motor_prog, więc postęp i anulowanie
+// obsługuje /api/v1/program.
+
+#define MOTOR_ROUTINE_MAX_INSNS 32
+// Nazwa jest kluczem NVS - do 15 znaków [A-Za-z0-9_-]
+#define MOTOR_ROUTINE_NAME_MAX 16
+// Liczniki pętli (rejestry instrukcji LOOP)
+#define MOTOR_ROUTINE_LOOP_REGS 4
+#define MOTOR_ROUTINE_LOOP_MAX 10000
+// Najdłuższy czas RUN i WAIT
+#define MOTOR_ROUTINE_TIME_MAX_MS 60000
+
+// Blob w NVS: nagłówek i instrukcje, little-endian
+#define MOTOR_ROUTINE_MAGIC 0x52    // 'R'
+#define MOTOR_ROUTINE_VERSION 1
+#define MOTOR_ROUTINE_BLOB_MAX (sizeof(motor_routine_hdr_t) + MOTOR_ROUTINE_MAX_INSNS * sizeof(motor_insn_t))
+
+typedef enum {
+    MOTOR_OP_END,           // koniec procedury (mostek wyłączony)
+    MOTOR_OP_DRIVE,         // praca ciągła: a = kierunek, b = wypełnienie
+    MOTOR_OP_STOP,          // wyłączenie mostka
+    MOTOR_OP_RUN,           // praca przez arg ms i stop: a = kierunek, b = wypełnienie
+    MOTOR_OP_MOVE,          // ruch do pozycji arg z wypełnieniem b (enkoder)
+    MOTOR_OP_WAIT,          // odczekanie arg ms
+    MOTOR_OP_WAIT_POS,      // czekanie na pozycję arg, limit b ms (enkoder)
+    MOTOR_OP_WAIT_CUR,      // czekanie na prąd a (warunek) arg mA, limit b ms (pomiar prądu)
+    MOTOR_OP_LOOP,          // licznik a: powtórzenie instrukcji od b, razem arg przebiegów
+    MOTOR_OP_JUMP_IF,       // skok do b, gdy spełniony warunek a dla progu arg
+    MOTOR_OP_MAX,
+} motor_op_t;
+
+// Warunki WAIT_CUR i JUMP_IF
+typedef enum {
+    MOTOR_COND_POS_GE,      // pozycja >= arg (enkoder)
+    MOTOR_COND_POS_LT,
+    MOTOR_COND_CUR_GE,      // prąd >= arg mA (pomiar prądu)
+    MOTOR_COND_CUR_LT,
+    MOTOR_COND_MAX,
+} motor_cond_t;
+
+// Instrukcja - 8 bajtów, znaczenie pól zależy od kodu
+typedef struct {
+    uint8_t op;             // motor_op_t
+    uint8_t a;
+    uint16_t b;
+    int32_t arg;
+} motor_insn_t;
+
+typedef struct {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t count;
+    uint8_t reserved;
+} motor_routine_hdr_t;
+
+typedef struct {
+    size_t count;
+    motor_insn_t code[MOTOR_ROUTINE_MAX_INSNS];
+} motor_routine_t;
+
+// Powód odrzucenia przez walidator
+typedef struct {
+    size_t pc;
+    const char *reason;
+} motor_routine_fault_t;
+
+// Blokada pamięci podręcznej - przed pierwszym żądaniem HTTP
+esp_err_t motor_routine_init(void);
+
+// Sprawdzenie procedury dla silnika motor: znane kody, zakresy pól,
+// czujniki dostępne na tym silniku, skoki warunkowe tylko w przód
+// i pętle bez zagnieżdżania na tym samym liczniku - każda procedura,
+// która przejdzie walidację, kończy się po skończonej liczbie instrukcji.
+esp_err_t motor_routine_validate(const motor_routine_t *routine, uint8_t motor, motor_routine_fault_t *fault);
+
+// Blob z żądania: walidacja (dla MOTOR_PRIMARY) i zapis w NVS.
+// ESP_ERR_INVALID_ARG ze szczegółami w fault dla złego kodu.
+esp_err_t motor_routine_store(const char *name, const void *blob, size_t len, motor_routine_fault_t *fault);
+
+// Kopia procedury z pamięci podręcznej, przy pierwszym użyciu wczytanej
+// z NVS. ESP_ERR_NOT_FOUND, gdy jej nie ma.
+esp_err_t motor_routine_get(const char *name, motor_routine_t *routine);
+
+esp_err_t motor_routine_delete(const char *name);
+
+// Nazwa nadaje się na klucz NVS
+bool motor_routine_name_valid(const char *name);
@@ -0,0 +1,177 @@
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "motor_seq.h"
+
+static const char *TAG = "motor_seq";
+
+// Bit powiadomienia oznaczający koniec sekwencji; bity 0..MAX_STEPS-1
+// oznaczają granice kolejnych kroków
+#define MOTOR_SEQ_DONE_BIT BIT(31)
+
+void motor_seq_plan(const motor_step_t *steps, size_t count, int64_t t0_us, int64_t *deadlines)
+{
+    // Chwile liczone od wspólnego t0, więc błędy nie kumulują się między krokami
+    int64_t t = t0_us;
+    for (size_t i = 0; i < count; i++) {
+        deadlines[i] = t;
+        t += steps[i].duration_us;
+    }
+    deadlines[count] = t;
+}
+
+size_t motor_seq_add_phase(motor_step_t *steps, size_t n, uint32_t in1, uint32_t in2,
+                           uint32_t phase_ms, motor_ramp_t ramp, uint32_t ramp_ms)
+{
+    uint32_t phase_us = phase_ms * 1000;
+
+    if (ramp == MOTOR_RAMP_NONE) {
+        steps[n++] = (motor_step_t){ .in1 = in1, .in2 = in2, .duration_us = phase_us };
+        return n;
+    }
+
+    if (motor_ramp_has_decel(ramp)) {
+        // Rozruch i hamowanie mieszczą się w czasie fazy
+        if (ramp_ms * 2 > phase_ms) {
+            ramp_ms = phase_ms / 2;
+        }
+        steps[n++] = (motor_step_t){ .in1 = in1, .in2 = in2, .duration_us = phase_us - ramp_ms * 1000,
+                                     .ramp_ms = ramp_ms, .ramp = ramp };
+        steps[n++] = (motor_step_t){ .duration_us = ramp_ms * 1000, .ramp_ms = ramp_ms, .ramp = ramp };
+        return n;
+    }
+
+    // Rampa liniowa: najpierw skokowe wyłączenie poprzedniego kierunku
+    if (ramp_ms > phase_ms) {
+        ramp_ms = phase_ms;
+    }
+    if (n > 0) {
+        steps[n++] = (motor_step_t){ .duration_us = 0 };
+    }
+    steps[n++] = (motor_step_t){ .in1 = in1, .in2 = in2, .duration_us = phase_us,
+                                 .ramp_ms = ramp_ms, .ramp = ramp };
+    return n;
+}
+
+// Callback timera - wykonywany w przerwaniu, nie czeka na tick FreeRTOS.
+// Sterownik zanikania LEDC blokuje kanał semaforem, więc samo ustawienie
+// mostka wykonuje zadanie silnika obudzone stąd bezpośrednio.
+static void IRAM_ATTR motor_seq_timer_cb(void *arg)
+{
+    motor_seq_t *seq = arg;
+    size_t i = seq->next;
+    uint32_t bits = 0;
+    int64_t now = esp_timer_get_time();
+
+    // Granice o tej samej chwili (krok o zerowym czasie) zgłaszane razem -
+    // ponowne uzbrojenie na 1 us spóźniałoby kolejny krok
+    do {
+        bits |= (i < seq->count) ? BIT(i) : MOTOR_SEQ_DONE_BIT;
+        i++;
+    } while (i <= seq->count && seq->deadlines[i] <= now);
+    seq->next = i;
+
+    if (i <= seq->count) {
+        esp_timer_start_once(seq->timer, seq->deadlines[i] - now);
+    }
+
+    BaseType_t need_yield = pdFALSE;
+    xTaskNotifyFromISR(seq->waiter, bits, eSetBits, &need_yield);
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+    if (need_yield) {
+        esp_timer_isr_dispatch_need_yield();
+    }
+#endif
+}
+
+esp_err_t motor_seq_init(motor_seq_t *seq)
+{
+    memset(seq, 0, sizeof(*seq));
+    const esp_timer_create_args_t timer_args = {
+        .callback = motor_seq_timer_cb,
+        .arg = seq,
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+        .dispatch_method = ESP_TIMER_ISR,
+#else
+        .dispatch_method = ESP_TIMER_TASK,
+#endif
+        .name = "motor_seq"
+    };
+    return esp_timer_create(&timer_args, &seq->timer);
+}
+
+esp_err_t motor_seq_start(motor_seq_t *seq, const motor_step_t *steps, size_t count, int64_t t0_us)
+{
+    if (count == 0 || count > MOTOR_SEQ_MAX_STEPS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (esp_timer_is_active(seq->timer)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memcpy(seq->steps, steps, count * sizeof(motor_step_t));
+    seq->count = count;
+    seq->lateness_us = 0;
+    seq->waiter = xTaskGetCurrentTaskHandle();
+    xTaskNotifyWait(0, UINT32_MAX, NULL, 0);
+
+    int64_t now = esp_timer_get_time();
+    if (t0_us > now) {
+        // Start w zaplanowanej chwili - pierwszą granicę też wyznacza timer
+        motor_seq_plan(seq->steps, seq->count, t0_us, seq->deadlines);
+        seq->next = 0;
+        seq->pending = 0;
+    } else {
+        // Pierwszy krok jest wymagalny od razu
+        motor_seq_plan(seq->steps, seq->count, now, seq->deadlines);
+        seq->next = 1;
+        seq->pending = BIT(0);
+    }
+    ESP_LOGD(TAG, "Start sekwencji: %u kroków, koniec za %" PRId64 " us",
+             (unsigned)count, seq->deadlines[count] - now);
+
+    int64_t wait = seq->deadlines[seq->next] - esp_timer_get_time();
+    return esp_timer_start_once(seq->timer, wait > 0 ? wait : 1);
+}
+
+esp_err_t motor_seq_next(motor_seq_t *seq, TickType_t timeout, const motor_step_t **step)
+{
+    while (seq->pending == 0) {
+        uint32_t bits = 0;
+        if (xTaskNotifyWait(0, UINT32_MAX, &bits, timeout) != pdTRUE) {
+            return ESP_ERR_TIMEOUT;
+        }
+        if (bits & MOTOR_SEQ_ABORT_BIT) {
+            // Callback timera nie uzbroi go ponownie po ostatnim kroku
+            seq->next = seq->count;
+            esp_timer_stop(seq->timer);
+            seq->pending = 0;
+            return ESP_ERR_INVALID_STATE;
+        }
+        seq->pending |= bits;
+    }
+
+    // Granice obsługiwane po kolei, koniec sekwencji na samym końcu
+    size_t i = 0;
+    while (i < seq->count && !(seq->pending & BIT(i))) {
+        i++;
+    }
+    seq->pending &= (i < seq->count) ? ~BIT(i) : ~MOTOR_SEQ_DONE_BIT;
+
+    int64_t late = esp_timer_get_time() - seq->deadlines[i];
+    if (late > seq->lateness_us) {
+        seq->lateness_us = late;
+    }
+
+    *step = (i < seq->count) ? &seq->steps[i] : NULL;
+    return ESP_OK;
+}
+
+int64_t motor_seq_last_lateness_us(const motor_seq_t *seq)
+{
+    return seq->lateness_us;
+}
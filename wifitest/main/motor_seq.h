@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "motor_ramp.h"
+
+// Maksymalna liczba kroków w jednej sekwencji
+#define MOTOR_SEQ_MAX_STEPS 8
+
+// Bit powiadomienia zadania przerywający sekwencję przed czasem
+// (np. z przerwania wykrycia utyku)
+#define MOTOR_SEQ_ABORT_BIT BIT(29)
+
+// Jeden krok sekwencji: stan mostka H utrzymywany przez duration_us.
+// Dla ramp != MOTOR_RAMP_NONE stan docelowy osiągany jest zanikaniem
+// sprzętowym trwającym ramp_ms (wliczonym w duration_us).
+typedef struct {
+    uint32_t in1;           // wypełnienie IN1
+    uint32_t in2;           // wypełnienie IN2
+    uint32_t duration_us;   // czas trwania kroku
+    uint16_t ramp_ms;       // czas rampy na początku kroku
+    uint8_t ramp;           // motor_ramp_t
+} motor_step_t;
+
+// Sekwencer jednego silnika - każde zadanie silnika ma własny
+typedef struct {
+    esp_timer_handle_t timer;
+    TaskHandle_t waiter;
+    // Stan bieżącej sekwencji - modyfikowany tylko gdy timer nie jest aktywny
+    motor_step_t steps[MOTOR_SEQ_MAX_STEPS];
+    int64_t deadlines[MOTOR_SEQ_MAX_STEPS + 1];
+    size_t count;
+    volatile size_t next;
+    uint32_t pending;
+    int64_t lateness_us;
+} motor_seq_t;
+
+// Utworzenie timera sekwencera
+esp_err_t motor_seq_init(motor_seq_t *seq);
+
+// Start sekwencji przez bieżące zadanie w chwili t0_us (esp_timer_get_time;
+// 0 lub chwila miniona - od razu). Granice kroków wyznacza jednorazowy
+// timer sprzętowy, który z przerwania budzi zadanie (motor_seq_next)
+// dokładnie w zaplanowanej chwili. Wspólne t0_us synchronizuje sekwencje
+// kilku silników.
+esp_err_t motor_seq_start(motor_seq_t *seq, const motor_step_t *steps, size_t count, int64_t t0_us);
+
+// Oczekiwanie na kolejną granicę sekwencji. Zwraca ESP_OK i krok do
+// wykonania albo ESP_OK i *step == NULL, gdy sekwencja się skończyła.
+// Po MOTOR_SEQ_ABORT_BIT zatrzymuje timer i zwraca ESP_ERR_INVALID_STATE.
+esp_err_t motor_seq_next(motor_seq_t *seq, TickType_t timeout, const motor_step_t **step);
+
+// Wyliczenie bezwzględnych chwil przełączeń dla sekwencji startującej
+// w t0_us. deadlines musi mieć miejsce na count + 1 elementów - ostatni
+// to chwila wyłączenia mostka. Funkcja nie zależy od sprzętu.
+void motor_seq_plan(const motor_step_t *steps, size_t count, int64_t t0_us, int64_t *deadlines);
+
+// Dodanie do steps (zajęte n) jednej fazy ruchu: stan in1/in2 przez
+// phase_ms z rampą ramp/ramp_ms, skróconą tak, by mieściła się w fazie.
+// Zwraca nową liczbę kroków; faza zajmuje najwyżej 2 kroki.
+size_t motor_seq_add_phase(motor_step_t *steps, size_t n, uint32_t in1, uint32_t in2,
+                           uint32_t phase_ms, motor_ramp_t ramp, uint32_t ramp_ms);
+
+// Największe opóźnienie przełączenia względem planu w ostatniej sekwencji
+int64_t motor_seq_last_lateness_us(const motor_seq_t *seq);
@@ -0,0 +1,256 @@
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "encoder.h"
+#include "motor.h"
+#include "motor_speed.h"
+
+static const char *TAG = "motor_speed";
+
+// Zadanie regulatora - ponad zadaniem silnika, aby okres pętli
+// nie zależał od obsługi komend
+#define MOTOR_SPEED_TASK_STACK 3072
+#define MOTOR_SPEED_TASK_PRIO (configMAX_PRIORITIES - 4)
+
+#define MOTOR_SPEED_PERIOD_US (1000000 / CONFIG_MOTOR_PID_RATE_HZ)
+
+// Prędkość liczona z przyrostu pozycji w oknie ok. 20 ms - przy 1 kHz
+// jeden krok to zbyt mało zliczeń, aby wynik nie skakał
+#define MOTOR_SPEED_WINDOW_RAW (CONFIG_MOTOR_PID_RATE_HZ / 50)
+#define MOTOR_SPEED_WINDOW (MOTOR_SPEED_WINDOW_RAW < 1 ? 1 : MOTOR_SPEED_WINDOW_RAW)
+
+static motor_speed_out_t s_out;
+static esp_timer_handle_t s_timer;
+static TaskHandle_t s_task;
+static SemaphoreHandle_t s_step_lock;   // trzymany przez jeden krok pętli
+static volatile bool s_active;
+
+static motor_pid_t s_pid;
+static int32_t s_target_rpm;
+static int32_t s_window[MOTOR_SPEED_WINDOW];
+static size_t s_window_idx;
+static int64_t s_last_us;
+static uint64_t s_jitter_sum;
+static uint32_t s_jitter_count;
+
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static motor_speed_stats_t s_stats;
+
+int32_t motor_pid_update(motor_pid_t *pid, int32_t err)
+{
+    const int64_t max = (int64_t)pid->out_max << MOTOR_PID_Q;
+    int64_t p = (int64_t)pid->kp * err;
+    int64_t d = (int64_t)pid->kd * (err - pid->prev_err);
+    int64_t integ = pid->integ + (int64_t)pid->ki * err;
+
+    pid->prev_err = err;
+    if (integ > max) {
+        integ = max;
+    } else if (integ < 0) {
+        integ = 0;
+    }
+
+    int64_t out = p + integ + d;
+    if (out > max) {
+        out = max;
+        if (err > 0) {
+            integ = pid->integ;
+        }
+    } else if (out < 0) {
+        out = 0;
+        if (err < 0) {
+            integ = pid->integ;
+        }
+    }
+    pid->integ = (int32_t)integ;
+    return (int32_t)(out >> MOTOR_PID_Q);
+}
+
+// Wzmocnienia z Kconfig (tysięczne części) w Q16 na krok pętli
+static int32_t motor_speed_gain(int64_t milli, int64_t num, int64_t den)
+{
+    int64_t gain = (milli << MOTOR_PID_Q) * num / (1000 * den);
+    return gain > INT32_MAX ? INT32_MAX : (int32_t)gain;
+}
+
+// Tick pętli (przerwanie esp_timer) - sam pomiar i obliczenia w zadaniu
+static void IRAM_ATTR motor_speed_timer_cb(void *arg)
+{
+    BaseType_t need_yield = pdFALSE;
+    vTaskNotifyGiveFromISR(s_task, &need_yield);
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+    if (need_yield) {
+        esp_timer_isr_dispatch_need_yield();
+    }
+#endif
+}
+
+static void motor_speed_step(uint32_t ticks)
+{
+    // Odchylenie rzeczywistego okresu od nominalnego
+    int64_t now = esp_timer_get_time();
+    uint32_t jitter = 0;
+    if (s_last_us != 0) {
+        int64_t dev = now - s_last_us - (int64_t)MOTOR_SPEED_PERIOD_US * ticks;
+        jitter = (uint32_t)(dev < 0 ? -dev : dev);
+        s_jitter_sum += jitter;
+        s_jitter_count++;
+    }
+    s_last_us = now;
+
+    int32_t count = encoder_get_count();
+    int32_t delta = count - s_window[s_window_idx];
+    s_window[s_window_idx] = count;
+    s_window_idx = (s_window_idx + 1) % MOTOR_SPEED_WINDOW;
+
+    int32_t rpm = (int32_t)((int64_t)delta * 60 * CONFIG_MOTOR_PID_RATE_HZ /
+                            ((int64_t)CONFIG_ENCODER_CPR * MOTOR_SPEED_WINDOW));
+    if (rpm < 0) {
+        rpm = -rpm;
+    }
+
+    int32_t duty = motor_pid_update(&s_pid, s_target_rpm - rpm);
+    s_out((uint32_t)duty);
+
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.rpm = rpm;
+    s_stats.duty = (uint32_t)duty;
+    s_stats.target_rpm = s_target_rpm;
+    if (jitter > s_stats.jitter_max_us) {
+        s_stats.jitter_max_us = jitter;
+    }
+    s_stats.jitter_avg_us = s_jitter_count ? (uint32_t)(s_jitter_sum / s_jitter_count) : 0;
+    s_stats.overruns += ticks - 1;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+static void motor_speed_task(void *arg)
+{
+    for (;;) {
+        uint32_t ticks = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (ticks == 0) {
+            continue;
+        }
+        xSemaphoreTake(s_step_lock, portMAX_DELAY);
+        if (s_active) {
+            motor_speed_step(ticks);
+        }
+        xSemaphoreGive(s_step_lock);
+    }
+}
+
+esp_err_t motor_speed_init(motor_speed_out_t out)
+{
+    esp_err_t err = encoder_init();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    s_out = out;
+    s_pid.kp = motor_speed_gain(CONFIG_MOTOR_PID_KP_MILLI, 1, 1);
+    s_pid.ki = motor_speed_gain(CONFIG_MOTOR_PID_KI_MILLI, 1, CONFIG_MOTOR_PID_RATE_HZ);
+    s_pid.kd = motor_speed_gain(CONFIG_MOTOR_PID_KD_MILLI, CONFIG_MOTOR_PID_RATE_HZ, 1);
+    s_pid.out_max = PWM_DUTY;
+
+    s_step_lock = xSemaphoreCreateMutex();
+    if (s_step_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreate(motor_speed_task, "motor_pid", MOTOR_SPEED_TASK_STACK, NULL, MOTOR_SPEED_TASK_PRIO, &s_task) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = motor_speed_timer_cb,
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+        .dispatch_method = ESP_TIMER_ISR,
+#else
+        .dispatch_method = ESP_TIMER_TASK,
+#endif
+        .name = "motor_pid"
+    };
+    err = esp_timer_create(&timer_args, &s_timer);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Regulator prędkości: %d Hz, okno pomiaru %d kroków",
+             CONFIG_MOTOR_PID_RATE_HZ, MOTOR_SPEED_WINDOW);
+    return ESP_OK;
+}
+
+void motor_speed_start(uint32_t target_rpm, uint32_t start_duty)
+{
+    xSemaphoreTake(s_step_lock, portMAX_DELAY);
+    s_target_rpm = (int32_t)target_rpm;
+    s_pid.integ = (int32_t)(start_duty << MOTOR_PID_Q);
+    s_pid.prev_err = 0;
+
+    int32_t count = encoder_get_count();
+    for (size_t i = 0; i < MOTOR_SPEED_WINDOW; i++) {
+        s_window[i] = count;
+    }
+    s_window_idx = 0;
+    s_last_us = 0;
+    s_jitter_sum = 0;
+    s_jitter_count = 0;
+
+    portENTER_CRITICAL(&s_stats_lock);
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.active = true;
+    s_stats.target_rpm = s_target_rpm;
+    s_stats.duty = start_duty;
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    bool was_active = s_active;
+    s_active = true;
+    xSemaphoreGive(s_step_lock);
+
+    if (!was_active) {
+        esp_timer_start_periodic(s_timer, MOTOR_SPEED_PERIOD_US);
+    }
+    ESP_LOGI(TAG, "Regulacja prędkości: %" PRIu32 " obr/min", target_rpm);
+}
+
+void motor_speed_set_target(uint32_t target_rpm)
+{
+    xSemaphoreTake(s_step_lock, portMAX_DELAY);
+    s_target_rpm = (int32_t)target_rpm;
+    xSemaphoreGive(s_step_lock);
+}
+
+void motor_speed_stop(void)
+{
+    if (!s_active) {
+        return;
+    }
+    s_active = false;
+    esp_timer_stop(s_timer);
+
+    // Krok w toku kończy się przed powrotem - potem wypełnienie należy do wołającego
+    xSemaphoreTake(s_step_lock, portMAX_DELAY);
+    xSemaphoreGive(s_step_lock);
+
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.active = false;
+    portEXIT_CRITICAL(&s_stats_lock);
+    ESP_LOGI(TAG, "Koniec regulacji, jitter max %" PRIu32 " us, śr. %" PRIu32 " us, pominięte %" PRIu32,
+             s_stats.jitter_max_us, s_stats.jitter_avg_us, s_stats.overruns);
+}
+
+bool motor_speed_active(void)
+{
+    return s_active;
+}
+
+void motor_speed_get_stats(motor_speed_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
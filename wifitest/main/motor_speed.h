@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// Regulacja prędkości w pętli zamkniętej: enkoder (PCNT) -> PID -> wypełnienie.
+// Pętla działa ze stałą częstotliwością CONFIG_MOTOR_PID_RATE_HZ wyznaczaną
+// przez esp_timer (niezależnie od ticku FreeRTOS), obliczenia są całkowite.
+
+// Wzmocnienia i całka w formacie stałoprzecinkowym Q16
+#define MOTOR_PID_Q 16
+
+// Stan regulatora PID
+typedef struct {
+    int32_t kp;             // Q16, wypełnienie na 1 obr/min
+    int32_t ki;             // Q16, na jeden krok pętli
+    int32_t kd;             // Q16, na jeden krok pętli
+    int32_t integ;          // całka, Q16 wypełnienia
+    int32_t prev_err;
+    int32_t out_max;        // wyjście ograniczone do 0..out_max
+} motor_pid_t;
+
+// Jeden krok regulatora dla uchybu err (obr/min). Całka nie narasta,
+// gdy wyjście jest nasycone w kierunku uchybu (anti-windup).
+int32_t motor_pid_update(motor_pid_t *pid, int32_t err);
+
+// Ustawienie wypełnienia przez pętlę (zadanie regulatora)
+typedef void (*motor_speed_out_t)(uint32_t duty);
+
+// Migawka stanu pętli do telemetrii
+typedef struct {
+    bool active;
+    int32_t target_rpm;
+    int32_t rpm;            // zmierzona prędkość (wartość bezwzględna)
+    uint32_t duty;
+    uint32_t jitter_max_us; // największe odchylenie okresu od nominalnego
+    uint32_t jitter_avg_us; // średnie odchylenie od startu pętli
+    uint32_t overruns;      // kroki pominięte, bo poprzedni się nie skończył
+} motor_speed_stats_t;
+
+// Enkoder, timer i zadanie regulatora
+esp_err_t motor_speed_init(motor_speed_out_t out);
+
+// Start regulacji od bieżącego wypełnienia start_duty (bez skoku)
+void motor_speed_start(uint32_t target_rpm, uint32_t start_duty);
+
+// Zmiana prędkości zadanej w trakcie regulacji
+void motor_speed_set_target(uint32_t target_rpm);
+
+// Zatrzymanie pętli; po powrocie regulator nie zmienia już wypełnienia
+void motor_speed_stop(void);
+
+bool motor_speed_active(void);
+
+void motor_speed_get_stats(motor_speed_stats_t *stats);
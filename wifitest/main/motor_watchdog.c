@@ -0,0 +1,207 @@
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "motor.h"
+#include "motor_hw.h"
+#include "motor_watchdog.h"
+
+static const char *TAG = "motor_watchdog";
+
+#define MOTOR_WATCHDOG_US ((int64_t)CONFIG_MOTOR_WATCHDOG_MS * 1000)
+
+// Uzbrojenie jednego silnika - pola pod s_watchdog_lock, czyta je też
+// callback w przerwaniu
+typedef struct {
+    esp_timer_handle_t timer;
+    bool armed;             // praca bez końca (RUN, SPEED)
+    int session;            // gniazdo WebSocket właściciela albo MOTOR_SESSION_NONE
+    int64_t deadline_us;    // ostatnia ramka właściciela + CONFIG_MOTOR_WATCHDOG_MS
+} motor_watchdog_arm_t;
+
+static motor_watchdog_arm_t s_arms[MOTOR_COUNT];
+static portMUX_TYPE s_watchdog_lock = portMUX_INITIALIZER_UNLOCKED;
+static motor_watchdog_stats_t s_stats;
+
+// Termin silnika minął. Callback w przerwaniu (ESP_TIMER_ISR), więc tylko
+// spinlock i wywołania bezpieczne w ISR: blokada mostka w motor_hw i STOP
+// wstawiony do kolejki z pominięciem s_post_lock. Zadanie silnika zdejmuje
+// blokadę przy obsłudze tego STOP i loguje zadziałanie.
+static void IRAM_ATTR motor_watchdog_expired(void *arg)
+{
+    const uint8_t motor = (uint8_t)(uintptr_t)arg;
+    motor_watchdog_arm_t *a = &s_arms[motor];
+
+    portENTER_CRITICAL_SAFE(&s_watchdog_lock);
+    int64_t deadline = a->deadline_us;
+    // Ramka tuż przed wywołaniem przesunęła termin i timer odlicza od nowa
+    bool trip = a->armed && esp_timer_get_time() >= deadline;
+    if (trip) {
+        a->armed = false;
+    }
+    portEXIT_CRITICAL_SAFE(&s_watchdog_lock);
+    if (!trip) {
+        return;
+    }
+
+    motor_hw_trip(motor);
+    uint32_t latency = (uint32_t)(esp_timer_get_time() - deadline);
+
+    portENTER_CRITICAL_SAFE(&s_watchdog_lock);
+    s_stats.trips++;
+    s_stats.latency_us = latency;
+    if (latency > s_stats.latency_max_us) {
+        s_stats.latency_max_us = latency;
+    }
+    portEXIT_CRITICAL_SAFE(&s_watchdog_lock);
+
+    // Zadanie silnika porzuca ruch w toku i zdejmuje blokadę mostka
+    bool need_yield = motor_stop_from_isr(motor);
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+    if (need_yield) {
+        esp_timer_isr_dispatch_need_yield();
+    }
+#else
+    (void)need_yield;
+#endif
+}
+
+esp_err_t motor_watchdog_init(void)
+{
+    for (int m = 0; m < MOTOR_COUNT; m++) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = motor_watchdog_expired,
+            .arg = (void *)(uintptr_t)m,
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+            .dispatch_method = ESP_TIMER_ISR,
+#else
+            .dispatch_method = ESP_TIMER_TASK,
+#endif
+            .name = "motor_watchdog"
+        };
+        s_arms[m].session = MOTOR_SESSION_NONE;
+        esp_err_t err = esp_timer_create(&timer_args, &s_arms[m].timer);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    ESP_LOGI(TAG, "Watchdog łącza: %d ms", CONFIG_MOTOR_WATCHDOG_MS);
+    return ESP_OK;
+}
+
+// Nowy termin od teraz. Timer startuje po jego wyznaczeniu, więc nie
+// zadziała przed nim.
+static void motor_watchdog_restart(uint8_t motor)
+{
+    esp_timer_stop(s_arms[motor].timer);
+    esp_timer_start_once(s_arms[motor].timer, MOTOR_WATCHDOG_US);
+}
+
+void motor_watchdog_arm(uint8_t motor, int session)
+{
+    portENTER_CRITICAL(&s_watchdog_lock);
+    s_arms[motor].armed = true;
+    s_arms[motor].session = session;
+    s_arms[motor].deadline_us = esp_timer_get_time() + MOTOR_WATCHDOG_US;
+    portEXIT_CRITICAL(&s_watchdog_lock);
+    motor_watchdog_restart(motor);
+}
+
+void motor_watchdog_feed(uint8_t motor, int session)
+{
+    motor_watchdog_arm_t *a = &s_arms[motor];
+
+    portENTER_CRITICAL(&s_watchdog_lock);
+    bool fed = a->armed && (a->session == MOTOR_SESSION_NONE || a->session == session);
+    if (fed) {
+        a->deadline_us = esp_timer_get_time() + MOTOR_WATCHDOG_US;
+    }
+    portEXIT_CRITICAL(&s_watchdog_lock);
+    if (fed) {
+        motor_watchdog_restart(motor);
+    }
+}
+
+// Silniki uzbrojone przez gniazdo session; wołane pod s_watchdog_lock
+static uint32_t motor_watchdog_owned_locked(int session)
+{
+    uint32_t owned = 0;
+    for (int m = 0; m < MOTOR_COUNT; m++) {
+        if (s_arms[m].armed && s_arms[m].session == session) {
+            owned |= BIT(m);
+        }
+    }
+    return owned;
+}
+
+void motor_watchdog_heartbeat(int session)
+{
+    if (session == MOTOR_SESSION_NONE) {
+        return;
+    }
+    portENTER_CRITICAL(&s_watchdog_lock);
+    const uint32_t owned = motor_watchdog_owned_locked(session);
+    const int64_t deadline = esp_timer_get_time() + MOTOR_WATCHDOG_US;
+    for (int m = 0; m < MOTOR_COUNT; m++) {
+        if (owned & BIT(m)) {
+            s_arms[m].deadline_us = deadline;
+        }
+    }
+    portEXIT_CRITICAL(&s_watchdog_lock);
+    for (int m = 0; m < MOTOR_COUNT; m++) {
+        if (owned & BIT(m)) {
+            motor_watchdog_restart(m);
+        }
+    }
+}
+
+void motor_watchdog_session_closed(int session)
+{
+    if (session == MOTOR_SESSION_NONE) {
+        return;
+    }
+    portENTER_CRITICAL(&s_watchdog_lock);
+    const uint32_t owned = motor_watchdog_owned_locked(session);
+    for (int m = 0; m < MOTOR_COUNT; m++) {
+        if (owned & BIT(m)) {
+            s_arms[m].armed = false;
+        }
+    }
+    portEXIT_CRITICAL(&s_watchdog_lock);
+
+    // Zadanie serwera HTTP - zwykły STOP przez kolejkę, a blokada mostka
+    // wcześniej, aby ruch w toku nie zdążył już niczego zapisać
+    const motor_cmd_t stop = { .type = MOTOR_CMD_STOP };
+    for (uint8_t m = 0; m < MOTOR_COUNT; m++) {
+        if (!(owned & BIT(m))) {
+            continue;
+        }
+        esp_timer_stop(s_arms[m].timer);
+        motor_hw_trip(m);
+        portENTER_CRITICAL(&s_watchdog_lock);
+        s_stats.trips++;
+        portEXIT_CRITICAL(&s_watchdog_lock);
+        motor_post(m, &stop);
+        ESP_LOGW(TAG, "Sesja %d zamknięta - stop silnika %u", session, m);
+    }
+}
+
+void motor_watchdog_disarm(uint8_t motor)
+{
+    portENTER_CRITICAL(&s_watchdog_lock);
+    s_arms[motor].armed = false;
+    portEXIT_CRITICAL(&s_watchdog_lock);
+    esp_timer_stop(s_arms[motor].timer);
+}
+
+void motor_watchdog_get_stats(motor_watchdog_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_watchdog_lock);
+    *stats = s_stats;
+    stats->armed = false;
+    for (int m = 0; m < MOTOR_COUNT; m++) {
+        stats->armed |= s_arms[m].armed;
+    }
+    portEXIT_CRITICAL(&s_watchdog_lock);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// Watchdog łącza sterującego (dead-man). Komenda pracy bez końca (RUN,
+// SPEED) uzbraja dla tego silnika jednorazowy esp_timer na
+// CONFIG_MOTOR_WATCHDOG_MS i zapisuje sesję, która go uruchomiła:
+// gniazdo WebSocket albo MOTOR_SESSION_NONE dla dróg bez sesji (HTTP,
+// REST). Termin przesuwają tylko ramki tej sesji (także WS_OP_HEARTBEAT),
+// a silnik bez sesji - następne komendy dla niego. Inna karta ani komenda
+// dla innego silnika nie utrzyma go w ruchu. STOP lub ruch ograniczony
+// w czasie zdejmuje silnik z watchdoga. Gdy właściciel milknie, callback
+// timera w przerwaniu blokuje mostek (motor_hw_trip) - bez kolejki
+// i zadania silnika, które może akurat czekać - i dopiero potem wstawia
+// mu STOP. Zamknięcie gniazda sesji zatrzymuje jej silniki od razu.
+
+// Migawka do telemetrii
+typedef struct {
+    bool armed;                 // uzbrojony dla co najmniej jednego silnika
+    uint32_t trips;             // liczba zadziałań (silników)
+    uint32_t latency_us;        // ostatnie zadziałanie: termin -> mostek na 0
+    uint32_t latency_max_us;
+} motor_watchdog_stats_t;
+
+esp_err_t motor_watchdog_init(void);
+
+// Uzbrojenie dla silnika motor przez sesję session i nowy termin (RUN, SPEED)
+void motor_watchdog_arm(uint8_t motor, int session);
+
+// Komenda sesji session dla silnika motor: nowy termin, jeśli to ta sama
+// sesja albo silnik uzbroiła droga bez sesji
+void motor_watchdog_feed(uint8_t motor, int session);
+
+// Ramka sesji session (heartbeat, odrzucona komenda): nowy termin
+// wszystkich silników, które uzbroiła
+void motor_watchdog_heartbeat(int session);
+
+// Zamknięcie gniazda session (close_fn serwera): silniki tej sesji
+// stają od razu, bez czekania na termin
+void motor_watchdog_session_closed(int session);
+
+// Zdjęcie silnika motor z watchdoga i zatrzymanie jego timera
+void motor_watchdog_disarm(uint8_t motor);
+
+void motor_watchdog_get_stats(motor_watchdog_stats_t *stats);
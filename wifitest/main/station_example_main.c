@@ -1,184 +1,361 @@
+#include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <unistd.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
 #include "esp_system.h"
-#include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
-#include "lwip/err.h"
-#include "lwip/sys.h"
 #include "esp_http_server.h"
-#include "driver/ledc.h"
-
-// Wi-Fi konfiguracja
-#define EXAMPLE_ESP_WIFI_SSID      CONFIG_ESP_WIFI_SSID
-#define EXAMPLE_ESP_WIFI_PASS      CONFIG_ESP_WIFI_PASSWORD
-#define EXAMPLE_ESP_MAXIMUM_RETRY  CONFIG_ESP_MAXIMUM_RETRY
-
-// Wi-Fi Event Group
-static EventGroupHandle_t s_wifi_event_group;
-#define WIFI_CONNECTED_BIT BIT0
-#define WIFI_FAIL_BIT      BIT1
-
-static const char *TAG = "wifi station";
-static int s_retry_num = 0;
-
-// PWM konfiguracja
-#define MOTOR_IN1_GPIO 12
-#define MOTOR_IN2_GPIO 13
-#define PWM_FREQ_HZ 5000
-#define PWM_DUTY 4095
-#define PWM_MODE LEDC_LOW_SPEED_MODE
-#define PWM_TIMER LEDC_TIMER_0
-#define PWM_CHANNEL_IN1 LEDC_CHANNEL_0
-#define PWM_CHANNEL_IN2 LEDC_CHANNEL_1
-
-// HTML strona do sterowania
-const char* html_page = "<!DOCTYPE html><html><body><h1>ESP32 Sterowanie Silnikiem</h1><button onclick=\"fetch('/activate')\">Uruchom Silnik</button></body></html>";
-
-// Event handler dla Wi-Fi
-static void event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
-{
-    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
-        esp_wifi_connect();
-    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        if (s_retry_num < EXAMPLE_ESP_MAXIMUM_RETRY) {
-            esp_wifi_connect();
-            s_retry_num++;
-            ESP_LOGI(TAG, "retry to connect to the AP");
-        } else {
-            xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
-        }
-        ESP_LOGI(TAG,"connect to the AP fail");
-    } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
-        ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
-        ESP_LOGI(TAG, "got ip:" IPSTR, IP2STR(&event->ip_info.ip));
-        s_retry_num = 0;
-        xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
-    }
-}
+#include "motor.h"
+#include "motor_hw.h"
+#include "motor_pwm.h"
+#include "motor_api.h"
+#include "http_pool.h"
+#include "ws_control.h"
+#include "telemetry.h"
+#include "web_ui.h"
+#include "link.h"
+#include "boot.h"
+#if CONFIG_MOTOR_WATCHDOG
+#include "motor_watchdog.h"
+#endif
 
-// Funkcja inicjująca Wi-Fi
-void wifi_init_sta(void)
-{
-    s_wifi_event_group = xEventGroupCreate();
-    ESP_ERROR_CHECK(esp_netif_init());
-    ESP_ERROR_CHECK(esp_event_loop_create_default());
-    esp_netif_create_default_wifi_sta();
-
-    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
-    ESP_ERROR_CHECK(esp_wifi_init(&cfg));
-
-    esp_event_handler_instance_t instance_any_id;
-    esp_event_handler_instance_t instance_got_ip;
-    ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &event_handler, NULL, &instance_any_id));
-    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &event_handler, NULL, &instance_got_ip));
-
-    wifi_config_t wifi_config = {
-        .sta = {
-            .ssid = EXAMPLE_ESP_WIFI_SSID,
-            .password = EXAMPLE_ESP_WIFI_PASS,
-            .threshold.authmode = WIFI_AUTH_WPA2_PSK,
-        },
-    };
-    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
-    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
-    ESP_ERROR_CHECK(esp_wifi_start());
+static const char *TAG = "main";
 
-    ESP_LOGI(TAG, "wifi_init_sta finished.");
+// Próby TCP keep-alive po CONFIG_HTTP_KEEP_ALIVE_IDLE_S bezczynności
+#define HTTP_KEEP_ALIVE_INTERVAL_S 5
+#define HTTP_KEEP_ALIVE_COUNT 3
 
-    EventBits_t bits = xEventGroupWaitBits(s_wifi_event_group, WIFI_CONNECTED_BIT | WIFI_FAIL_BIT, pdFALSE, pdFALSE, portMAX_DELAY);
+// Odczyt parametrów cyklu z zapytania:
+// ?ramp=none|linear|trapezoid|scurve&ramp_ms=N&phase_ms=N (wszystkie opcjonalne).
+// Przy błędzie wysyła 400 i zwraca false.
+static bool parse_cycle_cmd(httpd_req_t *req, motor_cmd_t *cmd) {
+    *cmd = (motor_cmd_t){
+        .type = MOTOR_CMD_CYCLE,
+        .duty = PWM_DUTY,
+        .phase_ms = MOTOR_PHASE_MS,
+        .ramp = MOTOR_RAMP_DEFAULT,
+        .ramp_ms = CONFIG_MOTOR_RAMP_MS
+    };
 
-    if (bits & WIFI_CONNECTED_BIT) {
-        ESP_LOGI(TAG, "connected to ap SSID:%s password:%s", EXAMPLE_ESP_WIFI_SSID, EXAMPLE_ESP_WIFI_PASS);
-    } else if (bits & WIFI_FAIL_BIT) {
-        ESP_LOGI(TAG, "Failed to connect to SSID:%s, password:%s", EXAMPLE_ESP_WIFI_SSID, EXAMPLE_ESP_WIFI_PASS);
-    } else {
-        ESP_LOGE(TAG, "UNEXPECTED EVENT");
+    char query[64];
+    char value[16];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "ramp", value, sizeof(value)) == ESP_OK) {
+            cmd->ramp = motor_ramp_from_name(value);
+            if (cmd->ramp == MOTOR_RAMP_MAX) {
+                httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Nieznany profil rampy");
+                return false;
+            }
+        }
+        char *end;
+        if (httpd_query_key_value(query, "ramp_ms", value, sizeof(value)) == ESP_OK) {
+            long ramp_ms = strtol(value, &end, 10);
+            if (end == value || *end != '\0' || ramp_ms < 0 || ramp_ms > MOTOR_PHASE_MS) {
+                httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Niepoprawny czas rampy");
+                return false;
+            }
+            cmd->ramp_ms = (uint16_t)ramp_ms;
+        }
+        if (httpd_query_key_value(query, "phase_ms", value, sizeof(value)) == ESP_OK) {
+            long phase_ms = strtol(value, &end, 10);
+            if (end == value || *end != '\0' || phase_ms <= 0 || phase_ms > MOTOR_PHASE_MS) {
+                httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Niepoprawny czas fazy");
+                return false;
+            }
+            cmd->phase_ms = (uint32_t)phase_ms;
+        }
     }
+    return true;
 }
 
-// Funkcja inicjująca PWM
-void pwm_init(void) {
-    ESP_LOGI(TAG, "Inicjalizacja PWM...");
-    
-    ledc_timer_config_t timer_conf = {
-        .speed_mode = PWM_MODE,
-        .duty_resolution = LEDC_TIMER_12_BIT,
-        .timer_num = PWM_TIMER,
-        .freq_hz = PWM_FREQ_HZ,
-        .clk_cfg = LEDC_AUTO_CLK
-    };
-    ESP_ERROR_CHECK(ledc_timer_config(&timer_conf));
-
-    ledc_channel_config_t channel_in1 = {
-        .gpio_num = MOTOR_IN1_GPIO,
-        .speed_mode = PWM_MODE,
-        .channel = PWM_CHANNEL_IN1,
-        .intr_type = LEDC_INTR_DISABLE,
-        .timer_sel = PWM_TIMER,
-        .duty = 0,
-        .hpoint = 0
+#if CONFIG_MOTOR_ENCODER
+// Odczyt parametrów ruchu do pozycji: ?pos=N[&duty=N][&timeout_ms=N].
+// Przy błędzie wysyła 400 i zwraca false.
+static bool parse_move_cmd(httpd_req_t *req, motor_cmd_t *cmd) {
+    *cmd = (motor_cmd_t){
+        .type = MOTOR_CMD_MOVE,
+        .duty = PWM_DUTY
     };
-    ESP_ERROR_CHECK(ledc_channel_config(&channel_in1));
-
-    ledc_channel_config_t channel_in2 = {
-        .gpio_num = MOTOR_IN2_GPIO,
-        .speed_mode = PWM_MODE,
-        .channel = PWM_CHANNEL_IN2,
-        .intr_type = LEDC_INTR_DISABLE,
-        .timer_sel = PWM_TIMER,
-        .duty = 0,
-        .hpoint = 0
-    };
-    ESP_ERROR_CHECK(ledc_channel_config(&channel_in2));
 
-    ESP_LOGI(TAG, "PWM skonfigurowane pomyślnie");
+    char query[64];
+    char value[16];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+        httpd_query_key_value(query, "pos", value, sizeof(value)) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Brak pozycji");
+        return false;
+    }
+    char *end;
+    long pos = strtol(value, &end, 10);
+    if (end == value || *end != '\0') {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Niepoprawna pozycja");
+        return false;
+    }
+    cmd->position = (int32_t)pos;
+
+    if (httpd_query_key_value(query, "duty", value, sizeof(value)) == ESP_OK) {
+        long duty = strtol(value, &end, 10);
+        if (end == value || *end != '\0' || duty <= 0 || duty > PWM_DUTY) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Niepoprawne wypełnienie");
+            return false;
+        }
+        cmd->duty = (uint32_t)duty;
+    }
+    if (httpd_query_key_value(query, "timeout_ms", value, sizeof(value)) == ESP_OK) {
+        long timeout_ms = strtol(value, &end, 10);
+        if (end == value || *end != '\0' || timeout_ms <= 0 || timeout_ms > 60000) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Niepoprawny limit czasu");
+            return false;
+        }
+        cmd->phase_ms = (uint32_t)timeout_ms;
+    }
+    return true;
 }
+#endif
+
+// Odpowiedź na wstawienie komendy: 202 albo 503 przy pełnej kolejce
+static esp_err_t motor_post_reply(httpd_req_t *req, esp_err_t err, const char *msg) {
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Kolejka silnika pełna");
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_send(req, "Silnik zajęty", HTTPD_RESP_USE_STRLEN);
+        return ESP_OK;
+    }
 
-// Funkcja obsługująca żądanie HTTP dla strony głównej
-esp_err_t root_get_handler(httpd_req_t *req) {
-    httpd_resp_send(req, html_page, HTTPD_RESP_USE_STRLEN);
+    httpd_resp_set_status(req, "202 Accepted");
+    httpd_resp_send(req, msg, HTTPD_RESP_USE_STRLEN);
     return ESP_OK;
 }
 
 // Funkcja obsługująca aktywację silnika przez HTTP
+// Handler tylko kolejkuje komendę - ruch wykonuje zadanie silnika.
+// Opcjonalnie: ?ramp=none|linear|trapezoid|scurve&ramp_ms=N&phase_ms=N
 esp_err_t activate_get_handler(httpd_req_t *req) {
-    ESP_LOGI(TAG, "Uruchomienie silnika");
-    
-    ledc_set_duty(PWM_MODE, PWM_CHANNEL_IN1, PWM_DUTY);  // Włącz IN1 (silnik)
-    ledc_set_duty(PWM_MODE, PWM_CHANNEL_IN2, 0);         // Wyłącz IN2
-    ledc_update_duty(PWM_MODE, PWM_CHANNEL_IN1);
-    ledc_update_duty(PWM_MODE, PWM_CHANNEL_IN2);
+    motor_cmd_t cmd;
+    if (!parse_cycle_cmd(req, &cmd)) {
+        return ESP_OK;
+    }
+    return motor_post_reply(req, motor_post(MOTOR_PRIMARY, &cmd), "Silnik uruchomiony");
+}
+
+#if CONFIG_MOTOR_ENCODER
+// Ruch do pozycji enkodera: /move?pos=N[&duty=N][&timeout_ms=N]
+// Silnik staje, gdy enkoder osiągnie cel; błąd zatrzymania w /stats.
+esp_err_t move_get_handler(httpd_req_t *req) {
+    motor_cmd_t cmd;
+    if (!parse_move_cmd(req, &cmd)) {
+        return ESP_OK;
+    }
+    return motor_post_reply(req, motor_post(MOTOR_PRIMARY, &cmd), "Ruch do pozycji");
+}
+#endif
+
+// Ruch skoordynowany: /motor/group?axes=<n>:<f|r>:<duty>,...&ms=N
+// Wszystkie osie ruszają i stają w tym samym okresie PWM (motor_post_group).
+static esp_err_t motor_group_handler(httpd_req_t *req) {
+    motor_group_cmd_t group = { 0 };
+    char query[128];
+    char axes[96];
+    char value[16];
+
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+        httpd_query_key_value(query, "axes", axes, sizeof(axes)) != ESP_OK ||
+        httpd_query_key_value(query, "ms", value, sizeof(value)) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Wymagane axes i ms");
+        return ESP_OK;
+    }
+    char *end;
+    long ms = strtol(value, &end, 10);
+    if (end == value || *end != '\0' || ms <= 0 || ms > MOTOR_PHASE_MS) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Niepoprawny czas ruchu");
+        return ESP_OK;
+    }
+    group.duration_ms = (uint32_t)ms;
+
+    char *save;
+    for (char *axis = strtok_r(axes, ",", &save); axis != NULL; axis = strtok_r(NULL, ",", &save)) {
+        // Każde z trzech pól niepuste: <n>:<f|r>:<duty>
+        long motor = strtol(axis, &end, 10);
+        bool ok = (end != axis && *end == ':');
+        char dir = ok ? end[1] : '\0';
+        ok = ok && (dir == 'f' || dir == 'r') && end[2] == ':';
+        long duty = -1;
+        if (ok) {
+            const char *duty_str = end + 3;
+            duty = strtol(duty_str, &end, 10);
+            ok = (end != duty_str && *end == '\0');
+        }
+        if (!ok || group.count == MOTOR_COUNT || motor < 0 || motor >= MOTOR_COUNT ||
+            duty < 0 || duty > PWM_DUTY) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Niepoprawna oś");
+            return ESP_OK;
+        }
+        group.axes[group.count++] = (motor_axis_t){
+            .motor = (uint8_t)motor,
+            .dir = (dir == 'f') ? MOTOR_DIR_FORWARD : MOTOR_DIR_REVERSE,
+            .duty = (uint32_t)duty
+        };
+    }
+
+    esp_err_t err = motor_post_group(&group);
+    if (err == ESP_ERR_INVALID_ARG) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Niepoprawne osie");
+        return ESP_OK;
+    }
+    if (err == ESP_ERR_INVALID_STATE) {
+        httpd_resp_set_status(req, "409 Conflict");
+        httpd_resp_send(req, "Ruch skoordynowany w toku albo oś zajęta", HTTPD_RESP_USE_STRLEN);
+        return ESP_OK;
+    }
+    return motor_post_reply(req, err, "Ruch skoordynowany");
+}
+
+// Trasy poszczególnych silników: /motor/<n>/<akcja> oraz /motor/all/<akcja>.
+// Akcje: activate (parametry jak /activate), stop, move (jak /move, tylko
+// silnik z enkoderem). Dla "all" komenda trafia do wszystkich silników
+// ze wspólną chwilą startu (motor_post_sync); /motor/group - ruch skoordynowany.
+esp_err_t motor_route_handler(httpd_req_t *req) {
+    const char *path = req->uri + strlen("/motor/");
+    if (strncmp(path, "group", 5) == 0 && (path[5] == '\0' || path[5] == '?')) {
+        return motor_group_handler(req);
+    }
+    const char *slash = strchr(path, '/');
+    if (slash == NULL) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Brak akcji");
+        return ESP_OK;
+    }
+
+    bool all = (slash - path == 3 && strncmp(path, "all", 3) == 0);
+    long motor = 0;
+    if (!all) {
+        char *end;
+        motor = strtol(path, &end, 10);
+        if (end != slash || end == path || motor < 0 || motor >= MOTOR_COUNT) {
+            httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Nieznany silnik");
+            return ESP_OK;
+        }
+    }
+
+    const char *action = slash + 1;
+    size_t action_len = strcspn(action, "?");
+    motor_cmd_t cmd;
+    if (action_len == 8 && strncmp(action, "activate", 8) == 0) {
+        if (!parse_cycle_cmd(req, &cmd)) {
+            return ESP_OK;
+        }
+    } else if (action_len == 4 && strncmp(action, "stop", 4) == 0) {
+        cmd = (motor_cmd_t){ .type = MOTOR_CMD_STOP };
+#if CONFIG_MOTOR_ENCODER
+    } else if (action_len == 4 && strncmp(action, "move", 4) == 0 && !all && motor == MOTOR_PRIMARY) {
+        if (!parse_move_cmd(req, &cmd)) {
+            return ESP_OK;
+        }
+#endif
+    } else {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Nieznana akcja");
+        return ESP_OK;
+    }
 
-    vTaskDelay(pdMS_TO_TICKS(3000)); // Silnik działa przez 3 sekundy
+    esp_err_t err = all ? motor_post_sync(MOTOR_MASK_ALL, &cmd) : motor_post(motor, &cmd);
+    return motor_post_reply(req, err, "Komenda przyjęta");
+}
 
-    // Cofanie
-    ledc_set_duty(PWM_MODE, PWM_CHANNEL_IN1, 0);
-    ledc_set_duty(PWM_MODE, PWM_CHANNEL_IN2, PWM_DUTY);
-    ledc_update_duty(PWM_MODE, PWM_CHANNEL_IN1);
-    ledc_update_duty(PWM_MODE, PWM_CHANNEL_IN2);
+// Częstotliwość PWM mostków: GET /pwm - bieżąca, /pwm?freq=N - zmiana
+// (zapamiętana w NVS). Odpowiedź: {"freq_hz":N,"bits":N}.
+static esp_err_t pwm_get_handler(httpd_req_t *req) {
+    char query[32];
+    char value[12];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "freq", value, sizeof(value)) == ESP_OK) {
+        char *end;
+        long freq = strtol(value, &end, 10);
+        esp_err_t err = (end == value || *end != '\0' || freq <= 0) ? ESP_ERR_INVALID_ARG
+                                                                     : motor_pwm_set_freq((uint32_t)freq);
+        if (err == ESP_ERR_INVALID_ARG) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Niepoprawna częstotliwość");
+            return ESP_OK;
+        }
+        if (err == ESP_ERR_INVALID_STATE) {
+            httpd_resp_set_status(req, "409 Conflict");
+            httpd_resp_send(req, "Rampa w toku", HTTPD_RESP_USE_STRLEN);
+            return ESP_OK;
+        }
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Zmiana częstotliwości PWM: %s", esp_err_to_name(err));
+        }
+    }
 
-    vTaskDelay(pdMS_TO_TICKS(3000)); // Silnik działa przez 3 sekundy
+    uint32_t freq_hz;
+    uint8_t bits;
+    motor_hw_get_pwm(&freq_hz, &bits);
+    char body[48];
+    int len = snprintf(body, sizeof(body), "{\"freq_hz\":%" PRIu32 ",\"bits\":%u}", freq_hz, bits);
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, body, len);
+}
 
-    httpd_resp_send(req, "Silnik uruchomiony", HTTPD_RESP_USE_STRLEN);
+// Otwarcie sesji HTTP - licznik połączeń w telemetrii
+static esp_err_t http_open_fn(httpd_handle_t hd, int sockfd) {
+    telemetry_session_opened(sockfd);
     return ESP_OK;
 }
 
+// Zamknięcie sesji HTTP (także wypchniętej przez LRU) - wyrejestrowanie
+// klientów strumieni i stop silników uruchomionych z tego gniazda
+static void http_close_fn(httpd_handle_t hd, int sockfd) {
+    telemetry_session_closed(sockfd);
+#if CONFIG_MOTOR_WATCHDOG
+    motor_watchdog_session_closed(sockfd);
+#endif
+    close(sockfd);
+}
+
+// httpd odrzuca konfigurację z większą liczbą sesji (gniazdo nasłuchu,
+// gniazdo sterujące i zapas)
+#if defined(CONFIG_LWIP_MAX_SOCKETS) && CONFIG_HTTP_MAX_OPEN_SOCKETS > CONFIG_LWIP_MAX_SOCKETS - 3
+#error "CONFIG_HTTP_MAX_OPEN_SOCKETS musi być mniejsze od CONFIG_LWIP_MAX_SOCKETS o co najmniej 3"
+#endif
+
 // Funkcja uruchamiająca serwer HTTP
 httpd_handle_t start_webserver(void) {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     httpd_handle_t server = NULL;
+
+    config.open_fn = http_open_fn;
+    config.close_fn = http_close_fn;
+    config.server_port = CONFIG_HTTP_SERVER_PORT;
+    // Przy komplecie sesji nowe połączenie zamyka najdawniej używane,
+    // zamiast zostać odrzucone (kilka telefonów i tablet naraz)
+    config.max_open_sockets = CONFIG_HTTP_MAX_OPEN_SOCKETS;
+    config.lru_purge_enable = true;
+    config.recv_wait_timeout = CONFIG_HTTP_RECV_TIMEOUT_S;
+    config.send_wait_timeout = CONFIG_HTTP_SEND_TIMEOUT_S;
+    // TCP keep-alive wykrywa klientów, którzy zniknęli bez zamknięcia połączenia
+    config.keep_alive_enable = CONFIG_HTTP_KEEP_ALIVE_IDLE_S > 0;
+    config.keep_alive_idle = CONFIG_HTTP_KEEP_ALIVE_IDLE_S;
+    config.keep_alive_interval = HTTP_KEEP_ALIVE_INTERVAL_S;
+    config.keep_alive_count = HTTP_KEEP_ALIVE_COUNT;
+    config.max_uri_handlers = 20;
+    // Trasy /motor/* - dokładne URI dopasowują się jak dotąd
+    config.uri_match_fn = httpd_uri_match_wildcard;
     
+    // Zadania puli przed trasami, które z niej korzystają
+    if (http_pool_init() != ESP_OK) {
+        ESP_LOGE(TAG, "Nie udało się uruchomić puli HTTP");
+        return NULL;
+    }
     if (httpd_start(&server, &config) == ESP_OK) {
-        httpd_uri_t root_uri = {
-            .uri       = "/",
-            .method    = HTTP_GET,
-            .handler   = root_get_handler
-        };
-        httpd_register_uri_handler(server, &root_uri);
+        // Interfejs WWW (gzip, ETag)
+        web_ui_register(server);
+
+        // Telemetria silnika i łącza (Server-Sent Events)
+        telemetry_register(server);
 
         httpd_uri_t activate_uri = {
             .uri       = "/activate",
@@ -186,29 +363,104 @@ httpd_handle_t start_webserver(void) {
             .handler   = activate_get_handler
         };
         httpd_register_uri_handler(server, &activate_uri);
+
+#if CONFIG_MOTOR_ENCODER
+        httpd_uri_t move_uri = {
+            .uri       = "/move",
+            .method    = HTTP_GET,
+            .handler   = move_get_handler
+        };
+        httpd_register_uri_handler(server, &move_uri);
+#endif
+
+        httpd_uri_t motor_uri = {
+            .uri       = "/motor/*",
+            .method    = HTTP_GET,
+            .handler   = motor_route_handler
+        };
+        httpd_register_uri_handler(server, &motor_uri);
+
+        httpd_uri_t pwm_uri = {
+            .uri       = "/pwm",
+            .method    = HTTP_GET,
+            .handler   = pwm_get_handler
+        };
+        // Zapis NVS blokuje na czas kasowania strony flash
+        http_pool_register(server, &pwm_uri);
+
+        // REST API w JSON (POST z ciałem)
+        motor_api_register(server);
+
+        // Trwałe połączenie do sterowania interaktywnego
+        ws_control_register(server);
+
+#if CONFIG_MOTOR_HW_SIM
+        // Zapis zmian wypełnienia z symulacji mostka (benchmarki)
+        motor_hw_sim_register(server);
+#endif
     }
     return server;
 }
 
-void app_main(void)
+// Inicjalizacja NVS
+static esp_err_t nvs_stage_init(void)
 {
-    // Inicjalizacja NVS
     esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
         ESP_ERROR_CHECK(nvs_flash_erase());
         ret = nvs_flash_init();
     }
-    ESP_ERROR_CHECK(ret);
+    return ret;
+}
 
-    ESP_LOGI(TAG, "ESP_WIFI_MODE_STA");
+// Inicjalizacja PWM (wypełnienie 0) i zadania silnika
+static esp_err_t motor_stage_init(void)
+{
+    pwm_init();
+    return motor_init();
+}
 
-    // Inicjalizacja Wi-Fi
-    wifi_init_sta();
+static esp_err_t http_stage_init(void)
+{
+    return start_webserver() ? ESP_OK : ESP_FAIL;
+}
 
-    // Inicjalizacja PWM
-    pwm_init();
+// Pierwsze uzyskanie adresu IP kończy etap startu; późniejsze
+// rozłączenia obsługuje już sam moduł łącza
+static void boot_link_cb(link_state_t state, void *arg)
+{
+    if (state == LINK_STATE_UP) {
+        boot_stage_done(BOOT_STAGE_IP);
+    }
+}
 
-    // Uruchomienie serwera HTTP
-    start_webserver();
+static esp_err_t wifi_stage_init(void)
+{
+    link_subscribe(boot_link_cb, NULL);
+    return link_start();
 }
 
+// Etapy startu wykonywane po kolei w app_main - tabela tylko ustala
+// kolejność: silnik jest bezpieczny od razu, a serwer HTTP nasłuchuje
+// przed uruchomieniem Wi-Fi. Równolegle trwa jedynie samo łączenie z AP
+// (zadanie sterownika Wi-Fi po esp_wifi_start), zakończone etapem "ip".
+// Handlery HTTP wstawiają komendy do kolejek silników i zapisują
+// częstotliwość PWM w NVS, więc serwer startuje po etapach motor i pwm.
+static const boot_stage_desc_t s_boot_stages[] = {
+    { BOOT_STAGE_MOTOR, motor_stage_init, 0 },
+    { BOOT_STAGE_NVS,   nvs_stage_init,   0 },
+    { BOOT_STAGE_PWM,   motor_pwm_restore, BOOT_DEP(BOOT_STAGE_NVS) | BOOT_DEP(BOOT_STAGE_MOTOR) },
+    { BOOT_STAGE_NETIF, link_netif_init,  0 },
+    { BOOT_STAGE_HTTP,  http_stage_init,  BOOT_DEP(BOOT_STAGE_NETIF) | BOOT_DEP(BOOT_STAGE_MOTOR) |
+                                          BOOT_DEP(BOOT_STAGE_PWM) },
+    { BOOT_STAGE_WIFI,  wifi_stage_init,  BOOT_DEP(BOOT_STAGE_NVS) | BOOT_DEP(BOOT_STAGE_NETIF) },
+};
+
+void app_main(void)
+{
+    ESP_LOGI(TAG, "ESP_WIFI_MODE_STA");
+
+    ESP_ERROR_CHECK(boot_run(s_boot_stages, sizeof(s_boot_stages) / sizeof(s_boot_stages[0])));
+    ESP_LOGI(TAG, "Serwer HTTP gotowy po %" PRId64 " ms od startu, Wi-Fi łączy się w tle",
+             esp_timer_get_time() / 1000);
+}
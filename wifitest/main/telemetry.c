@@ -0,0 +1,402 @@
+#include <stdio.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "motor.h"
+#include "link.h"
+#include "telemetry.h"
+#include "http_pool.h"
+#if CONFIG_MOTOR_ENCODER
+#include "motor_speed.h"
+#endif
+#if CONFIG_MOTOR_CURRENT_SENSE
+#include "current_sense.h"
+#endif
+#if CONFIG_MOTOR_WATCHDOG
+#include "motor_watchdog.h"
+#endif
+
+static const char *TAG = "telemetry";
+
+#define TELEMETRY_TASK_STACK 3072
+#define TELEMETRY_TASK_PRIO (tskIDLE_PRIORITY + 3)
+// Pola głównego silnika, łącza i serwera HTTP oraz ok. 110 znaków na silnik
+// w tablicy "motors"
+#define TELEMETRY_SAMPLE_MAX (1024 + 112 * MOTOR_COUNT)
+
+// Nagłówki wysyłane ręcznie - odpowiedź nigdy się nie kończy,
+// więc nie można użyć httpd_resp_send
+static const char s_sse_headers[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n";
+
+static httpd_handle_t s_server;
+static portMUX_TYPE s_clients_lock = portMUX_INITIALIZER_UNLOCKED;
+static int s_clients[CONFIG_TELEMETRY_MAX_CLIENTS];
+static int s_client_count;
+// Inne sesje długotrwałe (WebSocket) odświeżane w LRU jak klienci /events
+static int s_kept[CONFIG_HTTP_MAX_OPEN_SOCKETS];
+static int s_kept_count;
+// Sesje HTTP: otwarte teraz, najwięcej naraz i razem od startu
+static uint32_t s_sessions;
+static uint32_t s_sessions_max;
+static uint32_t s_sessions_total;
+
+// Jedna serializowana próbka współdzielona przez wszystkich klientów.
+// Producent nie nadpisuje jej, dopóki serwer jej nie rozesłał.
+static char s_sample[TELEMETRY_SAMPLE_MAX];
+static size_t s_sample_len;
+static volatile bool s_send_pending;
+static uint32_t s_sample_id;
+// Odpowiedź /stats - ponad 1 KB nie mieści się na stosie serwera HTTP
+// (4 KB). Trasa jest rejestrowana bez http_pool, więc bufor używa tylko
+// jedno zadanie serwera.
+static char s_stats_buf[TELEMETRY_SAMPLE_MAX];
+
+static bool telemetry_add_client(int fd)
+{
+    bool added = false;
+
+    portENTER_CRITICAL(&s_clients_lock);
+    for (int i = 0; i < CONFIG_TELEMETRY_MAX_CLIENTS; i++) {
+        if (s_clients[i] < 0) {
+            s_clients[i] = fd;
+            s_client_count++;
+            added = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_clients_lock);
+    return added;
+}
+
+static bool telemetry_remove_client(int fd)
+{
+    bool removed = false;
+
+    portENTER_CRITICAL(&s_clients_lock);
+    for (int i = 0; i < CONFIG_TELEMETRY_MAX_CLIENTS; i++) {
+        if (s_clients[i] == fd) {
+            s_clients[i] = -1;
+            s_client_count--;
+            removed = true;
+            break;
+        }
+    }
+    for (int i = 0; i < CONFIG_HTTP_MAX_OPEN_SOCKETS; i++) {
+        if (s_kept[i] == fd) {
+            s_kept[i] = -1;
+            s_kept_count--;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_clients_lock);
+    return removed;
+}
+
+void telemetry_keep_session(int sockfd)
+{
+    portENTER_CRITICAL(&s_clients_lock);
+    for (int i = 0; i < CONFIG_HTTP_MAX_OPEN_SOCKETS; i++) {
+        if (s_kept[i] == sockfd) {
+            break;
+        }
+        if (s_kept[i] < 0) {
+            s_kept[i] = sockfd;
+            s_kept_count++;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_clients_lock);
+}
+
+void telemetry_session_opened(int sockfd)
+{
+    portENTER_CRITICAL(&s_clients_lock);
+    s_sessions++;
+    s_sessions_total++;
+    if (s_sessions > s_sessions_max) {
+        s_sessions_max = s_sessions;
+    }
+    portEXIT_CRITICAL(&s_clients_lock);
+}
+
+void telemetry_session_closed(int sockfd)
+{
+    portENTER_CRITICAL(&s_clients_lock);
+    if (s_sessions > 0) {
+        s_sessions--;
+    }
+    portEXIT_CRITICAL(&s_clients_lock);
+    if (telemetry_remove_client(sockfd)) {
+        ESP_LOGI(TAG, "Klient telemetrii %d rozłączony", sockfd);
+    }
+}
+
+// Rozesłanie próbki - wykonywane w zadaniu serwera HTTP (httpd_queue_work).
+// Serwer liczy użycie sesji tylko przy odebranym żądaniu, więc strumień
+// bez ruchu od klienta byłby pierwszy do zamknięcia przez lru_purge_enable.
+// Co okres sesje /events i WebSocket dostają świeży licznik LRU, a przy
+// komplecie sesji zamykane są bezczynne połączenia keep-alive.
+// arg to s_sample, gdy producent przygotował próbkę, albo NULL.
+static void telemetry_fanout(void *arg)
+{
+    int fds[CONFIG_TELEMETRY_MAX_CLIENTS];
+    int kept[CONFIG_HTTP_MAX_OPEN_SOCKETS];
+
+    portENTER_CRITICAL(&s_clients_lock);
+    for (int i = 0; i < CONFIG_TELEMETRY_MAX_CLIENTS; i++) {
+        fds[i] = s_clients[i];
+    }
+    for (int i = 0; i < CONFIG_HTTP_MAX_OPEN_SOCKETS; i++) {
+        kept[i] = s_kept[i];
+    }
+    portEXIT_CRITICAL(&s_clients_lock);
+
+    for (int i = 0; i < CONFIG_TELEMETRY_MAX_CLIENTS && arg != NULL; i++) {
+        if (fds[i] < 0) {
+            continue;
+        }
+        if (httpd_socket_send(s_server, fds[i], s_sample, s_sample_len, 0) < 0) {
+            telemetry_remove_client(fds[i]);
+            httpd_sess_trigger_close(s_server, fds[i]);
+        } else {
+            httpd_sess_update_lru_counter(s_server, fds[i]);
+        }
+    }
+    for (int i = 0; i < CONFIG_HTTP_MAX_OPEN_SOCKETS; i++) {
+        if (kept[i] >= 0) {
+            httpd_sess_update_lru_counter(s_server, kept[i]);
+        }
+    }
+    s_send_pending = false;
+}
+
+// Bieżący stan silników, łącza i sterty jako obiekt JSON. Pola na
+// najwyższym poziomie opisują MOTOR_PRIMARY, tablica "motors" - wszystkie.
+static int telemetry_format_json(char *buf, size_t size)
+{
+    motor_state_t motor;
+    motor_get_state(MOTOR_PRIMARY, &motor);
+
+    int len = snprintf(buf, size,
+        "{\"duty_in1\":%" PRIu32 ",\"duty_in2\":%" PRIu32 ",\"dir\":\"%s\",\"phase\":\"%s\","
+        "\"queue_depth\":%" PRIu32 ",\"queue_coalesced\":%" PRIu32 ","
+        "\"queue_flushed\":%" PRIu32 ",\"queue_dropped\":%" PRIu32 ","
+        "\"link\":\"%s\",\"rssi\":%d,\"heap_free\":%" PRIu32 ",\"heap_min\":%" PRIu32,
+        motor.duty_in1, motor.duty_in2,
+        motor.dir == MOTOR_DIR_FORWARD ? "fwd" : "rev", motor_phase_name(motor.phase),
+        motor.queue_depth, motor.queue_coalesced, motor.queue_flushed, motor.queue_dropped,
+        link_state_name(link_get_state()), link_get_rssi(),
+        esp_get_free_heap_size(), esp_get_minimum_free_heap_size());
+    if (len < 0 || len >= (int)size) {
+        return len;
+    }
+
+    http_pool_stats_t pool;
+    http_pool_get_stats(&pool);
+    portENTER_CRITICAL(&s_clients_lock);
+    uint32_t sessions = s_sessions;
+    uint32_t sessions_max = s_sessions_max;
+    uint32_t sessions_total = s_sessions_total;
+    int events_clients = s_client_count;
+    portEXIT_CRITICAL(&s_clients_lock);
+    len += snprintf(buf + len, size - len,
+        ",\"http_workers\":%" PRIu32 ",\"http_busy\":%" PRIu32 ",\"http_queued\":%" PRIu32 ","
+        "\"http_handled\":%" PRIu32 ",\"http_rejected\":%" PRIu32 ","
+        "\"http_sessions\":%" PRIu32 ",\"http_sessions_max\":%" PRIu32 ",\"http_sessions_total\":%" PRIu32 ","
+        "\"events_clients\":%d",
+        pool.workers, pool.busy, pool.queued, pool.handled, pool.rejected,
+        sessions, sessions_max, sessions_total, events_clients);
+    if (len >= (int)size) {
+        return len;
+    }
+
+#if CONFIG_MOTOR_ENCODER
+    motor_speed_stats_t speed;
+    motor_speed_get_stats(&speed);
+    len += snprintf(buf + len, size - len,
+        ",\"speed_loop\":%s,\"rpm\":%" PRId32 ",\"target_rpm\":%" PRId32 ","
+        "\"loop_jitter_max_us\":%" PRIu32 ",\"loop_jitter_avg_us\":%" PRIu32 ",\"loop_overruns\":%" PRIu32 ","
+        "\"position\":%" PRId32 ",\"move_error\":%" PRId32,
+        speed.active ? "true" : "false", speed.rpm, speed.target_rpm,
+        speed.jitter_max_us, speed.jitter_avg_us, speed.overruns,
+        motor.position, motor.move_error);
+    if (len >= (int)size) {
+        return len;
+    }
+#endif
+
+#if CONFIG_MOTOR_CURRENT_SENSE
+    current_sense_stats_t sense;
+    current_sense_get_stats(&sense);
+    len += snprintf(buf + len, size - len,
+        ",\"current_ma\":%" PRIu32 ",\"stalls\":%" PRIu32 ","
+        "\"stall_latency_us\":%" PRIu32 ",\"stall_latency_max_us\":%" PRIu32,
+        sense.current_ma, sense.stalls, sense.latency_us, sense.latency_max_us);
+    if (len >= (int)size) {
+        return len;
+    }
+#endif
+
+#if CONFIG_MOTOR_WATCHDOG
+    motor_watchdog_stats_t watchdog;
+    motor_watchdog_get_stats(&watchdog);
+    len += snprintf(buf + len, size - len,
+        ",\"watchdog_ms\":%d,\"watchdog_armed\":%s,\"watchdog_trips\":%" PRIu32 ","
+        "\"watchdog_latency_us\":%" PRIu32 ",\"watchdog_latency_max_us\":%" PRIu32,
+        CONFIG_MOTOR_WATCHDOG_MS, watchdog.armed ? "true" : "false", watchdog.trips,
+        watchdog.latency_us, watchdog.latency_max_us);
+    if (len >= (int)size) {
+        return len;
+    }
+#endif
+
+#if MOTOR_COUNT > 1
+    motor_group_stats_t group;
+    motor_get_group_stats(&group);
+    len += snprintf(buf + len, size - len,
+        ",\"group_busy\":%s,\"group_done\":%" PRIu32 ",\"group_aborted\":%" PRIu32,
+        group.busy ? "true" : "false", group.done, group.aborted);
+    if (len >= (int)size) {
+        return len;
+    }
+
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+        motor_state_t m;
+        motor_get_state(i, &m);
+        len += snprintf(buf + len, size - len,
+            "%s{\"duty_in1\":%" PRIu32 ",\"duty_in2\":%" PRIu32 ",\"dir\":\"%s\",\"phase\":\"%s\","
+            "\"queue_depth\":%" PRIu32 ",\"queue_dropped\":%" PRIu32 "}",
+            i ? "," : ",\"motors\":[", m.duty_in1, m.duty_in2,
+            m.dir == MOTOR_DIR_FORWARD ? "fwd" : "rev", motor_phase_name(m.phase),
+            m.queue_depth, m.queue_dropped);
+        if (len >= (int)size) {
+            return len;
+        }
+    }
+    len += snprintf(buf + len, size - len, "]");
+    if (len >= (int)size) {
+        return len;
+    }
+#endif
+
+    len += snprintf(buf + len, size - len, "}");
+    return len;
+}
+
+static void telemetry_format_sample(void)
+{
+    int head = snprintf(s_sample, sizeof(s_sample), "id: %" PRIu32 "\ndata: ", ++s_sample_id);
+    int body = telemetry_format_json(s_sample + head, sizeof(s_sample) - head);
+    int len = head + body + 2;
+
+    if (body <= 0 || len >= (int)sizeof(s_sample)) {
+        s_sample_len = 0;
+        return;
+    }
+    s_sample[len - 2] = '\n';
+    s_sample[len - 1] = '\n';
+    s_sample_len = (size_t)len;
+}
+
+static void telemetry_task(void *arg)
+{
+    TickType_t last_wake = xTaskGetTickCount();
+
+    for (;;) {
+        xTaskDelayUntil(&last_wake, pdMS_TO_TICKS(CONFIG_TELEMETRY_PERIOD_MS));
+
+        // Brak sesji do obsłużenia albo poprzednia próbka jeszcze w drodze
+        if ((s_client_count == 0 && s_kept_count == 0) || s_send_pending) {
+            continue;
+        }
+
+        // Same sesje WebSocket - tylko odświeżenie LRU, bez próbki
+        char *sample = NULL;
+        if (s_client_count > 0) {
+            telemetry_format_sample();
+            if (s_sample_len == 0) {
+                continue;
+            }
+            sample = s_sample;
+        }
+        s_send_pending = true;
+        if (httpd_queue_work(s_server, telemetry_fanout, sample) != ESP_OK) {
+            s_send_pending = false;
+        }
+    }
+}
+
+static esp_err_t events_get_handler(httpd_req_t *req)
+{
+    int fd = httpd_req_to_sockfd(req);
+
+    if (!telemetry_add_client(fd)) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_send(req, "Za dużo klientów telemetrii", HTTPD_RESP_USE_STRLEN);
+        return ESP_OK;
+    }
+    if (httpd_send(req, s_sse_headers, sizeof(s_sse_headers) - 1) < 0) {
+        telemetry_remove_client(fd);
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "Nowy klient telemetrii %d", fd);
+    return ESP_OK;
+}
+
+// Pojedyncza próbka na żądanie - np. odczyt minimum sterty po teście obciążenia
+static esp_err_t stats_get_handler(httpd_req_t *req)
+{
+    int len = telemetry_format_json(s_stats_buf, sizeof(s_stats_buf));
+    if (len <= 0 || len >= (int)sizeof(s_stats_buf)) {
+        return httpd_resp_send_500(req);
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    return httpd_resp_send(req, s_stats_buf, len);
+}
+
+esp_err_t telemetry_register(httpd_handle_t server)
+{
+    s_server = server;
+    for (int i = 0; i < CONFIG_TELEMETRY_MAX_CLIENTS; i++) {
+        s_clients[i] = -1;
+    }
+    for (int i = 0; i < CONFIG_HTTP_MAX_OPEN_SOCKETS; i++) {
+        s_kept[i] = -1;
+    }
+
+    const httpd_uri_t events_uri = {
+        .uri       = "/events",
+        .method    = HTTP_GET,
+        .handler   = events_get_handler
+    };
+    esp_err_t err = httpd_register_uri_handler(server, &events_uri);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // W zadaniu serwera, nie w http_pool - s_stats_buf nie ma blokady
+    const httpd_uri_t stats_uri = {
+        .uri       = "/stats",
+        .method    = HTTP_GET,
+        .handler   = stats_get_handler
+    };
+    err = httpd_register_uri_handler(server, &stats_uri);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    if (xTaskCreate(telemetry_task, "telemetry", TELEMETRY_TASK_STACK, NULL, TELEMETRY_TASK_PRIO, NULL) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
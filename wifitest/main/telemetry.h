@@ -0,0 +1,22 @@
+#pragma once
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+// Strumień telemetrii Server-Sent Events (/events).
+// Jedno zadanie produkuje próbkę co CONFIG_TELEMETRY_PERIOD_MS,
+// serializuje ją raz i rozsyła do wszystkich podłączonych klientów.
+
+// Rejestracja endpointów /events i /stats (pojedyncza próbka JSON)
+// oraz uruchomienie zadania producenta
+esp_err_t telemetry_register(httpd_handle_t server);
+
+// Otwarcie i zamknięcie sesji HTTP (open_fn i close_fn serwera) - licznik
+// połączeń w telemetrii i wyrejestrowanie klientów strumienia
+void telemetry_session_opened(int sockfd);
+void telemetry_session_closed(int sockfd);
+
+// Sesja długotrwała spoza /events (WebSocket) - serwer odświeża jej
+// licznik LRU co okres telemetrii, więc przy komplecie sesji nie zostanie
+// zamknięta przed bezczynnymi połączeniami keep-alive
+void telemetry_keep_session(int sockfd);
@@ -0,0 +1,62 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "web_ui.h"
+
+static const char *TAG = "web_ui";
+
+// Plik skompresowany w czasie budowania (CMakeLists.txt)
+extern const uint8_t index_html_gz_start[] asm("_binary_index_html_gz_start");
+extern const uint8_t index_html_gz_end[] asm("_binary_index_html_gz_end");
+
+static size_t s_index_len;
+static char s_index_etag[12];   // "xxxxxxxx" w cudzysłowach
+
+// FNV-1a po skompresowanej treści - wystarcza jako silny ETag,
+// bo zmienia się przy każdej zmianie bajtów odpowiedzi
+static uint32_t web_ui_hash(const uint8_t *data, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Funkcja obsługująca żądanie HTTP dla strony głównej
+static esp_err_t root_get_handler(httpd_req_t *req)
+{
+    char if_none_match[sizeof(s_index_etag)];
+
+    httpd_resp_set_hdr(req, "ETag", s_index_etag);
+    // Przeglądarka zawsze rewaliduje - nowy firmware to nowy ETag
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) == ESP_OK &&
+        strcmp(if_none_match, s_index_etag) == 0) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    // Wszystkie obsługiwane przeglądarki akceptują gzip
+    httpd_resp_set_type(req, "text/html; charset=utf-8");
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    return httpd_resp_send(req, (const char *)index_html_gz_start, s_index_len);
+}
+
+esp_err_t web_ui_register(httpd_handle_t server)
+{
+    s_index_len = index_html_gz_end - index_html_gz_start;
+    snprintf(s_index_etag, sizeof(s_index_etag), "\"%08" PRIx32 "\"",
+             web_ui_hash(index_html_gz_start, s_index_len));
+    ESP_LOGI(TAG, "index.html.gz: %u B, ETag %s", (unsigned)s_index_len, s_index_etag);
+
+    const httpd_uri_t root_uri = {
+        .uri       = "/",
+        .method    = HTTP_GET,
+        .handler   = root_get_handler
+    };
+    return httpd_register_uri_handler(server, &root_uri);
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+// Interfejs WWW osadzony w firmware jako plik gzip (www/index.html).
+// Rejestruje "/" z nagłówkami ETag i obsługą 304 Not Modified.
+esp_err_t web_ui_register(httpd_handle_t server);
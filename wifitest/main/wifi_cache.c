@@ -0,0 +1,72 @@
+#include <string.h>
+#include "esp_log.h"
+#include "nvs.h"
+#include "wifi_cache.h"
+
+static const char *TAG = "wifi_cache";
+
+#define WIFI_CACHE_NAMESPACE "wifi_cache"
+#define WIFI_CACHE_KEY "last"
+
+esp_err_t wifi_cache_load(const char *ssid, wifi_cache_t *cache)
+{
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(WIFI_CACHE_NAMESPACE, NVS_READONLY, &nvs);
+    if (err != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    size_t len = sizeof(*cache);
+    err = nvs_get_blob(nvs, WIFI_CACHE_KEY, cache, &len);
+    nvs_close(nvs);
+
+    if (err != ESP_OK || len != sizeof(*cache)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    cache->ssid[sizeof(cache->ssid) - 1] = '\0';
+    if (strcmp(cache->ssid, ssid) != 0) {
+        ESP_LOGI(TAG, "Wpis dotyczy innej sieci (%s)", cache->ssid);
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t wifi_cache_save(const wifi_cache_t *cache)
+{
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(WIFI_CACHE_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // Zapis tylko przy zmianie - oszczędza flash przy każdym połączeniu
+    wifi_cache_t old;
+    size_t len = sizeof(old);
+    if (nvs_get_blob(nvs, WIFI_CACHE_KEY, &old, &len) == ESP_OK &&
+        len == sizeof(old) && memcmp(&old, cache, sizeof(old)) == 0) {
+        nvs_close(nvs);
+        return ESP_OK;
+    }
+
+    err = nvs_set_blob(nvs, WIFI_CACHE_KEY, cache, sizeof(*cache));
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    return err;
+}
+
+esp_err_t wifi_cache_clear(void)
+{
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(WIFI_CACHE_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = nvs_erase_key(nvs, WIFI_CACHE_KEY);
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    return err;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// Parametry ostatniego udanego połączenia przechowywane w NVS,
+// pozwalające pominąć skanowanie i DHCP przy kolejnym starcie
+typedef struct {
+    char ssid[33];          // sieć, dla której zapisano wpis
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint32_t ip;            // dzierżawa DHCP (kolejność sieciowa)
+    uint32_t netmask;
+    uint32_t gw;
+    uint32_t dns;
+} wifi_cache_t;
+
+// Odczyt wpisu. ESP_ERR_NOT_FOUND, gdy brak wpisu lub dotyczy innej sieci.
+esp_err_t wifi_cache_load(const char *ssid, wifi_cache_t *cache);
+
+esp_err_t wifi_cache_save(const wifi_cache_t *cache);
+
+// Usunięcie wpisu po nieudanym szybkim połączeniu
+esp_err_t wifi_cache_clear(void);
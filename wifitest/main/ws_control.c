@@ -0,0 +1,186 @@
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "esp_log.h"
+#include "motor.h"
+#include "ws_control.h"
+#include "telemetry.h"
+#if CONFIG_MOTOR_WATCHDOG
+#include "motor_watchdog.h"
+#endif
+
+static const char *TAG = "ws_control";
+
+// Najdłuższa poprawna ramka: op + seq + pos
+#define WS_FRAME_MAX 6
+
+static uint16_t ws_get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+#if CONFIG_MOTOR_ENCODER
+static int32_t ws_get_i32(const uint8_t *p)
+{
+    return (int32_t)((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+}
+#endif
+
+// Zamiana ramki sesji fd na komendę silnika i wstawienie jej do kolejki
+static uint8_t ws_control_dispatch(int fd, const uint8_t *buf, size_t len)
+{
+    if (len < 2) {
+        return WS_STATUS_BAD_FRAME;
+    }
+
+    motor_cmd_t cmd = {
+        .ramp = MOTOR_RAMP_DEFAULT,
+        .ramp_ms = CONFIG_MOTOR_RAMP_MS
+    };
+
+    switch (buf[0]) {
+    case WS_OP_START:
+        if (len != 5 || buf[2] > MOTOR_DIR_REVERSE) {
+            return WS_STATUS_BAD_FRAME;
+        }
+        cmd.type = MOTOR_CMD_RUN;
+        cmd.dir = (motor_dir_t)buf[2];
+        cmd.duty = ws_get_u16(&buf[3]);
+        break;
+    case WS_OP_STOP:
+        if (len != 2) {
+            return WS_STATUS_BAD_FRAME;
+        }
+        cmd.type = MOTOR_CMD_STOP;
+        break;
+    case WS_OP_SET_DUTY:
+        if (len != 4) {
+            return WS_STATUS_BAD_FRAME;
+        }
+        cmd.type = MOTOR_CMD_SET_DUTY;
+        cmd.duty = ws_get_u16(&buf[2]);
+        break;
+    case WS_OP_SET_DIR:
+        if (len != 3 || buf[2] > MOTOR_DIR_REVERSE) {
+            return WS_STATUS_BAD_FRAME;
+        }
+        cmd.type = MOTOR_CMD_SET_DIR;
+        cmd.dir = (motor_dir_t)buf[2];
+        break;
+    case WS_OP_SET_SPEED:
+        if (len != 5 || buf[2] > MOTOR_DIR_REVERSE) {
+            return WS_STATUS_BAD_FRAME;
+        }
+#if CONFIG_MOTOR_ENCODER
+        cmd.type = MOTOR_CMD_SPEED;
+        cmd.dir = (motor_dir_t)buf[2];
+        cmd.rpm = ws_get_u16(&buf[3]);
+        if (cmd.rpm > CONFIG_MOTOR_MAX_RPM) {
+            cmd.rpm = CONFIG_MOTOR_MAX_RPM;
+        }
+        break;
+#else
+        return WS_STATUS_UNSUPPORTED;
+#endif
+    case WS_OP_MOVE_TO:
+        if (len != 6) {
+            return WS_STATUS_BAD_FRAME;
+        }
+#if CONFIG_MOTOR_ENCODER
+        cmd.type = MOTOR_CMD_MOVE;
+        cmd.position = ws_get_i32(&buf[2]);
+        break;
+#else
+        return WS_STATUS_UNSUPPORTED;
+#endif
+    case WS_OP_HEARTBEAT:
+        if (len != 2) {
+            return WS_STATUS_BAD_FRAME;
+        }
+#if CONFIG_MOTOR_WATCHDOG
+        motor_watchdog_heartbeat(fd);
+        return WS_STATUS_OK;
+#else
+        return WS_STATUS_UNSUPPORTED;
+#endif
+    default:
+        return WS_STATUS_BAD_FRAME;
+    }
+
+    if (cmd.duty > PWM_DUTY) {
+        cmd.duty = PWM_DUTY;
+    }
+    if (motor_post_session(MOTOR_PRIMARY, &cmd, fd) != ESP_OK) {
+#if CONFIG_MOTOR_WATCHDOG
+        // Odrzucona komenda też dowodzi, że klient żyje
+        motor_watchdog_heartbeat(fd);
+#endif
+        return WS_STATUS_BUSY;
+    }
+    // Watchdog uzbraja dla tej sesji i rozbraja motor_post_session
+    return WS_STATUS_OK;
+}
+
+static esp_err_t ws_control_handler(httpd_req_t *req)
+{
+    if (req->method == HTTP_GET) {
+        // Handshake - potwierdzenia to małe ramki, Nagle tylko by je opóźniał
+        int fd = httpd_req_to_sockfd(req);
+        int nodelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+        // Przy komplecie sesji LRU zamyka ją dopiero po bezczynnych keep-alive
+        telemetry_keep_session(fd);
+        ESP_LOGI(TAG, "Nowe połączenie WebSocket");
+        return ESP_OK;
+    }
+
+    uint8_t buf[WS_FRAME_MAX] = { 0 };
+    httpd_ws_frame_t frame = {
+        .type = HTTPD_WS_TYPE_BINARY,
+        .payload = buf
+    };
+
+    // Najpierw sama długość, aby odrzucić za duże ramki bez czytania
+    esp_err_t err = httpd_ws_recv_frame(req, &frame, 0);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (frame.len > WS_FRAME_MAX) {
+        ESP_LOGW(TAG, "Za długa ramka (%u B)", (unsigned)frame.len);
+        return ESP_FAIL;
+    }
+    if (frame.len > 0) {
+        err = httpd_ws_recv_frame(req, &frame, WS_FRAME_MAX);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    if (frame.type != HTTPD_WS_TYPE_BINARY) {
+        return ESP_OK;
+    }
+
+    uint8_t ack[3] = {
+        buf[0] | WS_ACK_FLAG,
+        buf[1],
+        ws_control_dispatch(httpd_req_to_sockfd(req), buf, frame.len)
+    };
+    httpd_ws_frame_t resp = {
+        .final = true,
+        .type = HTTPD_WS_TYPE_BINARY,
+        .payload = ack,
+        .len = sizeof(ack)
+    };
+    return httpd_ws_send_frame(req, &resp);
+}
+
+esp_err_t ws_control_register(httpd_handle_t server)
+{
+    const httpd_uri_t ws_uri = {
+        .uri          = "/ws",
+        .method       = HTTP_GET,
+        .handler      = ws_control_handler,
+        .is_websocket = true
+    };
+    return httpd_register_uri_handler(server, &ws_uri);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+// Kanał sterowania silnikiem MOTOR_PRIMARY przez WebSocket (/ws).
+//
+// Ramki binarne, wartości wielobajtowe little endian:
+//   [op][seq][argumenty...]
+//   WS_OP_START    0x01  [dir u8][duty u16]
+//   WS_OP_STOP     0x02
+//   WS_OP_SET_DUTY 0x03  [duty u16]
+//   WS_OP_SET_DIR  0x04  [dir u8]
+//   WS_OP_SET_SPEED 0x05 [dir u8][rpm u16]  (CONFIG_MOTOR_ENCODER)
+//   WS_OP_MOVE_TO  0x06  [pos i32]          (CONFIG_MOTOR_ENCODER)
+//   WS_OP_HEARTBEAT 0x07                    (CONFIG_MOTOR_WATCHDOG)
+// Każda ramka dostaje potwierdzenie na tym samym gnieździe:
+//   [op | WS_ACK_FLAG][seq][status]
+// Z CONFIG_MOTOR_WATCHDOG komenda ruchu uzbraja watchdog łącza dla tego
+// połączenia, a STOP go rozbraja. Klient musi potem wysyłać ramki
+// (najprościej heartbeat) częściej niż co CONFIG_MOTOR_WATCHDOG_MS,
+// inaczej silnik staje; ramki innych połączeń się nie liczą, a zamknięcie
+// połączenia zatrzymuje silnik od razu.
+
+#define WS_OP_START     0x01
+#define WS_OP_STOP      0x02
+#define WS_OP_SET_DUTY  0x03
+#define WS_OP_SET_DIR   0x04
+#define WS_OP_SET_SPEED 0x05
+#define WS_OP_MOVE_TO   0x06
+#define WS_OP_HEARTBEAT 0x07
+
+#define WS_ACK_FLAG     0x80
+
+// Kody statusu w potwierdzeniu
+#define WS_STATUS_OK        0x00
+#define WS_STATUS_BUSY      0x01    // kolejka silnika pełna
+#define WS_STATUS_BAD_FRAME 0x02    // nieznana operacja lub zła długość
+#define WS_STATUS_UNSUPPORTED 0x03  // operacja wyłączona w konfiguracji
+
+// Rejestracja endpointu /ws na działającym serwerze
+esp_err_t ws_control_register(httpd_handle_t server);
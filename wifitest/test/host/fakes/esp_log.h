@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdio.h>
+
+// Logi tylko przy make V=1 (fake_log_enabled ustawia fake_rtos.c).
+// ESP_LOG w przerwaniu liczy fake_isr_check.
+extern int fake_log_enabled;
+void fake_isr_check(void);
+
+#define FAKE_LOG(level, tag, fmt, ...) \
+    do { \
+        fake_isr_check(); \
+        if (fake_log_enabled) fprintf(stderr, level " (%s) " fmt "\n", tag, ##__VA_ARGS__); \
+    } while (0)
+
+#define ESP_LOGE(tag, fmt, ...) FAKE_LOG("E", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) FAKE_LOG("W", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) FAKE_LOG("I", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) FAKE_LOG("D", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) FAKE_LOG("V", tag, fmt, ##__VA_ARGS__)
@@ -0,0 +1,63 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include "esp_adc/adc_continuous.h"
+#include "fake_adc.h"
+#include "fake_rtos.h"
+
+struct fake_adc {
+    adc_continuous_evt_cbs_t cbs;
+    void *user_data;
+    bool started;
+};
+
+static struct fake_adc s_adc;
+uint32_t fake_adc_sample_freq_hz;
+uint32_t fake_adc_frame_bytes;
+
+esp_err_t adc_continuous_new_handle(const adc_continuous_handle_cfg_t *cfg, adc_continuous_handle_t *ret)
+{
+    fake_adc_frame_bytes = cfg->conv_frame_size;
+    *ret = &s_adc;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_config(adc_continuous_handle_t handle, const adc_continuous_config_t *config)
+{
+    fake_adc_sample_freq_hz = config->sample_freq_hz;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_register_event_callbacks(adc_continuous_handle_t handle, const adc_continuous_evt_cbs_t *cbs, void *user_data)
+{
+    handle->cbs = *cbs;
+    handle->user_data = user_data;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_start(adc_continuous_handle_t handle)
+{
+    handle->started = true;
+    return ESP_OK;
+}
+
+bool fake_adc_frame(uint8_t channel, const uint16_t *raw, size_t n)
+{
+    if (!s_adc.started || s_adc.cbs.on_conv_done == NULL) {
+        return false;
+    }
+    adc_digi_output_data_t *buf = calloc(n, sizeof(*buf));
+    for (size_t i = 0; i < n; i++) {
+        buf[i].type1.channel = channel;
+        buf[i].type1.data = raw[i];
+    }
+    const adc_continuous_evt_data_t edata = {
+        .conv_frame_buffer = (uint8_t *)buf,
+        .size = (uint32_t)(n * SOC_ADC_DIGI_RESULT_BYTES)
+    };
+    bool outer = fake_in_isr;
+    fake_in_isr = true;
+    bool yield = s_adc.cbs.on_conv_done(&s_adc, &edata, s_adc.user_data);
+    fake_in_isr = outer;
+    free(buf);
+    return yield;
+}
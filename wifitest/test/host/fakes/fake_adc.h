@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Ramka DMA n próbek kanału channel o wartościach raw[] (0..4095) kończąca
+// się w bieżącej chwili zegara: on_conv_done w kontekście przerwania.
+// Zwraca wynik callbacku (przełączenie zadania).
+bool fake_adc_frame(uint8_t channel, const uint16_t *raw, size_t n);
+
+// Konfiguracja przekazana do sterownika
+extern uint32_t fake_adc_sample_freq_hz;
+extern uint32_t fake_adc_frame_bytes;
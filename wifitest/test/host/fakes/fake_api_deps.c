@@ -0,0 +1,67 @@
+// Zaślepki modułów, których motor_api.c potrzebuje do linkowania, a których
+// test nie sprawdza: zadania programów (motor_prog), procedury w NVS
+// (motor_routine) i pula zadań HTTP (trasy rejestrowane jak szybkie).
+
+#include "motor_prog.h"
+#include "motor_routine.h"
+#include "http_pool.h"
+
+esp_err_t motor_prog_submit(uint8_t motor, const motor_prog_t *prog, uint32_t *job_id)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t motor_prog_submit_routine(uint8_t motor, const motor_routine_t *routine, uint32_t *job_id)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t motor_prog_get_info(uint32_t job_id, motor_job_info_t *info)
+{
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t motor_prog_cancel(uint32_t job_id)
+{
+    return ESP_ERR_NOT_FOUND;
+}
+
+const char *motor_job_state_name(motor_job_state_t state)
+{
+    return "free";
+}
+
+esp_err_t motor_routine_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t motor_routine_validate(const motor_routine_t *routine, uint8_t motor, motor_routine_fault_t *fault)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t motor_routine_store(const char *name, const void *blob, size_t len, motor_routine_fault_t *fault)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t motor_routine_get(const char *name, motor_routine_t *routine)
+{
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t motor_routine_delete(const char *name)
+{
+    return ESP_ERR_NOT_FOUND;
+}
+
+bool motor_routine_name_valid(const char *name)
+{
+    return false;
+}
+
+esp_err_t http_pool_register(httpd_handle_t server, const httpd_uri_t *uri)
+{
+    return httpd_register_uri_handler(server, uri);
+}
@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fake_httpd.h"
+
+#define FAKE_HTTPD_ROUTES_MAX 32
+
+fake_httpd_response_t fake_httpd_response;
+
+static httpd_uri_t s_routes[FAKE_HTTPD_ROUTES_MAX];
+static size_t s_route_count;
+
+// Ciało bieżącego żądania
+static const char *s_body;
+static size_t s_body_left;
+static size_t s_chunk;
+// Gniazdo bieżącego żądania
+static int s_sockfd;
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri)
+{
+    if (s_route_count >= FAKE_HTTPD_ROUTES_MAX) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_routes[s_route_count++] = *uri;
+    return ESP_OK;
+}
+
+esp_err_t fake_httpd_request(int method, const char *uri, const char *body, size_t chunk)
+{
+    size_t path_len = strcspn(uri, "?");
+    for (size_t i = 0; i < s_route_count; i++) {
+        const httpd_uri_t *r = &s_routes[i];
+        if ((int)r->method != method || strlen(r->uri) != path_len || strncmp(r->uri, uri, path_len) != 0) {
+            continue;
+        }
+        httpd_req_t req = { .method = method, .content_len = body ? strlen(body) : 0, .user_ctx = r->user_ctx };
+        strncpy((char *)req.uri, uri, sizeof(req.uri) - 1);
+        s_body = body;
+        s_body_left = req.content_len;
+        s_chunk = chunk;
+        s_sockfd = 3;
+        memset(&fake_httpd_response, 0, sizeof(fake_httpd_response));
+        fake_httpd_response.status = 200;
+        return r->handler(&req);
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t fake_httpd_ws_frame(const char *uri, int sockfd, const uint8_t *payload, size_t len)
+{
+    for (size_t i = 0; i < s_route_count; i++) {
+        const httpd_uri_t *r = &s_routes[i];
+        if (!r->is_websocket || strcmp(r->uri, uri) != 0) {
+            continue;
+        }
+        // Po handshake serwer woła handler ramki z metodą 0, nie HTTP_GET
+        httpd_req_t req = { .method = 0, .user_ctx = r->user_ctx };
+        strncpy((char *)req.uri, uri, sizeof(req.uri) - 1);
+        s_body = (const char *)payload;
+        s_body_left = len;
+        s_chunk = 0;
+        s_sockfd = sockfd;
+        memset(&fake_httpd_response, 0, sizeof(fake_httpd_response));
+        fake_httpd_response.status = 200;
+        return r->handler(&req);
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+int httpd_req_recv(httpd_req_t *req, char *buf, size_t len)
+{
+    if (s_body_left == 0) {
+        return 0;
+    }
+    if (s_chunk && len > s_chunk) {
+        len = s_chunk;
+    }
+    if (len > s_body_left) {
+        len = s_body_left;
+    }
+    memcpy(buf, s_body, len);
+    s_body += len;
+    s_body_left -= len;
+    return (int)len;
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *req, char *buf, size_t len)
+{
+    const char *q = strchr(req->uri, '?');
+    if (q == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (strlen(q + 1) >= len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    strcpy(buf, q + 1);
+    return ESP_OK;
+}
+
+esp_err_t httpd_query_key_value(const char *query, const char *key, char *val, size_t len)
+{
+    size_t key_len = strlen(key);
+    const char *p = query;
+    while (p && *p) {
+        if (strncmp(p, key, key_len) == 0 && p[key_len] == '=') {
+            const char *v = p + key_len + 1;
+            size_t n = strcspn(v, "&");
+            if (n >= len) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            memcpy(val, v, n);
+            val[n] = '\0';
+            return ESP_OK;
+        }
+        p = strchr(p, '&');
+        p = p ? p + 1 : NULL;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *req, const char *status)
+{
+    fake_httpd_response.status = atoi(status);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *req, const char *type)
+{
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *req, const char *field, const char *value)
+{
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *req, const char *buf, ssize_t len)
+{
+    if (buf == NULL) {
+        return ESP_OK;
+    }
+    if (len == HTTPD_RESP_USE_STRLEN) {
+        len = (ssize_t)strlen(buf);
+    }
+    fake_httpd_response_t *r = &fake_httpd_response;
+    if (r->len + (size_t)len >= sizeof(r->body)) {
+        return ESP_FAIL;
+    }
+    memcpy(r->body + r->len, buf, (size_t)len);
+    r->len += (size_t)len;
+    r->body[r->len] = '\0';
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *req, const char *buf, ssize_t len)
+{
+    return httpd_resp_send_chunk(req, buf, len);
+}
+
+esp_err_t httpd_resp_send_500(httpd_req_t *req)
+{
+    fake_httpd_response.status = 500;
+    return ESP_OK;
+}
+
+int httpd_req_to_sockfd(httpd_req_t *req)
+{
+    return s_sockfd;
+}
+
+// Ramka binarna bez fragmentacji: max_len 0 podaje samą długość
+esp_err_t httpd_ws_recv_frame(httpd_req_t *req, httpd_ws_frame_t *pkt, size_t max_len)
+{
+    pkt->final = true;
+    pkt->type = HTTPD_WS_TYPE_BINARY;
+    pkt->len = s_body_left;
+    if (max_len == 0) {
+        return ESP_OK;
+    }
+    if (s_body_left > max_len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(pkt->payload, s_body, s_body_left);
+    s_body_left = 0;
+    return ESP_OK;
+}
+
+esp_err_t httpd_ws_send_frame(httpd_req_t *req, httpd_ws_frame_t *pkt)
+{
+    return httpd_resp_send_chunk(req, (const char *)pkt->payload, (ssize_t)pkt->len);
+}
+
+esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int sockfd)
+{
+    return ESP_OK;
+}
+
+// Bez puli (CONFIG_HTTP_WORKERS = 0) handlery nie kopiują żądań
+esp_err_t httpd_req_async_handler_begin(httpd_req_t *req, httpd_req_t **out)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t httpd_req_async_handler_complete(httpd_req_t *req)
+{
+    return ESP_OK;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_http_server.h"
+
+// Odpowiedź na ostatnie żądanie
+typedef struct {
+    int status;             // z httpd_resp_set_status, domyślnie 200
+    char body[2048];
+    size_t len;
+} fake_httpd_response_t;
+
+extern fake_httpd_response_t fake_httpd_response;
+
+// Żądanie method uri (z zapytaniem) z ciałem body podawanym przez
+// httpd_req_recv porcjami najwyżej chunk bajtów (0 - całe naraz).
+// Zwraca wynik handlera; ESP_ERR_NOT_FOUND, gdy trasy nie ma.
+esp_err_t fake_httpd_request(int method, const char *uri, const char *body, size_t chunk);
+
+// Binarna ramka WebSocket payload od klienta z gniazda sockfd do trasy
+// uri (is_websocket). Potwierdzenie z httpd_ws_send_frame trafia do
+// fake_httpd_response.body. Zwykłe żądania przychodzą z gniazda 3.
+esp_err_t fake_httpd_ws_frame(const char *uri, int sockfd, const uint8_t *payload, size_t len);
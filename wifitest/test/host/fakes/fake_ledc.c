@@ -0,0 +1,100 @@
+#include "fake_ledc.h"
+
+typedef struct {
+    uint32_t reg;           // ledc_set_duty
+    uint32_t duty;          // zatwierdzone
+    uint32_t fade_target;
+    bool stopped;           // ledc_stop - wyjście na poziomie 0
+} fake_ledc_channel_t;
+
+static fake_ledc_channel_t s_ch[LEDC_SPEED_MODE_MAX][LEDC_CHANNEL_MAX];
+uint32_t fake_ledc_bits;
+
+uint32_t fake_ledc_output(ledc_mode_t mode, ledc_channel_t channel)
+{
+    const fake_ledc_channel_t *c = &s_ch[mode][channel];
+    return c->stopped ? 0 : c->duty;
+}
+
+uint32_t ledc_find_suitable_duty_resolution(uint32_t src_clk_freq, uint32_t timer_freq)
+{
+    uint32_t bits = 0;
+    while (bits < 31 && (src_clk_freq / timer_freq) >> (bits + 1)) {
+        bits++;
+    }
+    return bits;
+}
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *timer_conf)
+{
+    fake_ledc_bits = (uint32_t)timer_conf->duty_resolution;
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_freq(ledc_mode_t speed_mode, ledc_timer_t timer_num, uint32_t freq_hz)
+{
+    return ESP_OK;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t *ledc_conf)
+{
+    s_ch[ledc_conf->speed_mode][ledc_conf->channel] = (fake_ledc_channel_t){
+        .reg = ledc_conf->duty, .duty = ledc_conf->duty
+    };
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t duty)
+{
+    s_ch[speed_mode][channel].reg = duty;
+    return ESP_OK;
+}
+
+// Jak w sprzęcie: zatwierdzenie włącza wyjście zatrzymane przez ledc_stop
+esp_err_t ledc_update_duty(ledc_mode_t speed_mode, ledc_channel_t channel)
+{
+    fake_ledc_channel_t *c = &s_ch[speed_mode][channel];
+    c->duty = c->reg;
+    c->stopped = false;
+    return ESP_OK;
+}
+
+uint32_t ledc_get_duty(ledc_mode_t speed_mode, ledc_channel_t channel)
+{
+    return s_ch[speed_mode][channel].duty;
+}
+
+esp_err_t ledc_stop(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t idle_level)
+{
+    s_ch[speed_mode][channel].stopped = true;
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_func_install(int intr_alloc_flags)
+{
+    return ESP_OK;
+}
+
+esp_err_t ledc_cb_register(ledc_mode_t speed_mode, ledc_channel_t channel, ledc_cbs_t *cbs, void *user_arg)
+{
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_fade_with_time(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t target_duty, int max_fade_time_ms)
+{
+    s_ch[speed_mode][channel].fade_target = target_duty;
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_start(ledc_mode_t speed_mode, ledc_channel_t channel, ledc_fade_mode_t fade_mode)
+{
+    fake_ledc_channel_t *c = &s_ch[speed_mode][channel];
+    c->reg = c->duty = c->fade_target;
+    c->stopped = false;
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_stop(ledc_mode_t speed_mode, ledc_channel_t channel)
+{
+    return ESP_OK;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stdint.h>
+#include "driver/ledc.h"
+
+// Wypełnienie na wyjściu kanału w jednostkach timera: wartość zatwierdzona
+// albo 0 po ledc_stop (do następnego ledc_update_duty lub zanikania)
+uint32_t fake_ledc_output(ledc_mode_t mode, ledc_channel_t channel);
+
+// Rozdzielczość timera z ostatniej konfiguracji
+extern uint32_t fake_ledc_bits;
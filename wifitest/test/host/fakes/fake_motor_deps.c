@@ -0,0 +1,28 @@
+// Zaślepki modułów, których motor.c potrzebuje do linkowania, a których
+// test nie sprawdza: regulator prędkości (motor_speed). Enkoder startuje
+// jak w motor_speed_init.
+
+#include "motor_speed.h"
+#include "encoder.h"
+
+esp_err_t motor_speed_init(motor_speed_out_t out)
+{
+    return encoder_init();
+}
+
+void motor_speed_start(uint32_t target_rpm, uint32_t start_duty)
+{
+}
+
+void motor_speed_set_target(uint32_t target_rpm)
+{
+}
+
+void motor_speed_stop(void)
+{
+}
+
+bool motor_speed_active(void)
+{
+    return false;
+}
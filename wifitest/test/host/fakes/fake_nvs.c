@@ -0,0 +1,83 @@
+#include <string.h>
+#include "nvs.h"
+
+#define FAKE_NVS_KEYS 8
+#define FAKE_NVS_KEY_MAX 16
+#define FAKE_NVS_BLOB_MAX 512
+
+typedef struct {
+    char key[FAKE_NVS_KEY_MAX];     // "" - wolny
+    size_t len;
+    uint8_t blob[FAKE_NVS_BLOB_MAX];
+} fake_nvs_entry_t;
+
+static fake_nvs_entry_t s_entries[FAKE_NVS_KEYS];
+
+static fake_nvs_entry_t *fake_nvs_find(const char *key)
+{
+    for (size_t i = 0; i < FAKE_NVS_KEYS; i++) {
+        if (strcmp(s_entries[i].key, key) == 0) {
+            return &s_entries[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t nvs_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    *out_handle = 1;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    if (strlen(key) >= FAKE_NVS_KEY_MAX || length > FAKE_NVS_BLOB_MAX) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    fake_nvs_entry_t *e = fake_nvs_find(key);
+    if (e == NULL) {
+        e = fake_nvs_find("");
+    }
+    if (e == NULL) {
+        return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+    }
+    strcpy(e->key, key);
+    memcpy(e->blob, value, length);
+    e->len = length;
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    const fake_nvs_entry_t *e = key[0] ? fake_nvs_find(key) : NULL;
+    if (e == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (out_value != NULL) {
+        if (*length < e->len) {
+            return ESP_ERR_NVS_INVALID_LENGTH;
+        }
+        memcpy(out_value, e->blob, e->len);
+    }
+    *length = e->len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    fake_nvs_entry_t *e = key[0] ? fake_nvs_find(key) : NULL;
+    if (e == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    e->key[0] = '\0';
+    return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+}
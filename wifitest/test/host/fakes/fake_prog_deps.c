@@ -0,0 +1,32 @@
+// Zaślepki programów ruchu z API (motor_prog) dla testów motor.c, które
+// ich nie sprawdzają; test_motor_prog linkuje prawdziwy motor_prog.c.
+
+#include "motor_prog.h"
+
+bool motor_prog_begin(uint32_t job_id, const motor_prog_step_t **steps, size_t *count)
+{
+    return false;
+}
+
+bool motor_prog_begin_routine(uint32_t job_id, const motor_routine_t **routine)
+{
+    return false;
+}
+
+bool motor_prog_step(uint32_t job_id, size_t step)
+{
+    return false;
+}
+
+void motor_prog_end(uint32_t job_id, bool completed)
+{
+}
+
+bool motor_prog_cancelled(uint32_t job_id)
+{
+    return false;
+}
+
+void motor_prog_dropped(uint32_t job_id)
+{
+}
@@ -0,0 +1,777 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "fake_rtos.h"
+
+#define FAKE_TIMERS_MAX 32
+#define FAKE_TASKS_MAX 16
+#define FAKE_OBJECTS_MAX 64
+#define FAKE_NEVER INT64_MAX
+// Stos hosta - kod firmware z -O1 i printf potrzebuje więcej niż na ESP32
+#define FAKE_TASK_STACK (256 * 1024)
+// Główne zadanie testu ma priorytet zadania serwera HTTP
+#define FAKE_MAIN_PRIO 5
+
+struct fake_timer {
+    esp_timer_create_args_t args;
+    int64_t deadline;       // FAKE_NEVER - nieaktywny
+    uint64_t period_us;     // 0 - jednorazowy
+};
+
+struct fake_task {
+    TaskFunction_t fn;
+    void *arg;
+    UBaseType_t prio;
+    uint32_t notify_value;
+    bool notify_pending;
+
+    // Oczekiwanie na grupę zdarzeń - spełniane w chwili ustawienia bitów
+    EventGroupHandle_t ev;
+    EventBits_t ev_bits;
+    bool ev_all;
+    bool ev_clear;
+    bool ev_done;
+    EventBits_t ev_result;
+
+    // Tryb z zadaniami (fake_tasks_start)
+    ucontext_t ctx;
+    void *stack;
+    bool started;
+    bool blocked;
+    bool (*ready)(void *);
+    void *ready_arg;
+    int64_t deadline;
+};
+
+struct fake_sem {
+    UBaseType_t count;
+    UBaseType_t max;
+};
+
+struct fake_event_group {
+    EventBits_t bits;
+};
+
+struct fake_queue {
+    uint8_t *items;
+    UBaseType_t length;
+    UBaseType_t size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+int fake_log_enabled;
+int fake_critical_depth;
+int64_t fake_wake_latency_us;
+bool fake_in_isr;
+int fake_isr_unsafe;
+int fake_critical_blocking;
+
+static struct fake_timer s_timers[FAKE_TIMERS_MAX];
+static size_t s_timer_count;
+static struct fake_task s_tasks[FAKE_TASKS_MAX] = { [0] = { .prio = FAKE_MAIN_PRIO, .started = true } };
+static size_t s_task_count = 1;     // 0 - główne zadanie testu
+static struct fake_task *s_current = &s_tasks[0];
+static struct fake_sem s_sems[FAKE_OBJECTS_MAX];
+static size_t s_sem_count;
+static struct fake_event_group s_groups[FAKE_OBJECTS_MAX];
+static size_t s_group_count;
+static int64_t s_now;
+static bool s_tasks_running;
+static int s_in_callback;           // callback timera w toku (dowolna metoda)
+
+__attribute__((constructor)) static void fake_rtos_env(void)
+{
+    fake_log_enabled = getenv("V") != NULL && getenv("V")[0] == '1';
+}
+
+void fake_rtos_reset(int64_t t_us)
+{
+    for (size_t i = 0; i < s_timer_count; i++) {
+        s_timers[i].deadline = FAKE_NEVER;
+    }
+    for (size_t i = 0; i < s_task_count; i++) {
+        s_tasks[i].notify_value = 0;
+        s_tasks[i].notify_pending = false;
+    }
+    s_now = t_us;
+    s_current = &s_tasks[0];
+    fake_wake_latency_us = 0;
+    fake_isr_unsafe = 0;
+    fake_critical_blocking = 0;
+}
+
+static struct fake_timer *fake_next_timer(void)
+{
+    struct fake_timer *next = NULL;
+    for (size_t i = 0; i < s_timer_count; i++) {
+        if (s_timers[i].deadline != FAKE_NEVER && (next == NULL || s_timers[i].deadline < next->deadline)) {
+            next = &s_timers[i];
+        }
+    }
+    return next;
+}
+
+void fake_clock_advance_to(int64_t t_us)
+{
+    struct fake_timer *t;
+    while ((t = fake_next_timer()) != NULL && t->deadline <= t_us) {
+        if (t->deadline > s_now) {
+            s_now = t->deadline;
+        }
+        t->deadline = t->period_us ? s_now + (int64_t)t->period_us : FAKE_NEVER;
+        bool outer = fake_in_isr;
+        fake_in_isr = (t->args.dispatch_method == ESP_TIMER_ISR);
+        s_in_callback++;
+        t->args.callback(t->args.arg);
+        s_in_callback--;
+        fake_in_isr = outer;
+    }
+    if (t_us > s_now) {
+        s_now = t_us;
+    }
+}
+
+// Zadania współbieżne: każde ma własny kontekst (ucontext) i oddaje
+// procesor tylko w wywołaniu blokującym albo gdy obudzi zadanie o wyższym
+// priorytecie. Kod między wywołaniami blokującymi nie zużywa czasu zegara.
+
+static bool fake_task_runnable(const struct fake_task *t)
+{
+    if (!t->started || t->fn == NULL) {
+        return t == &s_tasks[0];
+    }
+    return true;
+}
+
+static bool fake_task_ready(const struct fake_task *t)
+{
+    if (!t->blocked) {
+        return true;
+    }
+    return t->ready(t->ready_arg) || t->deadline <= s_now;
+}
+
+// Gotowe zadanie o najwyższym priorytecie (przy równych - pierwsze
+// utworzone) i priorytecie większym niż min_prio
+static struct fake_task *fake_pick(int min_prio)
+{
+    struct fake_task *best = NULL;
+    for (size_t i = 0; i < s_task_count; i++) {
+        struct fake_task *t = &s_tasks[i];
+        if (fake_task_runnable(t) && (int)t->prio > min_prio && fake_task_ready(t) &&
+            (best == NULL || t->prio > best->prio)) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+static void fake_switch_to(struct fake_task *next)
+{
+    if (next == s_current) {
+        return;
+    }
+    if (fake_critical_depth > 0) {
+        fake_critical_blocking++;
+    }
+    struct fake_task *prev = s_current;
+    s_current = next;
+    swapcontext(&prev->ctx, &next->ctx);
+}
+
+// Wybór zadania do uruchomienia, gdy bieżące czeka; bez gotowych zadań
+// zegar idzie do najbliższego timera albo limitu czasu oczekiwania
+static void fake_schedule(void)
+{
+    for (;;) {
+        struct fake_task *next = fake_pick(-1);
+        if (next != NULL) {
+            if (next->blocked && next->ready(next->ready_arg) && fake_wake_latency_us > 0) {
+                fake_clock_advance_to(s_now + fake_wake_latency_us);
+            }
+            fake_switch_to(next);
+            return;
+        }
+        int64_t t_us = FAKE_NEVER;
+        struct fake_timer *timer = fake_next_timer();
+        if (timer != NULL) {
+            t_us = timer->deadline;
+        }
+        for (size_t i = 0; i < s_task_count; i++) {
+            if (s_tasks[i].blocked && s_tasks[i].deadline < t_us) {
+                t_us = s_tasks[i].deadline;
+            }
+        }
+        if (t_us == FAKE_NEVER) {
+            fprintf(stderr, "fake_rtos: wszystkie zadania czekają bez końca (brak aktywnych timerów)\n");
+            abort();
+        }
+        fake_clock_advance_to(t_us);
+    }
+}
+
+// Po obudzeniu innego zadania: wyższy priorytet przejmuje procesor od razu
+static void fake_preempt(void)
+{
+    if (!s_tasks_running || s_in_callback || fake_in_isr) {
+        return;
+    }
+    struct fake_task *next = fake_pick((int)s_current->prio);
+    if (next != NULL) {
+        fake_switch_to(next);
+    }
+}
+
+static void fake_task_entry(void)
+{
+    struct fake_task *t = s_current;
+    t->fn(t->arg);
+    // Zadanie FreeRTOS nie może wrócić - tu tylko kończy udział w teście
+    t->fn = NULL;
+    t->blocked = false;
+    fake_schedule();
+    abort();
+}
+
+static void fake_task_prepare(struct fake_task *t)
+{
+    t->stack = malloc(FAKE_TASK_STACK);
+    if (t->stack == NULL) {
+        abort();
+    }
+    getcontext(&t->ctx);
+    t->ctx.uc_stack.ss_sp = t->stack;
+    t->ctx.uc_stack.ss_size = FAKE_TASK_STACK;
+    t->ctx.uc_link = NULL;
+    makecontext(&t->ctx, fake_task_entry, 0);
+    t->started = true;
+}
+
+void fake_tasks_start(void)
+{
+    s_tasks_running = true;
+    for (size_t i = 1; i < s_task_count; i++) {
+        if (!s_tasks[i].started) {
+            fake_task_prepare(&s_tasks[i]);
+        }
+    }
+    fake_preempt();
+}
+
+// Oczekiwanie bieżącego zadania do spełnienia ready() albo chwili limit_us.
+// Bez fake_tasks_start zegar idzie od timera do timera w bieżącym
+// kontekście, po spełnieniu warunku zadanie budzi się z opóźnieniem
+// fake_wake_latency_us.
+static bool fake_block_until(bool (*ready)(void *), void *arg, int64_t limit_us)
+{
+    if (ready(arg)) {
+        return true;
+    }
+    if (fake_in_isr) {
+        fake_isr_unsafe++;
+    }
+    if (fake_critical_depth > 0) {
+        fake_critical_blocking++;
+    }
+    if (limit_us <= s_now) {
+        return false;
+    }
+
+    if (s_tasks_running && !s_in_callback) {
+        struct fake_task *t = s_current;
+        t->ready = ready;
+        t->ready_arg = arg;
+        t->deadline = limit_us;
+        t->blocked = true;
+        while (!ready(arg) && s_now < limit_us) {
+            fake_schedule();
+        }
+        t->blocked = false;
+        return ready(arg);
+    }
+
+    struct fake_timer *t;
+    while (!ready(arg) && (t = fake_next_timer()) != NULL && t->deadline <= limit_us) {
+        fake_clock_advance_to(t->deadline);
+    }
+    if (!ready(arg)) {
+        if (limit_us == FAKE_NEVER) {
+            fprintf(stderr, "fake_rtos: zadanie czeka bez końca (brak aktywnych timerów)\n");
+            abort();
+        }
+        fake_clock_advance_to(limit_us);
+        return ready(arg);
+    }
+    fake_clock_advance_to(s_now + fake_wake_latency_us);
+    return true;
+}
+
+static bool fake_block(bool (*ready)(void *), void *arg, TickType_t timeout)
+{
+    if (timeout == 0) {
+        return ready(arg);
+    }
+    const int64_t limit = (timeout == portMAX_DELAY) ? FAKE_NEVER
+                        : s_now + (int64_t)timeout * portTICK_PERIOD_MS * 1000;
+    return fake_block_until(ready, arg, limit);
+}
+
+static bool fake_never(void *arg)
+{
+    return false;
+}
+
+void fake_sleep_us(int64_t us)
+{
+    fake_block_until(fake_never, NULL, s_now + us);
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    return code == ESP_OK ? "ESP_OK" : "ESP_ERR";
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out)
+{
+    if (s_timer_count >= FAKE_TIMERS_MAX) {
+        return ESP_ERR_NO_MEM;
+    }
+    struct fake_timer *t = &s_timers[s_timer_count++];
+    t->args = *args;
+    t->deadline = FAKE_NEVER;
+    *out = t;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    if (timer->deadline != FAKE_NEVER) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->deadline = s_now + (int64_t)timeout_us;
+    timer->period_us = 0;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us)
+{
+    if (timer->deadline != FAKE_NEVER) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->deadline = s_now + (int64_t)period_us;
+    timer->period_us = period_us;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (timer->deadline == FAKE_NEVER) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->deadline = FAKE_NEVER;
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer)
+{
+    return timer->deadline != FAKE_NEVER;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return s_now;
+}
+
+void esp_timer_isr_dispatch_need_yield(void)
+{
+}
+
+// Zadania
+
+// Wywołanie bez wariantu FromISR
+void fake_isr_check(void)
+{
+    if (fake_in_isr) {
+        fake_isr_unsafe++;
+    }
+}
+
+static TaskHandle_t fake_task_or_current(TaskHandle_t task)
+{
+    return task ? task : s_current;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg, UBaseType_t prio,
+                       TaskHandle_t *handle)
+{
+    if (s_task_count >= FAKE_TASKS_MAX) {
+        return pdFAIL;
+    }
+    struct fake_task *t = &s_tasks[s_task_count++];
+    t->fn = fn;
+    t->arg = arg;
+    t->prio = prio;
+    if (handle) {
+        *handle = t;
+    }
+    if (s_tasks_running) {
+        fake_task_prepare(t);
+        fake_preempt();
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t prio, TaskHandle_t *handle, BaseType_t core)
+{
+    return xTaskCreate(fn, name, stack, arg, prio, handle);
+}
+
+void fake_task_set_current(TaskHandle_t task)
+{
+    s_current = task ? task : &s_tasks[0];
+}
+
+uint32_t fake_task_notify_value(TaskHandle_t task)
+{
+    return fake_task_or_current(task)->notify_value;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return s_current;
+}
+
+static bool fake_notify_ready(void *arg)
+{
+    return ((struct fake_task *)arg)->notify_pending;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *value, TickType_t timeout)
+{
+    struct fake_task *t = s_current;
+    if (!t->notify_pending) {
+        t->notify_value &= ~clear_on_entry;
+    }
+    if (!fake_block(fake_notify_ready, t, timeout)) {
+        return pdFALSE;
+    }
+    if (value) {
+        *value = t->notify_value;
+    }
+    t->notify_value &= ~clear_on_exit;
+    t->notify_pending = false;
+    return pdTRUE;
+}
+
+static BaseType_t fake_notify(TaskHandle_t task, uint32_t value)
+{
+    struct fake_task *t = fake_task_or_current(task);
+    t->notify_value |= value;
+    t->notify_pending = true;
+    return pdPASS;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action)
+{
+    fake_isr_check();
+    fake_notify(task, value);
+    fake_preempt();
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action, BaseType_t *need_yield)
+{
+    if (need_yield) {
+        *need_yield = pdTRUE;
+    }
+    return fake_notify(task, value);
+}
+
+uint32_t ulTaskNotifyValueClear(TaskHandle_t task, uint32_t clear)
+{
+    struct fake_task *t = fake_task_or_current(task);
+    uint32_t value = t->notify_value;
+    t->notify_value &= ~clear;
+    return value;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(s_now / 1000 / portTICK_PERIOD_MS);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    if (fake_in_isr) {
+        fake_isr_unsafe++;
+    }
+    fake_block_until(fake_never, NULL, s_now + (int64_t)ticks * portTICK_PERIOD_MS * 1000);
+}
+
+void vTaskSetTimeOutState(TimeOut_t *timeout)
+{
+    timeout->t0_us = s_now;
+}
+
+BaseType_t xTaskCheckForTimeOut(TimeOut_t *timeout, TickType_t *ticks_left)
+{
+    if (*ticks_left == portMAX_DELAY) {
+        return pdFALSE;
+    }
+    const int64_t tick_us = portTICK_PERIOD_MS * 1000;
+    int64_t elapsed = (s_now - timeout->t0_us) / tick_us;
+    if (elapsed >= (int64_t)*ticks_left) {
+        *ticks_left = 0;
+        return pdTRUE;
+    }
+    *ticks_left -= (TickType_t)elapsed;
+    timeout->t0_us += elapsed * tick_us;
+    return pdFALSE;
+}
+
+// Semafory: zajęty mutex blokuje jak zwykły semafor (bez dziedziczenia
+// priorytetu); w jednym zadaniu to znaczy, że zajął go ten sam kod
+
+static SemaphoreHandle_t fake_sem_create(UBaseType_t max, UBaseType_t initial)
+{
+    if (s_sem_count >= FAKE_OBJECTS_MAX) {
+        return NULL;
+    }
+    struct fake_sem *s = &s_sems[s_sem_count++];
+    s->max = max;
+    s->count = initial;
+    return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return fake_sem_create(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return fake_sem_create(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial)
+{
+    return fake_sem_create(max, initial);
+}
+
+static bool fake_sem_ready(void *arg)
+{
+    return ((struct fake_sem *)arg)->count > 0;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t timeout)
+{
+    if (fake_in_isr) {
+        fake_isr_unsafe++;
+    }
+    if (!fake_block(fake_sem_ready, sem, timeout)) {
+        return pdFALSE;
+    }
+    sem->count--;
+    return pdTRUE;
+}
+
+static BaseType_t fake_sem_give(SemaphoreHandle_t sem)
+{
+    if (sem->count >= sem->max) {
+        return pdFALSE;
+    }
+    sem->count++;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    fake_isr_check();
+    BaseType_t ok = fake_sem_give(sem);
+    fake_preempt();
+    return ok;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *need_yield)
+{
+    if (need_yield) {
+        *need_yield = pdTRUE;
+    }
+    return fake_sem_give(sem);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t sem)
+{
+    return sem->count;
+}
+
+// Grupy zdarzeń: jak w FreeRTOS oczekiwanie jest spełniane w chwili
+// ustawienia bitów, a bity z clear czyszczone zaraz potem - bariera
+// xEventGroupSync zwalnia wszystkie zadania, choć bity już zniknęły
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    if (s_group_count >= FAKE_OBJECTS_MAX) {
+        return NULL;
+    }
+    return &s_groups[s_group_count++];
+}
+
+static bool fake_ev_match(EventBits_t bits, EventBits_t wait, bool all)
+{
+    return all ? (bits & wait) == wait : (bits & wait) != 0;
+}
+
+static void fake_ev_update(EventGroupHandle_t ev)
+{
+    EventBits_t clear = 0;
+    for (size_t i = 0; i < s_task_count; i++) {
+        struct fake_task *t = &s_tasks[i];
+        if (t->ev == ev && !t->ev_done && fake_ev_match(ev->bits, t->ev_bits, t->ev_all)) {
+            t->ev_done = true;
+            t->ev_result = ev->bits;
+            if (t->ev_clear) {
+                clear |= t->ev_bits;
+            }
+        }
+    }
+    ev->bits &= ~clear;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t ev, EventBits_t bits)
+{
+    fake_isr_check();
+    ev->bits |= bits;
+    EventBits_t result = ev->bits;
+    fake_ev_update(ev);
+    fake_preempt();
+    return result;
+}
+
+BaseType_t xEventGroupSetBitsFromISR(EventGroupHandle_t ev, EventBits_t bits, BaseType_t *need_yield)
+{
+    ev->bits |= bits;
+    fake_ev_update(ev);
+    if (need_yield) {
+        *need_yield = pdTRUE;
+    }
+    return pdPASS;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t ev, EventBits_t bits)
+{
+    EventBits_t before = ev->bits;
+    ev->bits &= ~bits;
+    return before;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t ev)
+{
+    return ev->bits;
+}
+
+static bool fake_ev_ready(void *arg)
+{
+    return ((struct fake_task *)arg)->ev_done;
+}
+
+static EventBits_t fake_ev_wait(EventGroupHandle_t ev, EventBits_t bits, bool clear, bool all, TickType_t timeout)
+{
+    struct fake_task *t = s_current;
+    t->ev = ev;
+    t->ev_bits = bits;
+    t->ev_all = all;
+    t->ev_clear = clear;
+    t->ev_done = false;
+    bool ok = fake_block(fake_ev_ready, t, timeout);
+    t->ev = NULL;
+    return ok ? t->ev_result : ev->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t ev, EventBits_t bits, BaseType_t clear, BaseType_t all,
+                                TickType_t timeout)
+{
+    EventBits_t result = ev->bits;
+    if (fake_ev_match(result, bits, all)) {
+        if (clear) {
+            ev->bits &= ~bits;
+        }
+        return result;
+    }
+    return fake_ev_wait(ev, bits, clear, all, timeout);
+}
+
+EventBits_t xEventGroupSync(EventGroupHandle_t ev, EventBits_t set, EventBits_t wait, TickType_t timeout)
+{
+    EventBits_t original = ev->bits;
+    ev->bits |= set;
+    fake_ev_update(ev);
+    if (((original | set) & wait) == wait) {
+        ev->bits &= ~wait;
+        fake_preempt();
+        return original | set;
+    }
+    return fake_ev_wait(ev, wait, true, true, timeout);
+}
+
+// Kolejki (pula HTTP)
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    struct fake_queue *q = calloc(1, sizeof(*q));
+    if (q == NULL) {
+        return NULL;
+    }
+    q->items = calloc(length, item_size);
+    q->length = length;
+    q->size = item_size;
+    return q;
+}
+
+static bool fake_queue_space(void *arg)
+{
+    const struct fake_queue *q = arg;
+    return q->count < q->length;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t timeout)
+{
+    if (!fake_block(fake_queue_space, q, timeout)) {
+        return pdFALSE;
+    }
+    memcpy(q->items + ((q->head + q->count) % q->length) * q->size, item, q->size);
+    q->count++;
+    fake_preempt();
+    return pdTRUE;
+}
+
+static bool fake_queue_ready(void *arg)
+{
+    return ((struct fake_queue *)arg)->count > 0;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t timeout)
+{
+    if (!fake_block(fake_queue_ready, q, timeout)) {
+        return pdFALSE;
+    }
+    memcpy(item, q->items + q->head * q->size, q->size);
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    return q->count;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Sterowanie symulacją z testu. Czas płynie tylko przez
+// fake_clock_advance_to i oczekiwania zadania (xTaskNotifyWait,
+// xSemaphoreTake, vTaskDelay...): zadanie czekające przesuwa zegar do
+// kolejnych timerów, aż warunek się spełni albo minie limit czasu.
+//
+// Bez fake_tasks_start utworzone zadania nie działają - test wykonuje
+// ich pracę sam po fake_task_set_current. Po fake_tasks_start działają
+// współbieżnie z testem (główne zadanie ma priorytet serwera HTTP):
+// wywłaszczenie tylko przy obudzeniu zadania o wyższym priorytecie,
+// a zegar idzie, gdy wszystkie zadania czekają.
+
+// Przesunięcie zegara do t_us z wywołaniem wszystkich timerów po drodze
+void fake_clock_advance_to(int64_t t_us);
+
+// Opóźnienie wybudzenia zadania po powiadomieniu (czas przełączenia kontekstu)
+extern int64_t fake_wake_latency_us;
+
+// true w callbacku timera ESP_TIMER_ISR
+extern bool fake_in_isr;
+
+// Wywołania niedozwolone w callbacku ESP_TIMER_ISR: blokujące
+// (xSemaphoreTake, oczekiwania zadania), bez wariantu FromISR
+// (xSemaphoreGive, xTaskNotify...) i ESP_LOG - w przerwaniu to błąd
+extern int fake_isr_unsafe;
+
+// Wywołania blokujące w sekcji krytycznej (portENTER_CRITICAL) - na
+// ESP32 to błąd, nawet gdy akurat nie blokują
+extern int fake_critical_blocking;
+
+// Uruchomienie utworzonych zadań (i tworzonych później)
+void fake_tasks_start(void);
+
+// Oczekiwanie głównego zadania testu przez us - w tym czasie działają
+// pozostałe zadania i timery
+void fake_sleep_us(int64_t us);
+
+// Zadanie, w imieniu którego test wykonuje kod (powiadomienia, oczekiwania).
+// NULL - główne zadanie testu.
+void fake_task_set_current(TaskHandle_t task);
+
+// Bieżąca wartość powiadomienia zadania (bez kasowania)
+uint32_t fake_task_notify_value(TaskHandle_t task);
+
+// Stan początkowy: zegar na t_us, bez aktywnych timerów i powiadomień
+void fake_rtos_reset(int64_t t_us);
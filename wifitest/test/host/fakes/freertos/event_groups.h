@@ -0,0 +1,16 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct fake_event_group *EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+
+EventGroupHandle_t xEventGroupCreate(void);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t ev, EventBits_t bits);
+// W FreeRTOS odłożone do zadania timerów - tutaj od razu
+BaseType_t xEventGroupSetBitsFromISR(EventGroupHandle_t ev, EventBits_t bits, BaseType_t *need_yield);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t ev, EventBits_t bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t ev);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t ev, EventBits_t bits, BaseType_t clear, BaseType_t all,
+                                TickType_t timeout);
+EventBits_t xEventGroupSync(EventGroupHandle_t ev, EventBits_t set, EventBits_t wait, TickType_t timeout);
@@ -0,0 +1,21 @@
+#pragma once
+
+// Konfiguracja testów na hoście - domyślne wartości Kconfig dla IDF_TARGET
+// linux (sdkconfig.defaults.linux). Test może nadpisać wartość przez -D
+// w Makefile.
+#ifndef CONFIG_MOTOR_COUNT
+#define CONFIG_MOTOR_COUNT 4
+#endif
+#define CONFIG_FREERTOS_HZ 100
+#define CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD 1
+
+#define CONFIG_MOTOR_HW_SIM 1
+#define CONFIG_MOTOR_PWM_FREQ_HZ 5000
+#define CONFIG_MOTOR_RAMP_MS 300
+#define CONFIG_MOTOR_RAMP_DEFAULT_TRAPEZOID 1
+#ifndef CONFIG_MOTOR_ENCODER
+#define CONFIG_MOTOR_ENCODER 1
+#endif
+#define CONFIG_ENCODER_CPR 1200
+#define CONFIG_MOTOR_MAX_RPM 3000
+#define CONFIG_MOTOR_PID_RATE_HZ 500
@@ -0,0 +1,22 @@
+#include "sim_trace.h"
+#include "test_host.h"
+
+motor_hw_sim_event_t trace_events[TRACE_MAX];
+
+uint32_t trace_mark(void)
+{
+    uint32_t since = 0;
+    size_t n;
+    while ((n = motor_hw_sim_trace(&since, trace_events, TRACE_MAX)) > 0) {
+        since = trace_events[n - 1].seq + 1;
+    }
+    return since;
+}
+
+size_t trace_since(uint32_t since)
+{
+    uint32_t from = since;
+    size_t n = motor_hw_sim_trace(&from, trace_events, TRACE_MAX);
+    CHECK_EQ(from, since);
+    return n;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "motor_hw.h"
+
+// Odczyt zapisów mostków z motor_hw_sim.c wspólny dla testów z zadaniami
+// silników: znacznik przed zdarzeniem i zapisy od niego do trace_events
+
+#define TRACE_MAX 64
+
+extern motor_hw_sim_event_t trace_events[TRACE_MAX];
+
+// Numer następnego zapisu symulacji mostków
+uint32_t trace_mark(void);
+
+// Zapisy od numeru since w trace_events, bez zgubionych przez
+// przepełnienie bufora symulacji; zwraca ich liczbę
+size_t trace_since(uint32_t since);
@@ -0,0 +1,6 @@
+#pragma once
+
+// Możliwości LEDC układu ESP32
+#define SOC_LEDC_SUPPORT_HS_MODE 1
+#define SOC_LEDC_CHANNEL_NUM 8
+#define SOC_LEDC_TIMER_BIT_WIDTH 20
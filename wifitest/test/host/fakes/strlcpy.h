@@ -0,0 +1,18 @@
+#pragma once
+// newlib z ESP-IDF ma strlcpy w <string.h>, glibc dopiero od 2.38;
+// dołączany przez -include tylko tam, gdzie moduł firmware go używa.
+
+#include <string.h>
+
+#if !defined(__GLIBC__) || __GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38)
+static inline size_t strlcpy(char *dst, const char *src, size_t size)
+{
+    const size_t len = strlen(src);
+    if (size) {
+        const size_t n = len < size ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+#endif
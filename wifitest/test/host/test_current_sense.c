@@ -0,0 +1,144 @@
+// Wykrywanie utyku w current_sense.c na ramkach DMA podawanych przez
+// fake_adc: próg po filtrze przez 1 ms, wygaszanie po włączeniu mostka,
+// krótkie szpilki, obce kanały i opóźnienie liczone od przekroczenia progu.
+
+#include "esp_timer.h"
+#include "esp_adc/adc_continuous.h"
+#include "current_sense.h"
+#include "fake_adc.h"
+#include "fake_rtos.h"
+#include "test_host.h"
+
+TEST_DEFINE_FAILURES;
+
+#define T_BOOT 1000000
+#define SAMPLE_US 50            // 20 kHz
+#define FRAME 32
+#define CHANNEL CONFIG_CURRENT_SENSE_ADC_CHANNEL
+#define BLANK_SAMPLES (CONFIG_MOTOR_STALL_BLANK_MS * 1000 / SAMPLE_US)
+#define HOLD_SAMPLES 20         // 1 ms
+
+// Progi w jednostkach ADC (12 dB, 3,1 V, 500 mV/A): 2 A to ok. 1320
+#define RAW_IDLE 300
+#define RAW_STALL 4000
+
+static int s_stalls;
+static int s_stalls_outside_isr;
+
+static bool on_stall(void *arg)
+{
+    s_stalls++;
+    if (!fake_in_isr) {
+        s_stalls_outside_isr++;
+    }
+    return true;
+}
+
+// n próbek wartości raw na kanale channel, ramkami po FRAME próbek;
+// zegar idzie o czas próbkowania ramki przed jej przerwaniem
+static void feed(uint8_t channel, uint16_t raw, size_t n)
+{
+    uint16_t buf[FRAME];
+    while (n > 0) {
+        size_t k = n < FRAME ? n : FRAME;
+        for (size_t i = 0; i < k; i++) {
+            buf[i] = raw;
+        }
+        fake_clock_advance_to(esp_timer_get_time() + (int64_t)k * SAMPLE_US);
+        fake_adc_frame(channel, buf, k);
+        n -= k;
+    }
+}
+
+// Mostek wyłączony: prąd ponad progiem nie jest utykiem
+static void test_not_driven(void)
+{
+    current_sense_set_driven(false);
+    feed(CHANNEL, RAW_STALL, 100 * FRAME);
+    CHECK_EQ(s_stalls, 0);
+    feed(CHANNEL, RAW_IDLE, 4 * FRAME);
+}
+
+// Prąd rozruchu w czasie wygaszania nie wyzwala, ten sam prąd po nim tak -
+// po 1 ms; opóźnienie liczone od pierwszej próbki ponad progiem
+static void test_blank_then_stall(void)
+{
+    current_sense_set_driven(true);
+    feed(CHANNEL, RAW_STALL, BLANK_SAMPLES);
+    CHECK_EQ(s_stalls, 0);
+
+    const int64_t over_us = esp_timer_get_time() + SAMPLE_US;
+    feed(CHANNEL, RAW_STALL, HOLD_SAMPLES - 1);
+    CHECK_EQ(s_stalls, 0);
+    feed(CHANNEL, RAW_STALL, 1);
+    CHECK_EQ(s_stalls, 1);
+    CHECK_EQ(s_stalls_outside_isr, 0);
+
+    // Do odcięcia drugi utyk nie jest zgłaszany
+    feed(CHANNEL, RAW_STALL, 10 * FRAME);
+    CHECK_EQ(s_stalls, 1);
+
+    fake_clock_advance_to(esp_timer_get_time() + 300);
+    const int64_t cut_us = esp_timer_get_time();
+    CHECK(current_sense_stall_cut());
+    CHECK(!current_sense_stall_cut());
+    current_sense_set_driven(false);
+
+    current_sense_stats_t stats;
+    current_sense_get_stats(&stats);
+    CHECK_EQ(stats.stalls, 1);
+    CHECK_EQ(stats.latency_us, cut_us - over_us);
+    CHECK_EQ(stats.latency_max_us, stats.latency_us);
+    CHECK(stats.current_ma > CONFIG_MOTOR_STALL_CURRENT_MA);
+    feed(CHANNEL, RAW_IDLE, 4 * FRAME);
+}
+
+// Szpilki 0,4 ms co ramkę po wygaszaniu - filtr i próg czasu je odrzucają.
+// Próbki innego kanału są pomijane.
+static void test_spikes_and_other_channel(void)
+{
+    current_sense_set_driven(true);
+    feed(CHANNEL, RAW_IDLE, BLANK_SAMPLES);
+    for (int i = 0; i < 200; i++) {
+        feed(CHANNEL, RAW_STALL, 8);
+        feed(CHANNEL, RAW_IDLE, FRAME - 8);
+    }
+    CHECK_EQ(s_stalls, 1);
+
+    feed(CHANNEL + 1, RAW_STALL, 100 * FRAME);
+    CHECK_EQ(s_stalls, 1);
+    current_sense_stats_t stats;
+    current_sense_get_stats(&stats);
+    CHECK(stats.current_ma < CONFIG_MOTOR_STALL_CURRENT_MA);
+    current_sense_set_driven(false);
+}
+
+// Ponowne włączenie mostka znów wygasza detekcję, a kolejny utyk jest zgłaszany
+static void test_rearm(void)
+{
+    current_sense_set_driven(true);
+    feed(CHANNEL, RAW_STALL, BLANK_SAMPLES);
+    CHECK_EQ(s_stalls, 1);
+    feed(CHANNEL, RAW_STALL, HOLD_SAMPLES);
+    CHECK_EQ(s_stalls, 2);
+    CHECK(current_sense_stall_cut());
+    current_sense_set_driven(false);
+
+    current_sense_stats_t stats;
+    current_sense_get_stats(&stats);
+    CHECK_EQ(stats.stalls, 2);
+}
+
+int main(void)
+{
+    fake_rtos_reset(T_BOOT);
+    CHECK_EQ(current_sense_init(on_stall, NULL), ESP_OK);
+    CHECK_EQ(fake_adc_sample_freq_hz, 1000000 / SAMPLE_US);
+    CHECK_EQ(fake_adc_frame_bytes, FRAME * SOC_ADC_DIGI_RESULT_BYTES);
+
+    test_not_driven();
+    test_blank_then_stall();
+    test_spikes_and_other_channel();
+    test_rearm();
+    TEST_MAIN_END("test_current_sense");
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+// Minimalne asercje testów na hoście: błąd wypisuje miejsce i wartości,
+// test kończy się kodem 1 po wszystkich sprawdzeniach
+extern int test_failures;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s)\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(a, b) do { \
+        int64_t a_ = (int64_t)(a), b_ = (int64_t)(b); \
+        if (a_ != b_) { \
+            fprintf(stderr, "%s:%d: %s == %s (%" PRId64 " != %" PRId64 ")\n", \
+                    __FILE__, __LINE__, #a, #b, a_, b_); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define TEST_MAIN_END(name) do { \
+        if (test_failures) { \
+            fprintf(stderr, "%s: %d błędów\n", name, test_failures); \
+            return 1; \
+        } \
+        printf("%s: OK\n", name); \
+        return 0; \
+    } while (0)
+
+#define TEST_DEFINE_FAILURES int test_failures
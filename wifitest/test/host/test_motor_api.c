@@ -0,0 +1,133 @@
+// POST /api/v1/motor (motor_api.c z json_scan.c) przez fake_httpd
+// z zadaniami silników na fake_rtos: po rozgrzewce N żądań z ciałem
+// podawanym w różnych kawałkach, ze złym JSON i z GET nie wywołuje ani
+// jednej alokacji na stercie - ani w handlerze, ani w zadaniach silników.
+
+#include <string.h>
+#include "motor.c"
+#include "motor_api.h"
+#include "fake_httpd.h"
+#include "fake_rtos.h"
+#include "test_host.h"
+
+TEST_DEFINE_FAILURES;
+
+#define T_BOOT 1000000
+#define REQUESTS 200
+
+// Wszystkie alokacje procesu (także z libc, np. stdio) przechodzą tędy;
+// glibc pozwala podmienić malloc i udostępnia swoje wersje jako __libc_*
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *p, size_t size);
+extern void __libc_free(void *p);
+
+static volatile bool s_counting;
+static volatile unsigned s_allocs;
+
+void *malloc(size_t size)
+{
+    if (s_counting) {
+        s_allocs++;
+    }
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+    if (s_counting) {
+        s_allocs++;
+    }
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *p, size_t size)
+{
+    if (s_counting) {
+        s_allocs++;
+    }
+    return __libc_realloc(p, size);
+}
+
+void free(void *p)
+{
+    __libc_free(p);
+}
+
+typedef struct {
+    int method;
+    const char *uri;
+    const char *body;
+    int status;
+} api_case_t;
+
+static const api_case_t s_cases[] = {
+    { HTTP_POST, "/api/v1/motor", "{\"dir\":\"fwd\",\"duty\":4095}", 202 },
+    { HTTP_POST, "/api/v1/motor",
+      "{\"motor\":1,\"dir\":\"rev\",\"duty\":2048,\"duration_ms\":20,\"ramp\":\"scurve\",\"ramp_ms\":10}", 202 },
+    { HTTP_POST, "/api/v1/motor", "{ \"motor\" : 2 , \"ramp\" : \"linear\" , \"ramp_ms\" : 5 }", 202 },
+    { HTTP_POST, "/api/v1/motor", "{\"motor\":3,\"duration_ms\":10,\"ramp\":\"none\"}", 202 },
+    { HTTP_POST, "/api/v1/motor", "{\"dir\":\"up\"}", 400 },
+    { HTTP_POST, "/api/v1/motor", "{\"duty\":4095", 400 },
+    { HTTP_POST, "/api/v1/motor", "[1,2]", 400 },
+    { HTTP_GET, "/api/v1/motor?motor=1", NULL, 200 },
+};
+
+#define CASE_COUNT (sizeof(s_cases) / sizeof(s_cases[0]))
+
+// Kawałki ciała: całe naraz, po bajcie i przez granice tokenów
+static const size_t s_chunks[] = { 0, 1, 7, 64 };
+
+static void api_request(size_t i)
+{
+    const api_case_t *c = &s_cases[i % CASE_COUNT];
+    const size_t chunk = s_chunks[(i / CASE_COUNT) % (sizeof(s_chunks) / sizeof(s_chunks[0]))];
+    CHECK_EQ(fake_httpd_request(c->method, c->uri, c->body, chunk), ESP_OK);
+    CHECK_EQ(fake_httpd_response.status, c->status);
+    // Zadania silników wykonują komendę między żądaniami
+    fake_sleep_us(30000);
+}
+
+static void test_steady_state_no_alloc(void)
+{
+    // Rozgrzewka: każdy przypadek z każdym podziałem ciała
+    for (size_t i = 0; i < CASE_COUNT * 4; i++) {
+        api_request(i);
+    }
+
+    s_allocs = 0;
+    s_counting = true;
+    for (size_t i = 0; i < REQUESTS; i++) {
+        api_request(i);
+    }
+    s_counting = false;
+    CHECK_EQ(s_allocs, 0);
+}
+
+// Żądanie dociera do silnika, a odpowiedź 202 opisuje przyjętą komendę
+static void test_post_reaches_motor(void)
+{
+    CHECK_EQ(fake_httpd_request(HTTP_POST, "/api/v1/motor",
+                                "{\"motor\":2,\"dir\":\"rev\",\"duty\":1000,\"ramp\":\"none\"}", 5), ESP_OK);
+    CHECK_EQ(fake_httpd_response.status, 202);
+    CHECK(strstr(fake_httpd_response.body, "\"motor\":2,\"dir\":\"rev\",\"duty\":1000") != NULL);
+    fake_sleep_us(1000);
+    CHECK_EQ(motor_hw_get_duty(2, MOTOR_HW_IN2), 1000);
+
+    CHECK_EQ(fake_httpd_request(HTTP_GET, "/api/v1/motor?motor=2", NULL, 0), ESP_OK);
+    CHECK(strstr(fake_httpd_response.body, "\"duty_in2\":1000") != NULL);
+}
+
+int main(void)
+{
+    fake_rtos_reset(T_BOOT);
+    pwm_init();
+    CHECK_EQ(motor_init(), ESP_OK);
+    CHECK_EQ(motor_api_register(NULL), ESP_OK);
+    fake_tasks_start();
+
+    test_steady_state_no_alloc();
+    test_post_reaches_motor();
+    CHECK_EQ(fake_critical_blocking, 0);
+    TEST_MAIN_END("test_motor_api");
+}
@@ -0,0 +1,180 @@
+// Ruch skoordynowany (motor_post_group) z zadaniami silników działającymi
+// na fake_rtos: zbocza wszystkich osi w jednej chwili mimo opóźnienia
+// wybudzania zadań, odmowa przy zajętej osi zamiast cichego porzucenia
+// i przerwanie ruchu przez STOP przed barierą i w trakcie ruchu.
+
+#include "motor.c"
+#include "fake_rtos.h"
+#include "test_host.h"
+#include "sim_trace.h"
+
+TEST_DEFINE_FAILURES;
+
+#define T_BOOT 1000000
+
+static void check_group_stats(uint32_t done, uint32_t aborted)
+{
+    motor_group_stats_t stats;
+    motor_get_group_stats(&stats);
+    CHECK(!stats.busy);
+    CHECK_EQ(stats.done, done);
+    CHECK_EQ(stats.aborted, aborted);
+}
+
+static void check_all_off(void)
+{
+    for (uint8_t i = 0; i < MOTOR_COUNT; i++) {
+        CHECK_EQ(motor_hw_get_duty(i, MOTOR_HW_IN1), 0);
+        CHECK_EQ(motor_hw_get_duty(i, MOTOR_HW_IN2), 0);
+    }
+}
+
+static const motor_group_cmd_t s_four_axes = {
+    .duration_ms = 300,
+    .count = 4,
+    .axes = {
+        { .motor = 0, .dir = MOTOR_DIR_FORWARD, .duty = 4095 },
+        { .motor = 1, .dir = MOTOR_DIR_REVERSE, .duty = 2048 },
+        { .motor = 2, .dir = MOTOR_DIR_FORWARD, .duty = 1000 },
+        { .motor = 3, .dir = MOTOR_DIR_REVERSE, .duty = 3000 },
+    },
+};
+
+// Zadania osi budzą się WAKE_US po zdarzeniu, a wszystkie zbocza startu
+// i końca i tak mają jeden znacznik czasu - zapisuje je prowadzący
+#define WAKE_US 30
+
+static void test_edges_in_one_instant(void)
+{
+    fake_wake_latency_us = WAKE_US;
+    const uint32_t mark = trace_mark();
+    const int64_t t_post = esp_timer_get_time();
+    CHECK_EQ(motor_post_group(&s_four_axes), ESP_OK);
+    fake_sleep_us(500000);
+    fake_wake_latency_us = 0;
+
+    const size_t n = trace_since(mark);
+    CHECK_EQ(n, 4 * 2 * MOTOR_HW_CH_MAX);
+    if (n != 4 * 2 * MOTOR_HW_CH_MAX) {
+        return;
+    }
+    const int64_t t_on = trace_events[0].t_us;
+    const int64_t t_off = trace_events[n - 1].t_us;
+    for (size_t i = 0; i < n / 2; i++) {
+        const motor_hw_sim_event_t *on = &trace_events[i];
+        const motor_hw_sim_event_t *off = &trace_events[n / 2 + i];
+        const motor_axis_t *a = &s_four_axes.axes[i / MOTOR_HW_CH_MAX];
+        const bool drives = (on->ch == MOTOR_HW_IN1) == (a->dir == MOTOR_DIR_FORWARD);
+        CHECK_EQ(on->t_us, t_on);
+        CHECK_EQ(off->t_us, t_off);
+        CHECK_EQ(on->motor, a->motor);
+        CHECK_EQ(on->duty, drives ? a->duty : 0);
+        CHECK_EQ(off->duty, 0);
+    }
+    // Koniec wyznacza granica sekwencera - prowadzący budzi się po niej
+    CHECK_EQ(t_off - t_on, s_four_axes.duration_ms * 1000 + WAKE_US);
+    CHECK(t_on - t_post < 1000);
+    check_group_stats(1, 0);
+}
+
+// Oś w trakcie PULSE: ruch odrzucony od razu (409 w HTTP), nie po limicie
+// bariery; po końcu PULSE przyjęty. Drugi ruch w czasie pierwszego też
+// jest odrzucany.
+static void test_busy_axis_rejected(void)
+{
+    const motor_cmd_t pulse = {
+        .type = MOTOR_CMD_PULSE, .dir = MOTOR_DIR_FORWARD, .duty = PWM_DUTY,
+        .phase_ms = 200, .ramp = MOTOR_RAMP_NONE
+    };
+    CHECK_EQ(motor_post(2, &pulse), ESP_OK);
+    fake_sleep_us(10000);
+    CHECK_EQ(motor_post_group(&s_four_axes), ESP_ERR_INVALID_STATE);
+    check_group_stats(1, 0);
+
+    fake_sleep_us(250000);
+    CHECK_EQ(motor_post_group(&s_four_axes), ESP_OK);
+    fake_sleep_us(10000);
+    CHECK_EQ(motor_post_group(&s_four_axes), ESP_ERR_INVALID_STATE);
+    fake_sleep_us(400000);
+    check_group_stats(2, 0);
+    check_all_off();
+}
+
+// STOP jednej osi w trakcie ruchu zatrzymuje wszystkie osie od razu
+static void test_stop_during_move(void)
+{
+    const motor_group_cmd_t group = {
+        .duration_ms = 1000,
+        .count = 3,
+        .axes = {
+            { .motor = 0, .dir = MOTOR_DIR_FORWARD, .duty = 4095 },
+            { .motor = 1, .dir = MOTOR_DIR_FORWARD, .duty = 4095 },
+            { .motor = 3, .dir = MOTOR_DIR_FORWARD, .duty = 4095 },
+        },
+    };
+    const motor_cmd_t stop = { .type = MOTOR_CMD_STOP };
+
+    CHECK_EQ(motor_post_group(&group), ESP_OK);
+    fake_sleep_us(200000);
+    CHECK_EQ(motor_hw_get_duty(3, MOTOR_HW_IN1), 4095);
+    const int64_t t_stop = esp_timer_get_time();
+    const uint32_t mark = trace_mark();
+    CHECK_EQ(motor_post(3, &stop), ESP_OK);
+    fake_sleep_us(1000);
+
+    check_all_off();
+    const size_t n = trace_since(mark);
+    CHECK(n >= 3 * MOTOR_HW_CH_MAX);
+    for (size_t i = 0; i < n; i++) {
+        CHECK_EQ(trace_events[i].t_us, t_stop);
+    }
+    check_group_stats(2, 1);
+}
+
+// Timer o priorytecie wyższym niż zadania silników wstawia ruch i od razu
+// STOP prowadzącej osi - komenda GROUP znika z jej kolejki przed barierą.
+// Pozostałe osie nie czekają MOTOR_GROUP_SYNC_MS, mostki się nie ruszają.
+static void post_then_stop_cb(void *arg)
+{
+    const motor_cmd_t stop = { .type = MOTOR_CMD_STOP };
+    CHECK_EQ(motor_post_group(&s_four_axes), ESP_OK);
+    CHECK_EQ(motor_post(0, &stop), ESP_OK);
+}
+
+static void test_stop_before_barrier(void)
+{
+    esp_timer_handle_t timer;
+    const esp_timer_create_args_t args = { .callback = post_then_stop_cb, .name = "test" };
+    CHECK_EQ(esp_timer_create(&args, &timer), ESP_OK);
+
+    const uint32_t mark = trace_mark();
+    CHECK_EQ(esp_timer_start_once(timer, 1000), ESP_OK);
+    fake_sleep_us(5000);
+
+    check_group_stats(2, 2);
+    // Tylko STOP osi 0 zapisuje jej mostek
+    const size_t n = trace_since(mark);
+    for (size_t i = 0; i < n; i++) {
+        CHECK_EQ(trace_events[i].motor, 0);
+        CHECK_EQ(trace_events[i].duty, 0);
+    }
+    CHECK_EQ(motor_post_group(&s_four_axes), ESP_OK);
+    fake_sleep_us(400000);
+    check_group_stats(3, 2);
+}
+
+int main(void)
+{
+    fake_rtos_reset(T_BOOT);
+    pwm_init();
+    CHECK_EQ(motor_init(), ESP_OK);
+    fake_tasks_start();
+
+    test_edges_in_one_instant();
+    test_busy_axis_rejected();
+    test_stop_during_move();
+    test_stop_before_barrier();
+    CHECK_EQ(fake_critical_blocking, 0);
+    CHECK_EQ(fake_isr_unsafe, 0);
+    TEST_MAIN_END("test_motor_group");
+}
@@ -0,0 +1,77 @@
+// Mostki na LEDC (motor_hw_ledc.c) z fake_ledc: zmiana częstotliwości PWM
+// przelicza wypełnienia na nową skalę, ale nie włącza mostka
+// zablokowanego przez motor_hw_trip - ani przez zatwierdzenie nowego
+// wypełnienia, ani później, dopóki motor_hw_release nie zdejmie blokady.
+
+#include "motor.h"
+#include "motor_hw.h"
+#include "fake_ledc.h"
+#include "fake_rtos.h"
+#include "test_host.h"
+
+TEST_DEFINE_FAILURES;
+
+#define T_BOOT 1000000
+
+// Kanały jak w mapie motor_hw_ledc.c: silnik m na LEDC_CHANNEL_2m i 2m+1
+static uint32_t output(uint8_t motor, motor_hw_ch_t ch)
+{
+    return fake_ledc_output(LEDC_LOW_SPEED_MODE, (ledc_channel_t)(motor * MOTOR_HW_CH_MAX + ch));
+}
+
+// Pełne wypełnienie w skali timera bieżącej częstotliwości
+static uint32_t hw_duty(uint32_t duty)
+{
+    return (uint32_t)(((uint64_t)duty << fake_ledc_bits) / (PWM_DUTY + 1));
+}
+
+// Przeliczenie przez mniejszą rozdzielczość zaokrągla w dół
+static bool near(uint32_t duty, uint32_t expected)
+{
+    return duty <= expected && duty + 2 >= expected;
+}
+
+static void test_set_freq_while_tripped(void)
+{
+    motor_hw_set(0, PWM_DUTY, 0);
+    motor_hw_set(1, 0, PWM_DUTY / 2);
+    CHECK_EQ(output(0, MOTOR_HW_IN1), hw_duty(PWM_DUTY));
+    CHECK_EQ(output(1, MOTOR_HW_IN2), hw_duty(PWM_DUTY / 2));
+
+    motor_hw_trip(0);
+    CHECK_EQ(output(0, MOTOR_HW_IN1), 0);
+
+    // Np. /pwm?freq z puli HTTP, zanim zadanie silnika obsłuży STOP
+    const uint32_t bits = fake_ledc_bits;
+    CHECK_EQ(motor_hw_set_freq(20000), ESP_OK);
+    CHECK(fake_ledc_bits < bits);
+    CHECK_EQ(output(0, MOTOR_HW_IN1), 0);
+    CHECK_EQ(output(0, MOTOR_HW_IN2), 0);
+    // Niezablokowany mostek dalej jedzie z tą samą prędkością
+    CHECK_EQ(output(1, MOTOR_HW_IN2), hw_duty(PWM_DUTY / 2));
+    CHECK(near(motor_hw_get_duty(1, MOTOR_HW_IN2), PWM_DUTY / 2));
+
+    // Zapis przed zdjęciem blokady też nie włącza wyjścia
+    motor_hw_set(0, PWM_DUTY, 0);
+    CHECK_EQ(output(0, MOTOR_HW_IN1), 0);
+
+    // Obsługa STOP: zdjęcie blokady i zero, potem mostek znów rusza
+    CHECK(motor_hw_release(0));
+    motor_hw_set(0, 0, 0);
+    motor_hw_set(0, PWM_DUTY, 0);
+    CHECK_EQ(output(0, MOTOR_HW_IN1), hw_duty(PWM_DUTY));
+
+    CHECK_EQ(motor_hw_set_freq(CONFIG_MOTOR_PWM_FREQ_HZ), ESP_OK);
+    CHECK(near(motor_hw_get_duty(0, MOTOR_HW_IN1), PWM_DUTY));
+    CHECK(near(motor_hw_get_duty(1, MOTOR_HW_IN2), PWM_DUTY / 2));
+}
+
+int main(void)
+{
+    fake_rtos_reset(T_BOOT);
+    CHECK_EQ(motor_hw_init(), ESP_OK);
+
+    test_set_freq_while_tripped();
+    CHECK_EQ(fake_critical_blocking, 0);
+    TEST_MAIN_END("test_motor_hw_ledc");
+}
@@ -0,0 +1,100 @@
+// Ruch do pozycji (MOTOR_CMD_MOVE) przez motor.c z symulacją mostka
+// i enkodera: błąd zatrzymania po wybiegu mieści się w wybiegu modelu
+// silnika, także przy opóźnionym wybudzeniu zadania i w obu kierunkach.
+
+#include "motor.c"
+#include "fake_rtos.h"
+#include "test_host.h"
+
+TEST_DEFINE_FAILURES;
+
+#define T_BOOT 1000000
+
+// Model z encoder_sim.c: krok 1 ms, stała czasowa 50 ms
+#define SIM_PERIOD_US 1000
+#define SIM_TAU_US 50000
+
+// Prędkość ustalona modelu przy wypełnieniu duty (zliczenia/s)
+static int64_t sim_speed_cps(uint32_t duty)
+{
+    return (int64_t)duty * CONFIG_MOTOR_MAX_RPM * CONFIG_ENCODER_CPR / (60 * PWM_DUTY);
+}
+
+// Komenda z kolejki silnika wykonana w imieniu jego zadania
+static bool motor_task_step(uint8_t id)
+{
+    motor_t *m = &s_motors[id];
+    motor_cmd_t cmd;
+
+    fake_task_set_current(m->task);
+    bool got = motor_queue_pop(&m->queue, &cmd, 0);
+    if (got) {
+        motor_handle_cmd(m, &cmd);
+    }
+    fake_task_set_current(NULL);
+    return got;
+}
+
+// Ruch o delta zliczeń z wypełnieniem duty. Po odcięciu w chwili
+// przejścia przez cel wał wybiega: prędkość v maleje co krok o v/50, więc
+// droga to v * (TAU/PERIOD - 1) kroków po 1 ms. Do tego dochodzi
+// przejazd celu w kroku, w którym go wykryto (do v * 1 ms) i droga
+// w czasie opóźnienia wybudzenia zadania.
+static void check_move(int32_t delta, uint32_t duty, int64_t latency_us)
+{
+    motor_state_t state;
+    motor_get_state(MOTOR_PRIMARY, &state);
+    const int32_t target = state.position + delta;
+    const int64_t v = sim_speed_cps(duty);
+    const int64_t coast = v * (SIM_TAU_US / SIM_PERIOD_US - 1) / 1000 + v * latency_us / 1000000;
+    const int64_t tolerance = v * SIM_PERIOD_US / 1000000 + 1;
+
+    fake_wake_latency_us = latency_us;
+    const motor_cmd_t cmd = { .type = MOTOR_CMD_MOVE, .position = target, .duty = duty };
+    CHECK_EQ(motor_post(MOTOR_PRIMARY, &cmd), ESP_OK);
+    CHECK(motor_task_step(MOTOR_PRIMARY));
+    fake_wake_latency_us = 0;
+
+    motor_get_state(MOTOR_PRIMARY, &state);
+    CHECK_EQ(state.duty_in1, 0);
+    CHECK_EQ(state.duty_in2, 0);
+    // Wybieg w kierunku ruchu - błąd ma znak delta
+    const int64_t error = (delta > 0) ? state.move_error : -(int64_t)state.move_error;
+    if (error < coast - tolerance || error > coast + tolerance) {
+        fprintf(stderr, "ruch o %" PRId32 ", duty %" PRIu32 ", opóźnienie %" PRId64 " us: "
+                "błąd %" PRId32 ", oczekiwany %" PRId64 " +- %" PRId64 "\n",
+                delta, duty, latency_us, state.move_error, delta > 0 ? coast : -coast, tolerance);
+        test_failures++;
+    }
+    CHECK_EQ(state.position - target, state.move_error);
+}
+
+// Cel już osiągnięty: bez ruchu i z zerowym błędem
+static void test_move_in_place(void)
+{
+    motor_state_t state;
+    motor_get_state(MOTOR_PRIMARY, &state);
+    const motor_cmd_t cmd = { .type = MOTOR_CMD_MOVE, .position = state.position };
+    CHECK_EQ(motor_post(MOTOR_PRIMARY, &cmd), ESP_OK);
+    CHECK(motor_task_step(MOTOR_PRIMARY));
+    motor_get_state(MOTOR_PRIMARY, &state);
+    CHECK_EQ(state.move_error, 0);
+}
+
+int main(void)
+{
+    fake_rtos_reset(T_BOOT);
+    pwm_init();
+    CHECK_EQ(motor_init(), ESP_OK);
+
+    test_move_in_place();
+    // Pełne wypełnienie i ćwierć, w obie strony; długość ruchu wystarcza
+    // do osiągnięcia prędkości ustalonej
+    check_move(12000, PWM_DUTY, 0);
+    check_move(-12000, PWM_DUTY, 0);
+    check_move(6000, PWM_DUTY / 4, 0);
+    check_move(-6000, PWM_DUTY / 4, 0);
+    // Zadanie wybudzone 2 ms po przerwaniu celu
+    check_move(12000, PWM_DUTY, 2000);
+    TEST_MAIN_END("test_motor_move");
+}
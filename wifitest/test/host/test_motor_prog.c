@@ -0,0 +1,104 @@
+// Zadania programów (motor_prog.c) z zadaniami silników na fake_rtos:
+// anulowanie trwającego zadania przerywa tylko jego krok - także w trakcie
+// rampy - a zadanie czekające za nim w kolejce rusza i kończy się jako
+// DONE. Przerwanie ze starym numerem zadania nie dotyka następnej komendy.
+
+#include "motor.c"
+#include "fake_rtos.h"
+#include "test_host.h"
+
+TEST_DEFINE_FAILURES;
+
+#define T_BOOT 1000000
+
+static uint32_t submit_run(motor_dir_t dir, uint32_t duty, uint32_t ms, motor_ramp_t ramp, uint16_t ramp_ms)
+{
+    motor_prog_t prog = {
+        .count = 1,
+        .steps = { { .op = MOTOR_PROG_RUN, .dir = dir, .ramp = ramp, .duty = duty, .ramp_ms = ramp_ms, .arg = ms } }
+    };
+    uint32_t id = 0;
+    CHECK_EQ(motor_prog_submit(MOTOR_PRIMARY, &prog, &id), ESP_OK);
+    return id;
+}
+
+static motor_job_state_t job_state(uint32_t id)
+{
+    motor_job_info_t info;
+    CHECK_EQ(motor_prog_get_info(id, &info), ESP_OK);
+    return info.state;
+}
+
+static void test_cancel_keeps_queued_job(void)
+{
+    const uint32_t first = submit_run(MOTOR_DIR_FORWARD, PWM_DUTY, 2000, MOTOR_RAMP_NONE, 0);
+    const uint32_t second = submit_run(MOTOR_DIR_REVERSE, PWM_DUTY / 2, 100, MOTOR_RAMP_NONE, 0);
+    fake_sleep_us(50000);
+    CHECK_EQ(job_state(first), MOTOR_JOB_RUNNING);
+    CHECK_EQ(job_state(second), MOTOR_JOB_QUEUED);
+    CHECK_EQ(motor_hw_get_duty(MOTOR_PRIMARY, MOTOR_HW_IN1), PWM_DUTY);
+
+    CHECK_EQ(motor_prog_cancel(first), ESP_OK);
+    fake_sleep_us(2000);
+    CHECK_EQ(job_state(first), MOTOR_JOB_CANCELLED);
+    CHECK_EQ(job_state(second), MOTOR_JOB_RUNNING);
+    CHECK_EQ(motor_hw_get_duty(MOTOR_PRIMARY, MOTOR_HW_IN1), 0);
+    CHECK_EQ(motor_hw_get_duty(MOTOR_PRIMARY, MOTOR_HW_IN2), PWM_DUTY / 2);
+
+    fake_sleep_us(200000);
+    CHECK_EQ(job_state(second), MOTOR_JOB_DONE);
+    CHECK_EQ(motor_hw_get_duty(MOTOR_PRIMARY, MOTOR_HW_IN2), 0);
+    CHECK_EQ(motor_prog_cancel(first), ESP_ERR_INVALID_STATE);
+    CHECK_EQ(motor_prog_cancel(second), ESP_ERR_INVALID_STATE);
+}
+
+// Rampa 500 ms przerwana po 100 ms - mostek na 0 od razu, nie po rampie
+static void test_cancel_during_ramp(void)
+{
+    const uint32_t first = submit_run(MOTOR_DIR_FORWARD, PWM_DUTY, 2000, MOTOR_RAMP_LINEAR, 500);
+    const uint32_t second = submit_run(MOTOR_DIR_FORWARD, PWM_DUTY / 4, 100, MOTOR_RAMP_NONE, 0);
+    fake_sleep_us(100000);
+    const uint32_t mid = motor_hw_get_duty(MOTOR_PRIMARY, MOTOR_HW_IN1);
+    CHECK(mid > 0 && mid < PWM_DUTY);
+
+    CHECK_EQ(motor_prog_cancel(first), ESP_OK);
+    fake_sleep_us(2000);
+    CHECK_EQ(job_state(first), MOTOR_JOB_CANCELLED);
+    CHECK_EQ(motor_hw_get_duty(MOTOR_PRIMARY, MOTOR_HW_IN1), PWM_DUTY / 4);
+    fake_sleep_us(200000);
+    CHECK_EQ(job_state(second), MOTOR_JOB_DONE);
+    CHECK_EQ(motor_hw_get_duty(MOTOR_PRIMARY, MOTOR_HW_IN1), 0);
+}
+
+// Anulowanie spóźnione względem końca zadania: motor_preempt_job ze
+// starym numerem nie przerywa zadania, które już trwa
+static void test_stale_preempt(void)
+{
+    const uint32_t first = submit_run(MOTOR_DIR_FORWARD, PWM_DUTY, 20, MOTOR_RAMP_NONE, 0);
+    const uint32_t second = submit_run(MOTOR_DIR_REVERSE, PWM_DUTY, 200, MOTOR_RAMP_NONE, 0);
+    fake_sleep_us(50000);
+    CHECK_EQ(job_state(first), MOTOR_JOB_DONE);
+    CHECK_EQ(job_state(second), MOTOR_JOB_RUNNING);
+
+    motor_preempt_job(MOTOR_PRIMARY, first);
+    fake_sleep_us(2000);
+    CHECK_EQ(job_state(second), MOTOR_JOB_RUNNING);
+    CHECK_EQ(motor_hw_get_duty(MOTOR_PRIMARY, MOTOR_HW_IN2), PWM_DUTY);
+    fake_sleep_us(200000);
+    CHECK_EQ(job_state(second), MOTOR_JOB_DONE);
+}
+
+int main(void)
+{
+    fake_rtos_reset(T_BOOT);
+    pwm_init();
+    CHECK_EQ(motor_init(), ESP_OK);
+    fake_tasks_start();
+
+    test_cancel_keeps_queued_job();
+    test_cancel_during_ramp();
+    test_stale_preempt();
+    CHECK_EQ(fake_critical_blocking, 0);
+    CHECK_EQ(fake_isr_unsafe, 0);
+    TEST_MAIN_END("test_motor_prog");
+}
@@ -0,0 +1,94 @@
+// Przybliżenie krzywej S odcinkami liniowymi: liczba odcinków dla czasu
+// rampy i granice błędu opisane w motor_ramp.c.
+
+#include <math.h>
+#include "motor_ramp.h"
+#include "test_host.h"
+
+TEST_DEFINE_FAILURES;
+
+static double scurve(double t)
+{
+    return 3 * t * t - 2 * t * t * t;
+}
+
+// Punkty odcinków jako ułamek zmiany wypełnienia
+static double point(motor_ramp_t profile, size_t k, size_t n)
+{
+    return k == 0 ? 0.0 : (double)motor_ramp_point(profile, k, n) / MOTOR_RAMP_SCALE;
+}
+
+static void test_segments(void)
+{
+    CHECK_EQ(motor_ramp_segments(MOTOR_RAMP_SCURVE, 300), 32);
+    CHECK_EQ(motor_ramp_segments(MOTOR_RAMP_SCURVE, 128), 32);
+    CHECK_EQ(motor_ramp_segments(MOTOR_RAMP_SCURVE, 100), 16);
+    CHECK_EQ(motor_ramp_segments(MOTOR_RAMP_SCURVE, 20), 4);
+    CHECK_EQ(motor_ramp_segments(MOTOR_RAMP_SCURVE, 3), 1);
+    // Zanikanie sprzętowe jest liniowe - rampa liniowa to jeden odcinek
+    CHECK_EQ(motor_ramp_segments(MOTOR_RAMP_LINEAR, 300), 1);
+    CHECK_EQ(motor_ramp_segments(MOTOR_RAMP_TRAPEZOID, 2000), 1);
+
+    for (uint32_t ms = 1; ms <= 5000; ms++) {
+        size_t n = motor_ramp_segments(MOTOR_RAMP_SCURVE, ms);
+        CHECK(n == 1 || ms / n >= MOTOR_RAMP_SEG_MIN_MS);
+    }
+}
+
+static void test_points(void)
+{
+    for (size_t n = 1; n <= MOTOR_RAMP_SEGMENTS; n *= 2) {
+        CHECK_EQ(motor_ramp_point(MOTOR_RAMP_SCURVE, n, n), MOTOR_RAMP_SCALE);
+        CHECK_EQ(motor_ramp_point(MOTOR_RAMP_LINEAR, n, n), MOTOR_RAMP_SCALE);
+        for (size_t k = 1; k <= n; k++) {
+            // Tablica zaokrąglona do jednostki MOTOR_RAMP_SCALE i rosnąca
+            CHECK(fabs(point(MOTOR_RAMP_SCURVE, k, n) - scurve((double)k / n)) <= 0.5 / MOTOR_RAMP_SCALE);
+            CHECK(point(MOTOR_RAMP_SCURVE, k, n) > point(MOTOR_RAMP_SCURVE, k - 1, n));
+            CHECK(fabs(point(MOTOR_RAMP_LINEAR, k, n) - (double)k / n) <= 1.0 / MOTOR_RAMP_SCALE);
+        }
+    }
+}
+
+// Odchylenie od krzywej <= 0,75 / N^2, skok nachylenia <= 6 / N
+// (w jednostkach zmiany wypełnienia i czasu rampy) plus zaokrąglenie tablicy
+static void test_error_bound(void)
+{
+    for (size_t n = 4; n <= MOTOR_RAMP_SEGMENTS; n *= 2) {
+        double max_dev = 0;
+        double max_jump = 0;
+        double prev_slope = 0;
+        for (size_t k = 1; k <= n; k++) {
+            double a = point(MOTOR_RAMP_SCURVE, k - 1, n);
+            double b = point(MOTOR_RAMP_SCURVE, k, n);
+            for (int i = 0; i <= 100; i++) {
+                double u = i / 100.0;
+                double dev = fabs(a + (b - a) * u - scurve((k - 1 + u) / n));
+                max_dev = dev > max_dev ? dev : max_dev;
+            }
+            double slope = (b - a) * n;
+            double jump = fabs(slope - prev_slope);
+            // Pierwsza granica to start z zerowym nachyleniem
+            max_jump = jump > max_jump ? jump : max_jump;
+            prev_slope = slope;
+        }
+        const double rounding = 1.0 / MOTOR_RAMP_SCALE;
+        CHECK(max_dev <= 0.75 / (n * n) + rounding);
+        CHECK(max_jump <= 6.0 / n + 2 * n * rounding);
+        // Z pełną liczbą odcinków skok to najwyżej 12,5 % nachylenia szczytowego
+        if (n == MOTOR_RAMP_SEGMENTS) {
+            CHECK(max_jump / 1.5 <= 0.125 + 0.01);
+        }
+        if (getenv("V") != NULL) {
+            printf("  N=%2zu: odchylenie %.5f, skok nachylenia %.4f\n", n, max_dev, max_jump);
+        }
+    }
+}
+
+int main(void)
+{
+    test_segments();
+    test_points();
+    test_error_bound();
+
+    TEST_MAIN_END("test_motor_ramp");
+}
@@ -0,0 +1,178 @@
+// Procedury z NVS (motor_routine.c) i ich interpreter w motor.c:
+// walidator odrzuca skok warunkowy w tył, pętlę zagnieżdżoną na tym
+// samym liczniku, LOOP z celem nie przed sobą i czujnik, którego silnik
+// nie ma. Zapisana procedura, w której JUMP_IF przeskakuje LOOP pętli
+// wewnętrznej, kończy się po tylu przebiegach, ile wynika z kodu.
+
+#include <string.h>
+#include "motor.c"
+#include "fake_rtos.h"
+#include "test_host.h"
+
+TEST_DEFINE_FAILURES;
+
+#define T_BOOT 1000000
+#define WAIT_MS 10
+#define WAIT_LONG_MS 1500
+
+#define INSN(op_, a_, b_, arg_) { .op = (op_), .a = (a_), .b = (b_), .arg = (arg_) }
+
+static void check_rejected(const motor_insn_t *code, size_t count, uint8_t motor,
+                           size_t pc, const char *reason)
+{
+    motor_routine_t r = { .count = count };
+    memcpy(r.code, code, count * sizeof(motor_insn_t));
+    motor_routine_fault_t fault = { 0 };
+    CHECK_EQ(motor_routine_validate(&r, motor, &fault), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(fault.pc, pc);
+    CHECK(fault.reason != NULL && strcmp(fault.reason, reason) == 0);
+}
+
+static void test_validate_rejects(void)
+{
+    // Skok warunkowy w tył i w miejscu
+    const motor_insn_t back[] = {
+        INSN(MOTOR_OP_WAIT, 0, 0, WAIT_MS),
+        INSN(MOTOR_OP_JUMP_IF, MOTOR_COND_POS_GE, 0, 0),
+    };
+    check_rejected(back, 2, MOTOR_PRIMARY, 1, "Skok warunkowy tylko w przód");
+    const motor_insn_t self[] = {
+        INSN(MOTOR_OP_JUMP_IF, MOTOR_COND_POS_GE, 0, 0),
+    };
+    check_rejected(self, 1, MOTOR_PRIMARY, 0, "Skok warunkowy tylko w przód");
+
+    // Pętla wewnętrzna i zewnętrzna na liczniku 0
+    const motor_insn_t nested[] = {
+        INSN(MOTOR_OP_WAIT, 0, 0, WAIT_MS),
+        INSN(MOTOR_OP_WAIT, 0, 0, WAIT_MS),
+        INSN(MOTOR_OP_LOOP, 0, 1, 2),
+        INSN(MOTOR_OP_LOOP, 0, 0, 2),
+    };
+    check_rejected(nested, 4, MOTOR_PRIMARY, 3, "Zagnieżdżona pętla na tym samym liczniku");
+
+    // LOOP wraca tylko do instrukcji przed sobą
+    const motor_insn_t loop_self[] = {
+        INSN(MOTOR_OP_WAIT, 0, 0, WAIT_MS),
+        INSN(MOTOR_OP_LOOP, 0, 1, 2),
+    };
+    check_rejected(loop_self, 2, MOTOR_PRIMARY, 1, "Niepoprawna pętla");
+    const motor_insn_t loop_fwd[] = {
+        INSN(MOTOR_OP_LOOP, 0, 1, 2),
+        INSN(MOTOR_OP_END, 0, 0, 0),
+    };
+    check_rejected(loop_fwd, 2, MOTOR_PRIMARY, 0, "Niepoprawna pętla");
+
+    // Enkoder ma tylko MOTOR_PRIMARY, a pomiaru prądu nie ma wcale
+    const motor_insn_t pos_jump[] = {
+        INSN(MOTOR_OP_WAIT, 0, 0, WAIT_MS),
+        INSN(MOTOR_OP_JUMP_IF, MOTOR_COND_POS_GE, 2, 0),
+    };
+    check_rejected(pos_jump, 2, 1, 1, "Czujnik niedostępny na tym silniku");
+    const motor_insn_t cur_jump[] = {
+        INSN(MOTOR_OP_JUMP_IF, MOTOR_COND_CUR_GE, 1, 500),
+    };
+    check_rejected(cur_jump, 1, MOTOR_PRIMARY, 0, "Czujnik niedostępny na tym silniku");
+    const motor_insn_t move[] = {
+        INSN(MOTOR_OP_MOVE, 0, PWM_DUTY, 100),
+    };
+    check_rejected(move, 1, 1, 0, "Instrukcja wymaga enkodera");
+
+    // Ten sam skok na silniku z enkoderem przechodzi
+    motor_routine_t ok = { .count = 2 };
+    memcpy(ok.code, pos_jump, sizeof(pos_jump));
+    motor_routine_fault_t fault;
+    CHECK_EQ(motor_routine_validate(&ok, MOTOR_PRIMARY, &fault), ESP_OK);
+}
+
+// Zapis w NVS, odczyt i wykonanie jak przez API; czas do końca zadania
+static int64_t run_stored(const char *name, const motor_insn_t *code, size_t count)
+{
+    uint8_t blob[MOTOR_ROUTINE_BLOB_MAX];
+    const motor_routine_hdr_t hdr = {
+        .magic = MOTOR_ROUTINE_MAGIC, .version = MOTOR_ROUTINE_VERSION, .count = (uint8_t)count
+    };
+    memcpy(blob, &hdr, sizeof(hdr));
+    memcpy(blob + sizeof(hdr), code, count * sizeof(motor_insn_t));
+    motor_routine_fault_t fault;
+    CHECK_EQ(motor_routine_store(name, blob, sizeof(hdr) + count * sizeof(motor_insn_t), &fault), ESP_OK);
+
+    motor_routine_t r;
+    CHECK_EQ(motor_routine_get(name, &r), ESP_OK);
+    CHECK_EQ(r.count, count);
+    uint32_t id = 0;
+    const int64_t t0 = esp_timer_get_time();
+    CHECK_EQ(motor_prog_submit_routine(MOTOR_PRIMARY, &r, &id), ESP_OK);
+
+    motor_job_info_t info;
+    for (int ms = 0; ms < 10000; ms++) {
+        fake_sleep_us(1000);
+        CHECK_EQ(motor_prog_get_info(id, &info), ESP_OK);
+        if (info.state != MOTOR_JOB_QUEUED && info.state != MOTOR_JOB_RUNNING) {
+            break;
+        }
+    }
+    CHECK_EQ(info.state, MOTOR_JOB_DONE);
+    return esp_timer_get_time() - t0;
+}
+
+// Pętla zewnętrzna (licznik 0, 3 przebiegi) z wewnętrzną (licznik 1,
+// 2 przebiegi), w której JUMP_IF przeskakuje LOOP wewnętrzny. Czas
+// wykonania liczy przebiegi: bez skoku 3 x (1 + 2) oczekiwań, ze skokiem
+// w każdym przebiegu 3 x 2.
+static void test_jump_over_inner_loop(void)
+{
+    const int32_t far = 1000000;
+    const motor_insn_t never[] = {
+        INSN(MOTOR_OP_WAIT, 0, 0, WAIT_MS),
+        INSN(MOTOR_OP_WAIT, 0, 0, WAIT_MS),
+        INSN(MOTOR_OP_JUMP_IF, MOTOR_COND_POS_LT, 4, -far),
+        INSN(MOTOR_OP_LOOP, 1, 1, 2),
+        INSN(MOTOR_OP_LOOP, 0, 0, 3),
+        INSN(MOTOR_OP_END, 0, 0, 0),
+    };
+    int64_t t = run_stored("inner", never, 6);
+    CHECK(t >= 9 * WAIT_MS * 1000 && t <= (9 * WAIT_MS + 5) * 1000);
+
+    motor_insn_t always[6];
+    memcpy(always, never, sizeof(never));
+    always[2].a = MOTOR_COND_POS_GE;
+    t = run_stored("skip", always, 6);
+    CHECK(t >= 6 * WAIT_MS * 1000 && t <= (6 * WAIT_MS + 5) * 1000);
+}
+
+// Pętla wewnętrzna przerwana skokiem po jednym przebiegu: w następnym
+// przebiegu zewnętrznej zaczyna od zera, więc każdy przebieg zewnętrznej
+// odczekuje dwa razy po WAIT_LONG_MS. Licznik pozostawiony po skoku
+// skróciłby drugi przebieg do jednego oczekiwania. Cztery ruchy MOVE
+// trwają razem około sekundy, czyli krócej niż jedno WAIT_LONG_MS.
+static void test_jump_resets_inner_counter(void)
+{
+    const motor_insn_t code[] = {
+        INSN(MOTOR_OP_WAIT, 0, 0, WAIT_MS),
+        INSN(MOTOR_OP_WAIT, 0, 0, WAIT_LONG_MS),
+        INSN(MOTOR_OP_JUMP_IF, MOTOR_COND_POS_GE, 5, 50),
+        INSN(MOTOR_OP_MOVE, 0, PWM_DUTY, 100),
+        INSN(MOTOR_OP_LOOP, 1, 1, 2),
+        INSN(MOTOR_OP_MOVE, 0, PWM_DUTY, 0),
+        INSN(MOTOR_OP_LOOP, 0, 0, 2),
+        INSN(MOTOR_OP_END, 0, 0, 0),
+    };
+    const int64_t t = run_stored("partial", code, 8);
+    CHECK(t >= (4 * WAIT_LONG_MS + 2 * WAIT_MS) * 1000 && t < 5 * WAIT_LONG_MS * 1000);
+}
+
+int main(void)
+{
+    fake_rtos_reset(T_BOOT);
+    pwm_init();
+    CHECK_EQ(motor_init(), ESP_OK);
+    CHECK_EQ(motor_routine_init(), ESP_OK);
+    fake_tasks_start();
+
+    test_validate_rejects();
+    test_jump_over_inner_loop();
+    test_jump_resets_inner_counter();
+    CHECK_EQ(fake_critical_blocking, 0);
+    CHECK_EQ(fake_isr_unsafe, 0);
+    TEST_MAIN_END("test_motor_routine");
+}
@@ -0,0 +1,189 @@
+// Granice kroków sekwencji silnika na zegarze testu: fazy CYCLE/PULSE
+// z rampami budowane jak w motor_run_cycle, start w zaplanowanej chwili
+// (start_us) i od razu, opóźnienie wybudzenia zadania i przerwanie.
+
+#include <string.h>
+#include "motor_seq.h"
+#include "fake_rtos.h"
+#include "test_host.h"
+
+TEST_DEFINE_FAILURES;
+
+#define DUTY 4095
+#define T_BOOT 1000000      // zegar testu startuje po 1 s od "resetu"
+
+// Chwila i krok każdego przełączenia zwróconego przez motor_seq_next
+typedef struct {
+    int64_t t_us[MOTOR_SEQ_MAX_STEPS + 1];
+    const motor_step_t *step[MOTOR_SEQ_MAX_STEPS + 1];
+    size_t count;           // łącznie z końcem sekwencji (step == NULL)
+} transitions_t;
+
+static motor_seq_t s_seq;
+
+static size_t build_cycle(motor_step_t *steps, uint32_t phase_ms, motor_ramp_t ramp, uint32_t ramp_ms)
+{
+    size_t n = motor_seq_add_phase(steps, 0, DUTY, 0, phase_ms, ramp, ramp_ms);
+    return motor_seq_add_phase(steps, n, 0, DUTY, phase_ms, ramp, ramp_ms);
+}
+
+static esp_err_t run(const motor_step_t *steps, size_t n, int64_t start_us, transitions_t *tr)
+{
+    memset(tr, 0, sizeof(*tr));
+    esp_err_t err = motor_seq_start(&s_seq, steps, n, start_us);
+    CHECK_EQ(err, ESP_OK);
+
+    const motor_step_t *step;
+    while ((err = motor_seq_next(&s_seq, portMAX_DELAY, &step)) == ESP_OK) {
+        tr->t_us[tr->count] = esp_timer_get_time();
+        tr->step[tr->count++] = step;
+        if (step == NULL) {
+            break;
+        }
+    }
+    return err;
+}
+
+// Kolejne przełączenia dokładnie w chwilach t0 + offsets[i] (+ opóźnienie zadania)
+static void check_times(const transitions_t *tr, int64_t t0, const int64_t *offsets, size_t n, int64_t late)
+{
+    CHECK_EQ(tr->count, n);
+    for (size_t i = 0; i < n && i < tr->count; i++) {
+        CHECK_EQ(tr->t_us[i], t0 + offsets[i] + late);
+    }
+    CHECK(tr->count > 0 && tr->step[tr->count - 1] == NULL);
+    CHECK_EQ(motor_seq_last_lateness_us(&s_seq), late);
+}
+
+// CYCLE z rampą trapezową i startem za 20 ms: rozruch wysuwu, hamowanie
+// w ostatnich ramp_ms fazy, to samo przy cofaniu
+static void test_cycle_trapezoid_start_us(void)
+{
+    fake_rtos_reset(T_BOOT);
+    motor_step_t steps[MOTOR_SEQ_MAX_STEPS];
+    size_t n = build_cycle(steps, 3000, MOTOR_RAMP_TRAPEZOID, 500);
+    CHECK_EQ(n, 4);
+
+    const int64_t t0 = T_BOOT + 20000;
+    transitions_t tr;
+    CHECK_EQ(run(steps, n, t0, &tr), ESP_OK);
+
+    const int64_t expect[] = { 0, 2500000, 3000000, 5500000, 6000000 };
+    check_times(&tr, t0, expect, 5, 0);
+
+    // Wysuw z rampą do pełnego wypełnienia, hamowanie do zera, cofanie
+    CHECK_EQ(tr.step[0]->in1, DUTY);
+    CHECK_EQ(tr.step[0]->ramp_ms, 500);
+    CHECK_EQ(tr.step[1]->in1 + tr.step[1]->in2, 0);
+    CHECK_EQ(tr.step[1]->ramp, MOTOR_RAMP_TRAPEZOID);
+    CHECK_EQ(tr.step[2]->in2, DUTY);
+    CHECK_EQ(tr.step[3]->in1 + tr.step[3]->in2, 0);
+}
+
+// Rampa S dłuższa niż pół fazy skracana do phase_ms / 2
+static void test_cycle_scurve_clamped(void)
+{
+    fake_rtos_reset(T_BOOT);
+    motor_step_t steps[MOTOR_SEQ_MAX_STEPS];
+    size_t n = build_cycle(steps, 3000, MOTOR_RAMP_SCURVE, 2000);
+    CHECK_EQ(n, 4);
+    CHECK_EQ(steps[0].ramp_ms, 1500);
+
+    const int64_t t0 = T_BOOT + 50000;
+    transitions_t tr;
+    CHECK_EQ(run(steps, n, t0, &tr), ESP_OK);
+
+    const int64_t expect[] = { 0, 1500000, 3000000, 4500000, 6000000 };
+    check_times(&tr, t0, expect, 5, 0);
+}
+
+// Rampa liniowa: skokowe wyłączenie wysuwu (krok zerowy) i cofanie
+// w tej samej chwili na granicy faz
+static void test_cycle_linear_phase_boundary(void)
+{
+    fake_rtos_reset(T_BOOT);
+    motor_step_t steps[MOTOR_SEQ_MAX_STEPS];
+    size_t n = build_cycle(steps, 1000, MOTOR_RAMP_LINEAR, 300);
+    CHECK_EQ(n, 3);
+    CHECK_EQ(steps[1].duration_us, 0);
+
+    const int64_t t0 = T_BOOT + 20000;
+    transitions_t tr;
+    CHECK_EQ(run(steps, n, t0, &tr), ESP_OK);
+
+    const int64_t expect[] = { 0, 1000000, 1000000, 2000000 };
+    check_times(&tr, t0, expect, 4, 0);
+    CHECK_EQ(tr.step[1]->in1 + tr.step[1]->in2, 0);
+    CHECK_EQ(tr.step[2]->in2, DUTY);
+}
+
+// Opóźnienie wybudzenia zadania nie kumuluje się: chwile liczone od t0
+static void test_wake_latency_not_accumulated(void)
+{
+    fake_rtos_reset(T_BOOT);
+    motor_step_t steps[MOTOR_SEQ_MAX_STEPS];
+    size_t n = build_cycle(steps, 3000, MOTOR_RAMP_TRAPEZOID, 500);
+
+    fake_wake_latency_us = 37;
+    const int64_t t0 = T_BOOT + 20000;
+    transitions_t tr;
+    CHECK_EQ(run(steps, n, t0, &tr), ESP_OK);
+
+    const int64_t expect[] = { 0, 2500000, 3000000, 5500000, 6000000 };
+    check_times(&tr, t0, expect, 5, 37);
+}
+
+// start_us miniony (lub 0): pierwszy krok od razu, plan od chwili startu
+static void test_pulse_start_now(void)
+{
+    fake_rtos_reset(T_BOOT);
+    motor_step_t steps[MOTOR_SEQ_MAX_STEPS];
+    size_t n = motor_seq_add_phase(steps, 0, 0, 2000, 700, MOTOR_RAMP_NONE, 0);
+    CHECK_EQ(n, 1);
+
+    transitions_t tr;
+    CHECK_EQ(run(steps, n, T_BOOT - 5000, &tr), ESP_OK);
+
+    const int64_t expect[] = { 0, 700000 };
+    check_times(&tr, T_BOOT, expect, 2, 0);
+    CHECK_EQ(tr.step[0]->in2, 2000);
+}
+
+// Bit przerwania w trakcie fazy: ESP_ERR_INVALID_STATE i zatrzymany timer,
+// kolejna sekwencja startuje bez zaległych granic
+static void test_abort(void)
+{
+    fake_rtos_reset(T_BOOT);
+    motor_step_t steps[MOTOR_SEQ_MAX_STEPS];
+    size_t n = build_cycle(steps, 3000, MOTOR_RAMP_NONE, 0);
+
+    CHECK_EQ(motor_seq_start(&s_seq, steps, n, T_BOOT + 20000), ESP_OK);
+    const motor_step_t *step;
+    CHECK_EQ(motor_seq_next(&s_seq, portMAX_DELAY, &step), ESP_OK);
+    CHECK_EQ(esp_timer_get_time(), T_BOOT + 20000);
+
+    fake_clock_advance_to(T_BOOT + 1000000);
+    xTaskNotify(xTaskGetCurrentTaskHandle(), MOTOR_SEQ_ABORT_BIT, eSetBits);
+    CHECK_EQ(motor_seq_next(&s_seq, portMAX_DELAY, &step), ESP_ERR_INVALID_STATE);
+    CHECK(!esp_timer_is_active(s_seq.timer));
+    CHECK_EQ(esp_timer_get_time(), T_BOOT + 1000000);
+
+    transitions_t tr;
+    CHECK_EQ(run(steps, n, 0, &tr), ESP_OK);
+    const int64_t expect[] = { 0, 3000000, 6000000 };
+    check_times(&tr, T_BOOT + 1000000, expect, 3, 0);
+}
+
+int main(void)
+{
+    CHECK_EQ(motor_seq_init(&s_seq), ESP_OK);
+
+    test_cycle_trapezoid_start_us();
+    test_cycle_scurve_clamped();
+    test_cycle_linear_phase_boundary();
+    test_wake_latency_not_accumulated();
+    test_pulse_start_now();
+    test_abort();
+
+    TEST_MAIN_END("test_motor_seq");
+}
@@ -0,0 +1,148 @@
+// STOP w trakcie rampy (praca ciągła, impuls, zmiana kierunku) i ruchu do
+// pozycji z zadaniem silnika działającym na fake_rtos: zanikanie jest
+// przerywane w chwili STOP, a nie po końcu odcinka, i nie zostawia pobudki
+// dla następnej rampy, a po przerwanym ruchu nie ma czekania na wybieg.
+
+#include "motor.c"
+#include "fake_rtos.h"
+#include "test_host.h"
+#include "sim_trace.h"
+
+TEST_DEFINE_FAILURES;
+
+#define T_BOOT 1000000
+#define RAMP_MS 300
+
+// STOP teraz: oba wejścia mają 0 od razu, każdy zapis mostka ma znacznik
+// chwili STOP, a późniejsze zanikanie już nic nie zmienia
+static void check_stop_now(uint8_t motor)
+{
+    const motor_cmd_t stop = { .type = MOTOR_CMD_STOP };
+    const int64_t t_stop = esp_timer_get_time();
+    const uint32_t since = trace_mark();
+
+    CHECK_EQ(motor_post(motor, &stop), ESP_OK);
+    fake_sleep_us(1000);
+    CHECK_EQ(motor_hw_get_duty(motor, MOTOR_HW_IN1), 0);
+    CHECK_EQ(motor_hw_get_duty(motor, MOTOR_HW_IN2), 0);
+
+    fake_sleep_us(RAMP_MS * 1000);
+    const size_t n = trace_since(since);
+    CHECK(n >= MOTOR_HW_CH_MAX);
+    for (size_t i = 0; i < n; i++) {
+        CHECK_EQ(trace_events[i].motor, motor);
+        CHECK_EQ(trace_events[i].t_us, t_stop);
+        CHECK_EQ(trace_events[i].fade_ms, 0);
+    }
+    motor_state_t state;
+    motor_get_state(motor, &state);
+    CHECK_EQ(state.phase, MOTOR_PHASE_IDLE);
+}
+
+// Rampa liniowa pracy ciągłej przerwana w jednej trzeciej
+static void test_stop_run_ramp(void)
+{
+    const motor_cmd_t run = {
+        .type = MOTOR_CMD_RUN, .dir = MOTOR_DIR_FORWARD, .duty = PWM_DUTY,
+        .ramp = MOTOR_RAMP_LINEAR, .ramp_ms = RAMP_MS
+    };
+    CHECK_EQ(motor_post(0, &run), ESP_OK);
+    fake_sleep_us(RAMP_MS * 1000 / 3);
+    const uint32_t mid = motor_hw_get_duty(0, MOTOR_HW_IN1);
+    CHECK(mid > PWM_DUTY / 4 && mid < PWM_DUTY / 2);
+    check_stop_now(0);
+}
+
+// Odcinek krzywej S w fazie impulsu - sekwencer czeka za rampą
+static void test_stop_pulse_scurve(void)
+{
+    const motor_cmd_t pulse = {
+        .type = MOTOR_CMD_PULSE, .dir = MOTOR_DIR_REVERSE, .duty = PWM_DUTY,
+        .phase_ms = 1000, .ramp = MOTOR_RAMP_SCURVE, .ramp_ms = RAMP_MS
+    };
+    CHECK_EQ(motor_post(1, &pulse), ESP_OK);
+    fake_sleep_us(RAMP_MS * 1000 / 2 + 3000);
+    CHECK(motor_hw_get_duty(1, MOTOR_HW_IN2) > 0);
+    check_stop_now(1);
+}
+
+// Hamowanie przed zmianą kierunku: po STOP nie ma już rozpędzania
+// w przeciwną stronę
+static void test_stop_reversal(void)
+{
+    const motor_cmd_t run = {
+        .type = MOTOR_CMD_RUN, .dir = MOTOR_DIR_FORWARD, .duty = PWM_DUTY, .ramp = MOTOR_RAMP_NONE
+    };
+    const motor_cmd_t reverse = {
+        .type = MOTOR_CMD_SET_DIR, .dir = MOTOR_DIR_REVERSE,
+        .ramp = MOTOR_RAMP_TRAPEZOID, .ramp_ms = RAMP_MS
+    };
+    CHECK_EQ(motor_post(2, &run), ESP_OK);
+    fake_sleep_us(1000);
+    CHECK_EQ(motor_hw_get_duty(2, MOTOR_HW_IN1), PWM_DUTY);
+    CHECK_EQ(motor_post(2, &reverse), ESP_OK);
+    fake_sleep_us(RAMP_MS * 1000 / 2);
+    CHECK(motor_hw_get_duty(2, MOTOR_HW_IN1) < PWM_DUTY);
+    check_stop_now(2);
+}
+
+// Rampa po obsłużonym STOP trwa pełny czas - pobudka STOP nie skraca jej
+static void test_ramp_after_stop(void)
+{
+    const motor_cmd_t run = {
+        .type = MOTOR_CMD_RUN, .dir = MOTOR_DIR_FORWARD, .duty = PWM_DUTY,
+        .ramp = MOTOR_RAMP_LINEAR, .ramp_ms = RAMP_MS
+    };
+    CHECK_EQ(motor_post(0, &run), ESP_OK);
+    fake_sleep_us(RAMP_MS * 1000 - 10000);
+    CHECK(motor_hw_get_duty(0, MOTOR_HW_IN1) < PWM_DUTY);
+    fake_sleep_us(20000);
+    CHECK_EQ(motor_hw_get_duty(0, MOTOR_HW_IN1), PWM_DUTY);
+
+    motor_state_t state;
+    motor_get_state(0, &state);
+    CHECK_EQ(state.phase, MOTOR_PHASE_RUN);
+    check_stop_now(0);
+}
+
+// STOP w trakcie ruchu do pozycji: następna komenda nie czeka na wybieg
+// wału (MOTOR_MOVE_SETTLE_MS), który ma sens tylko po osiągnięciu celu
+static void test_stop_move(void)
+{
+    motor_state_t state;
+    motor_get_state(MOTOR_PRIMARY, &state);
+    const motor_cmd_t move = {
+        .type = MOTOR_CMD_MOVE, .position = state.position + 12000, .duty = PWM_DUTY
+    };
+    const motor_cmd_t run = {
+        .type = MOTOR_CMD_RUN, .dir = MOTOR_DIR_REVERSE, .duty = PWM_DUTY, .ramp = MOTOR_RAMP_NONE
+    };
+    const motor_cmd_t stop = { .type = MOTOR_CMD_STOP };
+
+    CHECK_EQ(motor_post(MOTOR_PRIMARY, &move), ESP_OK);
+    fake_sleep_us(50000);
+    CHECK_EQ(motor_hw_get_duty(MOTOR_PRIMARY, MOTOR_HW_IN1), PWM_DUTY);
+    CHECK_EQ(motor_post(MOTOR_PRIMARY, &stop), ESP_OK);
+    CHECK_EQ(motor_post(MOTOR_PRIMARY, &run), ESP_OK);
+    fake_sleep_us(2000);
+    CHECK_EQ(motor_hw_get_duty(MOTOR_PRIMARY, MOTOR_HW_IN1), 0);
+    CHECK_EQ(motor_hw_get_duty(MOTOR_PRIMARY, MOTOR_HW_IN2), PWM_DUTY);
+    check_stop_now(MOTOR_PRIMARY);
+}
+
+int main(void)
+{
+    fake_rtos_reset(T_BOOT);
+    pwm_init();
+    CHECK_EQ(motor_init(), ESP_OK);
+    fake_tasks_start();
+
+    test_stop_run_ramp();
+    test_stop_pulse_scurve();
+    test_stop_reversal();
+    test_ramp_after_stop();
+    test_stop_move();
+    CHECK_EQ(fake_critical_blocking, 0);
+    CHECK_EQ(fake_isr_unsafe, 0);
+    TEST_MAIN_END("test_motor_stop");
+}
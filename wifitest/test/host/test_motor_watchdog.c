@@ -0,0 +1,278 @@
+// Watchdog łącza (motor_watchdog.c) z zadaniami silników na fake_rtos:
+// callback w przerwaniu wyłącza mostki uzbrojonych silników w chwili ich
+// terminu, bez wywołań niedozwolonych w ISR, także w trakcie rampy.
+// Uzbraja go praca bez końca z każdej drogi, a STOP i ruch ograniczony
+// w czasie nie. Silnik uruchomiony przez /ws (ws_control.c) należy do tego
+// połączenia: heartbeat innej karty go nie utrzyma, a zamknięcie gniazda
+// zatrzymuje go od razu.
+
+#include "motor.c"
+#include "ws_control.h"
+#include "fake_httpd.h"
+#include "fake_rtos.h"
+#include "test_host.h"
+#include "sim_trace.h"
+
+TEST_DEFINE_FAILURES;
+
+#define T_BOOT 1000000
+#define TIMEOUT_US ((int64_t)CONFIG_MOTOR_WATCHDOG_MS * 1000)
+// Zadania silników budzą się później niż callback - zapisy w chwili
+// terminu pochodzą tylko z motor_hw_trip
+#define WAKE_US 300
+
+// Klienci /ws - numery gniazd jak z accept
+#define FD_A 54
+#define FD_B 55
+
+// Handshake /ws nie jest tu wołany
+void telemetry_keep_session(int sockfd)
+{
+}
+
+static void ws_send(int fd, const uint8_t *frame, size_t len)
+{
+    CHECK_EQ(fake_httpd_ws_frame("/ws", fd, frame, len), ESP_OK);
+    CHECK_EQ(fake_httpd_response.len, 3);
+    CHECK_EQ((uint8_t)fake_httpd_response.body[0], frame[0] | WS_ACK_FLAG);
+    CHECK_EQ((uint8_t)fake_httpd_response.body[2], WS_STATUS_OK);
+}
+
+static void ws_start(int fd, uint32_t duty)
+{
+    const uint8_t frame[] = { WS_OP_START, 1, MOTOR_DIR_FORWARD, duty & 0xff, duty >> 8 };
+    ws_send(fd, frame, sizeof(frame));
+}
+
+static void ws_heartbeat(int fd)
+{
+    const uint8_t frame[] = { WS_OP_HEARTBEAT, 2 };
+    ws_send(fd, frame, sizeof(frame));
+}
+
+static void check_all_off(void)
+{
+    for (uint8_t i = 0; i < MOTOR_COUNT; i++) {
+        CHECK_EQ(motor_hw_get_duty(i, MOTOR_HW_IN1), 0);
+        CHECK_EQ(motor_hw_get_duty(i, MOTOR_HW_IN2), 0);
+    }
+}
+
+static void run(uint8_t motor, motor_dir_t dir, uint32_t duty, motor_ramp_t ramp, uint32_t ramp_ms)
+{
+    const motor_cmd_t cmd = {
+        .type = MOTOR_CMD_RUN, .dir = dir, .duty = duty, .ramp = ramp, .ramp_ms = ramp_ms
+    };
+    CHECK_EQ(motor_post(motor, &cmd), ESP_OK);
+}
+
+static void stop(uint8_t motor)
+{
+    const motor_cmd_t cmd = { .type = MOTOR_CMD_STOP };
+    CHECK_EQ(motor_post(motor, &cmd), ESP_OK);
+}
+
+// Dwa silniki w pracy ciągłej (jak z REST), po 300 ms powtórzone komendy,
+// potem cisza: w chwili terminu stają oba mostki naraz
+static void test_trip_armed_motors(void)
+{
+    run(0, MOTOR_DIR_FORWARD, PWM_DUTY, MOTOR_RAMP_NONE, 0);
+    run(2, MOTOR_DIR_REVERSE, PWM_DUTY / 2, MOTOR_RAMP_NONE, 0);
+    fake_sleep_us(300000);
+    run(0, MOTOR_DIR_FORWARD, PWM_DUTY, MOTOR_RAMP_NONE, 0);
+    run(2, MOTOR_DIR_REVERSE, PWM_DUTY / 2, MOTOR_RAMP_NONE, 0);
+    const int64_t deadline = esp_timer_get_time() + TIMEOUT_US;
+
+    fake_sleep_us(TIMEOUT_US - 1000);
+    CHECK_EQ(motor_hw_get_duty(0, MOTOR_HW_IN1), PWM_DUTY);
+    CHECK_EQ(motor_hw_get_duty(2, MOTOR_HW_IN2), PWM_DUTY / 2);
+
+    const uint32_t since = trace_mark();
+    fake_wake_latency_us = WAKE_US;
+    fake_sleep_us(2000);
+    fake_wake_latency_us = 0;
+    check_all_off();
+    // Najpierw zapisy motor_hw_trip obu mostków w chwili terminu, potem
+    // tylko zera od zadań silników po obsłudze STOP
+    const size_t n = trace_since(since);
+    CHECK(n >= 2 * MOTOR_HW_CH_MAX);
+    uint32_t tripped = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (trace_events[i].t_us == deadline) {
+            tripped |= BIT(trace_events[i].motor * MOTOR_HW_CH_MAX + trace_events[i].ch);
+        }
+        CHECK_EQ(trace_events[i].duty, 0);
+    }
+    CHECK_EQ(tripped, 0x33);
+
+    motor_watchdog_stats_t stats;
+    motor_watchdog_get_stats(&stats);
+    CHECK(!stats.armed);
+    CHECK_EQ(stats.trips, 2);
+    CHECK_EQ(stats.latency_us, 0);
+
+    // STOP zdjął blokadę - silnik znów rusza
+    run(0, MOTOR_DIR_FORWARD, PWM_DUTY, MOTOR_RAMP_NONE, 0);
+    fake_sleep_us(1000);
+    CHECK_EQ(motor_hw_get_duty(0, MOTOR_HW_IN1), PWM_DUTY);
+    stop(0);
+    fake_sleep_us(1000);
+}
+
+// Rampa dłuższa niż limit: odcięcie w trakcie zanikania i brak ponownego
+// włączenia po jego końcu
+static void test_trip_during_ramp(void)
+{
+    run(1, MOTOR_DIR_FORWARD, PWM_DUTY, MOTOR_RAMP_LINEAR, 2000);
+    fake_sleep_us(TIMEOUT_US - 1000);
+    CHECK(motor_hw_get_duty(1, MOTOR_HW_IN1) > 0);
+    fake_wake_latency_us = WAKE_US;
+    fake_sleep_us(1000 + WAKE_US / 2);
+    check_all_off();
+    fake_sleep_us(1000);
+    fake_wake_latency_us = 0;
+    check_all_off();
+    fake_sleep_us(2000000);
+    check_all_off();
+
+    motor_state_t state;
+    motor_get_state(1, &state);
+    CHECK_EQ(state.phase, MOTOR_PHASE_IDLE);
+    motor_watchdog_stats_t stats;
+    motor_watchdog_get_stats(&stats);
+    CHECK_EQ(stats.trips, 3);
+}
+
+// STOP rozbraja, a impuls z własnym czasem trwania nie uzbraja
+static void test_bounded_commands(void)
+{
+    run(0, MOTOR_DIR_FORWARD, PWM_DUTY, MOTOR_RAMP_NONE, 0);
+    fake_sleep_us(100000);
+    stop(0);
+    fake_sleep_us(3 * TIMEOUT_US);
+
+    const motor_cmd_t pulse = {
+        .type = MOTOR_CMD_PULSE, .dir = MOTOR_DIR_FORWARD, .duty = PWM_DUTY,
+        .phase_ms = 3 * CONFIG_MOTOR_WATCHDOG_MS, .ramp = MOTOR_RAMP_NONE
+    };
+    CHECK_EQ(motor_post(3, &pulse), ESP_OK);
+    fake_sleep_us(2 * TIMEOUT_US);
+    CHECK_EQ(motor_hw_get_duty(3, MOTOR_HW_IN1), PWM_DUTY);
+    fake_sleep_us(2 * TIMEOUT_US);
+    check_all_off();
+
+    motor_watchdog_stats_t stats;
+    motor_watchdog_get_stats(&stats);
+    CHECK(!stats.armed);
+    CHECK_EQ(stats.trips, 3);
+}
+
+// Drugi silnik nadal uzbraja watchdog po STOP pierwszego
+static void test_stop_one_of_two(void)
+{
+    run(0, MOTOR_DIR_FORWARD, PWM_DUTY, MOTOR_RAMP_NONE, 0);
+    run(1, MOTOR_DIR_FORWARD, PWM_DUTY, MOTOR_RAMP_NONE, 0);
+    fake_sleep_us(100000);
+    stop(0);
+    fake_sleep_us(TIMEOUT_US);
+    check_all_off();
+
+    motor_watchdog_stats_t stats;
+    motor_watchdog_get_stats(&stats);
+    CHECK_EQ(stats.trips, 4);
+}
+
+// Karta A uruchamia silnik przez /ws i milknie, karta B wysyła heartbeat
+// co 200 ms jak interfejs WWW i zmienia wypełnienie. Silnik A i silnik
+// z REST stają w swoim terminie mimo ramek B.
+static void test_silent_session(void)
+{
+    ws_start(FD_A, PWM_DUTY);
+    run(1, MOTOR_DIR_FORWARD, PWM_DUTY, MOTOR_RAMP_NONE, 0);
+    const int64_t deadline = esp_timer_get_time() + TIMEOUT_US;
+    const uint8_t set_duty[] = { WS_OP_SET_DUTY, 3, PWM_DUTY & 0xff, PWM_DUTY >> 8 };
+    while (esp_timer_get_time() + 200000 < deadline) {
+        fake_sleep_us(200000);
+        ws_heartbeat(FD_B);
+        ws_send(FD_B, set_duty, sizeof(set_duty));
+    }
+    CHECK(motor_hw_get_duty(MOTOR_PRIMARY, MOTOR_HW_IN1) > 0);
+    CHECK_EQ(motor_hw_get_duty(1, MOTOR_HW_IN1), PWM_DUTY);
+
+    const uint32_t since = trace_mark();
+    fake_wake_latency_us = WAKE_US;
+    fake_sleep_us(deadline - esp_timer_get_time() + 1000);
+    fake_wake_latency_us = 0;
+    check_all_off();
+    const size_t n = trace_since(since);
+    CHECK(n >= 2 * MOTOR_HW_CH_MAX);
+    for (size_t i = 0; i < n && i < 2 * MOTOR_HW_CH_MAX; i++) {
+        CHECK_EQ(trace_events[i].t_us, deadline);
+    }
+
+    motor_watchdog_stats_t stats;
+    motor_watchdog_get_stats(&stats);
+    CHECK(!stats.armed);
+    CHECK_EQ(stats.trips, 6);
+}
+
+// Karta B uruchamia silnik i wysyła heartbeat przez trzy terminy, a A
+// milczy: silnik jedzie. Zamknięcie gniazda B zatrzymuje go od razu,
+// a zamknięcie A (bez silników) niczego nie zmienia.
+static void test_session_closed(void)
+{
+    ws_start(FD_B, PWM_DUTY);
+    for (int i = 0; i < 3 * CONFIG_MOTOR_WATCHDOG_MS / 200; i++) {
+        fake_sleep_us(200000);
+        ws_heartbeat(FD_B);
+    }
+    CHECK(motor_hw_get_duty(MOTOR_PRIMARY, MOTOR_HW_IN1) > 0);
+    motor_watchdog_session_closed(FD_A);
+    fake_sleep_us(1000);
+    CHECK(motor_hw_get_duty(MOTOR_PRIMARY, MOTOR_HW_IN1) > 0);
+
+    // Jak http_close_fn w zadaniu serwera
+    const uint32_t since = trace_mark();
+    const int64_t closed = esp_timer_get_time();
+    motor_watchdog_session_closed(FD_B);
+    CHECK_EQ(motor_hw_get_duty(MOTOR_PRIMARY, MOTOR_HW_IN1), 0);
+    const size_t n = trace_since(since);
+    CHECK(n >= MOTOR_HW_CH_MAX);
+    CHECK_EQ(trace_events[0].t_us, closed);
+    fake_sleep_us(1000);
+    check_all_off();
+
+    motor_state_t state;
+    motor_get_state(MOTOR_PRIMARY, &state);
+    CHECK_EQ(state.phase, MOTOR_PHASE_IDLE);
+    motor_watchdog_stats_t stats;
+    motor_watchdog_get_stats(&stats);
+    CHECK(!stats.armed);
+    CHECK_EQ(stats.trips, 7);
+
+    // Po STOP silnik znów rusza z /ws
+    ws_start(FD_A, PWM_DUTY);
+    fake_sleep_us(1000);
+    CHECK(motor_hw_get_duty(MOTOR_PRIMARY, MOTOR_HW_IN1) > 0);
+    stop(MOTOR_PRIMARY);
+    fake_sleep_us(1000);
+}
+
+int main(void)
+{
+    fake_rtos_reset(T_BOOT);
+    pwm_init();
+    CHECK_EQ(motor_init(), ESP_OK);
+    CHECK_EQ(ws_control_register(NULL), ESP_OK);
+    fake_tasks_start();
+
+    test_trip_armed_motors();
+    test_trip_during_ramp();
+    test_bounded_commands();
+    test_stop_one_of_two();
+    test_silent_session();
+    test_session_closed();
+    CHECK_EQ(fake_critical_blocking, 0);
+    CHECK_EQ(fake_isr_unsafe, 0);
+    TEST_MAIN_END("test_motor_watchdog");
+}
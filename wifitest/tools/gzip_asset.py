@@ -0,0 +1,20 @@
+#!/usr/bin/env python
+# Kompresja zasobu WWW do osadzenia w firmware.
+# mtime=0 i brak nazwy pliku w nagłówku, aby wynik (i ETag) zależał
+# wyłącznie od treści.
+import gzip
+import sys
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit('usage: gzip_asset.py <input> <output.gz>')
+    with open(sys.argv[1], 'rb') as src:
+        data = src.read()
+    with open(sys.argv[2], 'wb') as raw:
+        with gzip.GzipFile(filename='', mode='wb', fileobj=raw, compresslevel=9, mtime=0) as dst:
+            dst.write(data)
+
+
+if __name__ == '__main__':
+    main()
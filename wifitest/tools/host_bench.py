@@ -0,0 +1,439 @@
+#!/usr/bin/env python
+# Benchmark firmware zbudowanego na hosta (idf.py --preview set-target linux).
+# Uruchamia build/wifitest.elf, mierzy opóźnienia handlerów HTTP
+# i dokładność sekwencji silnika z zapisu /sim/trace symulacji mostka,
+# a z CONFIG_MOTOR_ENCODER także błąd zatrzymania ruchów /move. Przy kilku
+# silnikach porównuje rozrzut startu osi: /motor/all (wspólna chwila startu
+# w osobnych zadaniach) i /motor/group (zapis grupowy mostków).
+# Z CONFIG_MOTOR_WATCHDOG sprawdza, że silnik uruchomiony przez /ws staje,
+# gdy klient przestaje wysyłać heartbeat, i podaje opóźnienie zadziałania.
+# Program /api/v1/program: dokładność czasu kroków i anulowanie zadania.
+# Procedura z NVS (/api/v1/routine): zapis, pętla w interpreterze i usunięcie.
+# Pula HTTP: opóźnienie GET /api/v1/motor, gdy wolny klient wysyła ciało
+# programu (trasa w zadaniu puli, CONFIG_HTTP_WORKERS > 0).
+# Wynik w JSON na stdout.
+import argparse
+import base64
+import http.client
+import json
+import os
+import socket
+import subprocess
+import sys
+import time
+
+from routine_asm import assemble
+
+
+def percentile(values, p):
+    if not values:
+        return None
+    ordered = sorted(values)
+    k = min(len(ordered) - 1, int(round(p / 100.0 * (len(ordered) - 1))))
+    return ordered[k]
+
+
+def summary_us(samples):
+    return {
+        'count': len(samples),
+        'p50_us': percentile(samples, 50),
+        'p99_us': percentile(samples, 99),
+        'max_us': max(samples) if samples else None,
+    }
+
+
+def request(host, port, path, headers=None):
+    conn = http.client.HTTPConnection(host, port, timeout=10)
+    t0 = time.perf_counter()
+    conn.request('GET', path, headers=headers or {})
+    resp = conn.getresponse()
+    body = resp.read()
+    elapsed_us = int((time.perf_counter() - t0) * 1e6)
+    conn.close()
+    return resp.status, resp.getheader('ETag'), body, elapsed_us
+
+
+def wait_for_server(host, port, timeout_s):
+    deadline = time.time() + timeout_s
+    while time.time() < deadline:
+        try:
+            request(host, port, '/')
+            return
+        except OSError:
+            time.sleep(0.1)
+    sys.exit('server on {}:{} did not come up'.format(host, port))
+
+
+def bench_http(host, port, count, phase_ms):
+    results = {}
+
+    status, etag, _, _ = request(host, port, '/')
+    samples = [request(host, port, '/')[3] for _ in range(count)]
+    results['ui_200'] = summary_us(samples)
+
+    samples = [request(host, port, '/', {'If-None-Match': etag})[3] for _ in range(count)]
+    results['ui_304'] = summary_us(samples)
+
+    # Handler tylko kolejkuje komendę: 202 lub 503 przy pełnej kolejce
+    codes = {}
+    samples = []
+    for _ in range(count):
+        status, _, _, elapsed = request(host, port, '/activate?ramp=none&phase_ms={}'.format(phase_ms))
+        codes[str(status)] = codes.get(str(status), 0) + 1
+        samples.append(elapsed)
+    results['activate'] = summary_us(samples)
+    results['activate']['status'] = codes
+    return results
+
+
+def read_trace(host, port, since):
+    events = []
+    while True:
+        _, _, body, _ = request(host, port, '/sim/trace?since={}'.format(since))
+        chunk = json.loads(body)
+        events.extend(chunk['events'])
+        if chunk['dropped']:
+            sys.exit('trace overrun: {} events dropped'.format(chunk['dropped']))
+        if chunk['next'] == since:
+            return events, since
+        since = chunk['next']
+
+
+def bench_motor(host, port, cycles, phase_ms):
+    # Cykle zakolejkowane przez bench_http muszą się najpierw zakończyć
+    _, since = read_trace(host, port, 0)
+    while True:
+        time.sleep(3 * phase_ms / 1000.0)
+        chunk, since = read_trace(host, port, since)
+        if not chunk:
+            break
+
+    # Cykl bez rampy: trzy skokowe zmiany mostka (wysuw, cofanie, stop),
+    # każda zapisana dla obu kanałów
+    lateness = []
+    t_start = time.perf_counter()
+    for _ in range(cycles):
+        while request(host, port, '/activate?ramp=none&phase_ms={}'.format(phase_ms))[0] != 202:
+            time.sleep(phase_ms / 1000.0)
+        events = []
+        deadline = time.time() + 10 + 2 * phase_ms / 1000.0
+        while len(events) < 6 and time.time() < deadline:
+            time.sleep(phase_ms / 2000.0)
+            chunk, since = read_trace(host, port, since)
+            events.extend(e for e in chunk if e.get('motor', 0) == 0)
+        if len(events) < 6:
+            sys.exit('motor cycle did not complete')
+        edges = [e['t'] for e in events[0:6:2]]
+        for i in (1, 2):
+            lateness.append(edges[i] - edges[0] - i * phase_ms * 1000)
+    elapsed = time.perf_counter() - t_start
+    result = summary_us(lateness)
+    result['cycles'] = cycles
+    result['cycles_per_s'] = cycles / elapsed if elapsed > 0 else None
+    return result
+
+
+def read_stats(host, port):
+    return json.loads(request(host, port, '/stats')[2])
+
+
+def bench_position(host, port, targets):
+    if 'position' not in read_stats(host, port):
+        return None
+
+    # Ruch skończony: mostek wyłączony, a pozycja stała po wybiegu
+    errors = []
+    for target in targets:
+        while request(host, port, '/move?pos={}'.format(target))[0] != 202:
+            time.sleep(0.1)
+        time.sleep(0.1)
+        deadline = time.time() + 15
+        last = None
+        while time.time() < deadline:
+            stats = read_stats(host, port)
+            idle = stats['duty_in1'] == 0 and stats['duty_in2'] == 0
+            if idle and last is not None and stats['position'] == last:
+                break
+            last = stats['position'] if idle else None
+            time.sleep(0.3)
+        else:
+            sys.exit('move to {} did not finish'.format(target))
+        errors.append(abs(stats['position'] - target))
+    return {
+        'moves': len(errors),
+        'p50_counts': percentile(errors, 50),
+        'max_counts': max(errors) if errors else None,
+    }
+
+
+def first_edges(host, port, since, motors):
+    # Chwila pierwszego włączenia IN1 każdego silnika
+    first = {}
+    deadline = time.time() + 5
+    while len(first) < motors and time.time() < deadline:
+        time.sleep(0.05)
+        chunk, since = read_trace(host, port, since)
+        for e in chunk:
+            if e['ch'] == 0 and e['duty'] > 0 and e.get('motor', 0) not in first:
+                first[e.get('motor', 0)] = e['t']
+    if len(first) < motors:
+        sys.exit('not all motors started')
+    return max(first.values()) - min(first.values()), since
+
+
+def bench_skew(host, port, rounds):
+    motors = len(read_stats(host, port).get('motors', []))
+    if motors < 2:
+        return None
+
+    axes = ','.join('{}:f:{}'.format(m, 4095 - 512 * m) for m in range(motors))
+    paths = {
+        'sync_start': '/motor/all/activate?ramp=none&phase_ms=50',
+        'group_commit': '/motor/group?ms=100&axes=' + axes,
+    }
+    _, since = read_trace(host, port, 0)
+    results = {}
+    for name, path in paths.items():
+        skews = []
+        for _ in range(rounds):
+            while request(host, port, path)[0] != 202:
+                time.sleep(0.1)
+            skew, since = first_edges(host, port, since, motors)
+            skews.append(skew)
+            # Oba ruchy trwają 100 ms
+            time.sleep(0.3)
+        results[name] = summary_us(skews)
+    results['motors'] = motors
+    return results
+
+
+def ws_connect(host, port):
+    sock = socket.create_connection((host, port), timeout=5)
+    key = base64.b64encode(os.urandom(16)).decode()
+    sock.sendall(('GET /ws HTTP/1.1\r\nHost: {}:{}\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n'
+                  'Sec-WebSocket-Key: {}\r\nSec-WebSocket-Version: 13\r\n\r\n').format(host, port, key).encode())
+    head = b''
+    while b'\r\n\r\n' not in head:
+        chunk = sock.recv(256)
+        if not chunk:
+            sys.exit('websocket handshake failed')
+        head += chunk
+    if b' 101 ' not in head.split(b'\r\n')[0]:
+        sys.exit('websocket handshake refused')
+    return sock
+
+
+def ws_command(sock, frame):
+    # Ramka klienta jest maskowana; potwierdzenie to [op|0x80][seq][status]
+    mask = os.urandom(4)
+    payload = bytes(b ^ mask[i % 4] for i, b in enumerate(frame))
+    sock.sendall(bytes([0x82, 0x80 | len(frame)]) + mask + payload)
+    ack = b''
+    while len(ack) < 5:
+        chunk = sock.recv(5 - len(ack))
+        if not chunk:
+            sys.exit('websocket closed')
+        ack += chunk
+    return ack[4]
+
+
+def bench_watchdog(host, port, rounds):
+    stats = read_stats(host, port)
+    if 'watchdog_trips' not in stats:
+        return None
+    timeout_s = stats['watchdog_ms'] / 1000.0
+
+    latencies = []
+    sock = ws_connect(host, port)
+    try:
+        for seq in range(rounds):
+            # Start w przód bez rampy i heartbeat przez dwa terminy - silnik pracuje
+            trips = read_stats(host, port)['watchdog_trips']
+            if ws_command(sock, bytes([0x01, seq & 0xff, 0, 0xff, 0x0f])) != 0:
+                sys.exit('websocket start refused')
+            deadline = time.time() + 2 * timeout_s
+            while time.time() < deadline:
+                ws_command(sock, bytes([0x07, seq & 0xff]))
+                time.sleep(timeout_s / 4)
+            stats = read_stats(host, port)
+            if stats['watchdog_trips'] != trips or stats['duty_in1'] == 0:
+                sys.exit('watchdog tripped while heartbeats were sent')
+
+            # Cisza: mostek ma stanąć niedługo po terminie
+            time.sleep(timeout_s + 0.5)
+            stats = read_stats(host, port)
+            if stats['watchdog_trips'] != trips + 1 or stats['duty_in1'] != 0 or stats['duty_in2'] != 0:
+                sys.exit('watchdog did not stop the motor')
+            latencies.append(stats['watchdog_latency_us'])
+    finally:
+        sock.close()
+    result = summary_us(latencies)
+    result['timeout_ms'] = stats['watchdog_ms']
+    return result
+
+
+def api_call(host, port, method, path, body=None):
+    conn = http.client.HTTPConnection(host, port, timeout=10)
+    conn.request(method, path, body=body,
+                 headers={'Content-Type': 'application/json'} if body else {})
+    resp = conn.getresponse()
+    data = json.loads(resp.read() or b'null')
+    conn.close()
+    return resp.status, data
+
+
+def wait_job(host, port, job, timeout_s):
+    deadline = time.time() + timeout_s
+    while time.time() < deadline:
+        status, info = api_call(host, port, 'GET', '/api/v1/program?id={}'.format(job))
+        if status != 200:
+            sys.exit('job {} lost: {}'.format(job, info))
+        if info['state'] not in ('queued', 'running'):
+            return info
+        time.sleep(0.05)
+    sys.exit('job {} did not finish'.format(job))
+
+
+def bench_program(host, port, steps, phase_ms):
+    # Kroki bez rampy na przemian w przód i w tył: każdy to włączenie
+    # i wyłączenie mostka, zapisane dla obu kanałów
+    prog = [{'dir': 'fwd' if i % 2 == 0 else 'rev', 'duration_ms': phase_ms, 'ramp': 'none'}
+            for i in range(steps)]
+    _, since = read_trace(host, port, 0)
+    status, reply = api_call(host, port, 'POST', '/api/v1/program?motor=0', json.dumps(prog))
+    if status != 202:
+        sys.exit('program refused: {} {}'.format(status, reply))
+    info = wait_job(host, port, reply['job'], 10 + steps * phase_ms / 1000.0)
+    if info['state'] != 'done':
+        sys.exit('program ended as {}'.format(info['state']))
+    events, since = read_trace(host, port, since)
+    edges = [e['t'] for e in events if e.get('motor', 0) == 0][0::2]
+    if len(edges) < 2 * steps:
+        sys.exit('program trace incomplete')
+    errors = [edges[2 * i + 1] - edges[2 * i] - phase_ms * 1000 for i in range(steps)]
+    gaps = [edges[2 * i + 2] - edges[2 * i + 1] for i in range(steps - 1)]
+    result = summary_us(errors)
+    result['steps'] = steps
+    result['gap_max_us'] = max(gaps) if gaps else None
+
+    # Anulowanie długiego programu w trakcie pierwszego kroku
+    status, reply = api_call(host, port, 'POST', '/api/v1/program?motor=0',
+                             json.dumps([{'duration_ms': 5000, 'ramp': 'none'}] * 4))
+    if status != 202:
+        sys.exit('program refused: {} {}'.format(status, reply))
+    time.sleep(0.2)
+    status, _ = api_call(host, port, 'DELETE', '/api/v1/program?id={}'.format(reply['job']))
+    info = wait_job(host, port, reply['job'], 2)
+    stats = read_stats(host, port)
+    if status != 200 or info['state'] != 'cancelled' or stats['duty_in1'] != 0:
+        sys.exit('program cancel failed: {} {}'.format(status, info))
+    result['cancel_step'] = info['step']
+    return result
+
+
+def bench_routine(host, port, loops, phase_ms):
+    blob = assemble('top:\nrun fwd 4095 {}\nloop 0 top {}\nend\n'.format(phase_ms, loops))
+    conn = http.client.HTTPConnection(host, port, timeout=10)
+    conn.request('PUT', '/api/v1/routine?name=bench', body=blob)
+    resp = conn.getresponse()
+    reply = resp.read()
+    conn.close()
+    if resp.status != 200:
+        sys.exit('routine refused: {} {}'.format(resp.status, reply))
+
+    # Drugie uruchomienie korzysta z kopii w RAM
+    result = {'loops': loops, 'runs': []}
+    for _ in range(2):
+        t0 = time.perf_counter()
+        status, reply = api_call(host, port, 'POST', '/api/v1/routine?name=bench&motor=0')
+        if status != 202:
+            sys.exit('routine start refused: {} {}'.format(status, reply))
+        info = wait_job(host, port, reply['job'], 10 + loops * phase_ms / 1000.0)
+        elapsed_ms = (time.perf_counter() - t0) * 1000
+        # Pętla musi wykonać wszystkie przebiegi (RUN z domyślną rampą)
+        if info['state'] != 'done' or elapsed_ms < loops * phase_ms:
+            sys.exit('routine ended as {} after {:.0f} ms'.format(info['state'], elapsed_ms))
+        result['runs'].append(round(elapsed_ms, 1))
+
+    if api_call(host, port, 'DELETE', '/api/v1/routine?name=bench')[0] != 200 or \
+            api_call(host, port, 'POST', '/api/v1/routine?name=bench')[0] != 404:
+        sys.exit('routine delete failed')
+    return result
+
+
+def bench_pool(host, port, count, stall_s):
+    if read_stats(host, port).get('http_workers', 0) == 0:
+        return None
+    body = json.dumps([{'duration_ms': 20, 'ramp': 'none'}] * 4).encode()
+    slow = socket.create_connection((host, port), timeout=10)
+    slow.sendall('POST /api/v1/program?motor=0 HTTP/1.1\r\nHost: {}\r\n'
+                 'Content-Type: application/json\r\nContent-Length: {}\r\n\r\n'
+                 .format(host, len(body)).encode() + body[:len(body) // 2])
+
+    # Handler czeka na resztę ciała w zadaniu puli, serwer obsługuje resztę
+    samples = []
+    deadline = time.time() + stall_s
+    while time.time() < deadline or len(samples) < count:
+        t0 = time.perf_counter()
+        status, _ = api_call(host, port, 'GET', '/api/v1/motor')
+        samples.append(int((time.perf_counter() - t0) * 1e6))
+        if status != 200:
+            sys.exit('GET during slow upload: {}'.format(status))
+
+    slow.sendall(body[len(body) // 2:])
+    status_line = slow.recv(1024).split(b'\r\n', 1)[0]
+    slow.close()
+    if b' 202 ' not in status_line:
+        sys.exit('slow program upload: {}'.format(status_line))
+    result = summary_us(samples)
+    result['stall_ms'] = int(stall_s * 1000)
+    result['pool'] = {k: v for k, v in read_stats(host, port).items() if k.startswith('http_')}
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Host benchmark of the simulated firmware')
+    parser.add_argument('--elf', default=os.path.join('build', 'wifitest.elf'))
+    parser.add_argument('--host', default='127.0.0.1')
+    parser.add_argument('--port', type=int, default=8080)
+    parser.add_argument('--no-spawn', action='store_true', help='use an already running instance')
+    parser.add_argument('--requests', type=int, default=200)
+    parser.add_argument('--cycles', type=int, default=20)
+    parser.add_argument('--phase-ms', type=int, default=20)
+    parser.add_argument('--targets', default='1200,-600,3000,0,150,-150,0',
+                        help='comma-separated /move targets in encoder counts')
+    parser.add_argument('--skew-rounds', type=int, default=20)
+    parser.add_argument('--watchdog-rounds', type=int, default=5)
+    parser.add_argument('--program-steps', type=int, default=16)
+    parser.add_argument('--routine-loops', type=int, default=5)
+    parser.add_argument('--pool-stall-ms', type=int, default=1000,
+                        help='how long the slow client holds a pooled request')
+    args = parser.parse_args()
+
+    proc = None
+    if not args.no_spawn:
+        proc = subprocess.Popen([args.elf], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    try:
+        wait_for_server(args.host, args.port, 20)
+        report = {
+            'http': bench_http(args.host, args.port, args.requests, args.phase_ms),
+            'motor_lateness': bench_motor(args.host, args.port, args.cycles, args.phase_ms),
+            'stop_error': bench_position(args.host, args.port,
+                                         [int(t) for t in args.targets.split(',')]),
+            'start_skew': bench_skew(args.host, args.port, args.skew_rounds),
+            'watchdog_trip': bench_watchdog(args.host, args.port, args.watchdog_rounds),
+            'program': bench_program(args.host, args.port, args.program_steps, args.phase_ms),
+            'routine': bench_routine(args.host, args.port, args.routine_loops, args.phase_ms),
+            'pool_latency': bench_pool(args.host, args.port, args.requests // 10,
+                                       args.pool_stall_ms / 1000.0),
+        }
+    finally:
+        if proc:
+            proc.terminate()
+            proc.wait()
+    json.dump(report, sys.stdout, indent=2)
+    sys.stdout.write('\n')
+
+
+if __name__ == '__main__':
+    main()
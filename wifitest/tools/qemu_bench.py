@@ -0,0 +1,328 @@
+#!/usr/bin/env python
+# Test obciążenia serwera HTTP firmware uruchomionego w QEMU (open_eth).
+# Buduje obraz z sdkconfig.qemu, uruchamia qemu-system-xtensa z przekierowaniem
+# portu 80 i dla każdego endpointu mierzy przepustowość, p50/p99 opóźnień
+# oraz minimum wolnej sterty (/stats). Potem wysyła serię POST /api/v1/motor
+# po jednym połączeniu i sprawdza licznik alokacji sterty z CONFIG_MOTOR_API_HEAP_TRACE
+# (włączonego w sdkconfig.qemu) - w stanie ustalonym musi zostać zerowy.
+# Na koniec wielu klientów panelu z przerwami (więcej niż sesji serwera)
+# sprawdza, że wypychanie LRU obsługuje wszystkich bez odmowy połączenia
+# i nie zamyka otwartego przez cały czas strumienia /events ani /ws.
+# Wynik w JSON na stdout.
+#
+# --host/--port bez --qemu-* pozwala obciążyć działające urządzenie
+# lub kompilację na hosta (tools/host_bench.py).
+import argparse
+import http.client
+import json
+import os
+import random
+import socket
+import subprocess
+import sys
+import threading
+import time
+
+from host_bench import ws_connect
+
+DEFAULT_ENDPOINTS = ['/', '/stats', '/activate?ramp=none&phase_ms=10']
+# Odczyty panelu w przeglądarce
+DASHBOARD_PATHS = ['/stats', '/api/v1/motor', '/']
+
+
+def percentile(values, p):
+    if not values:
+        return None
+    ordered = sorted(values)
+    k = min(len(ordered) - 1, int(round(p / 100.0 * (len(ordered) - 1))))
+    return ordered[k]
+
+
+def get_json(host, port, path):
+    conn = http.client.HTTPConnection(host, port, timeout=10)
+    try:
+        conn.request('GET', path)
+        return json.loads(conn.getresponse().read())
+    finally:
+        conn.close()
+
+
+def wait_for_server(host, port, timeout_s):
+    deadline = time.time() + timeout_s
+    while time.time() < deadline:
+        try:
+            return get_json(host, port, '/stats')
+        except (OSError, ValueError, http.client.HTTPException):
+            time.sleep(0.5)
+    sys.exit('server on {}:{} did not come up'.format(host, port))
+
+
+def worker(host, port, path, stop_at, out):
+    # Jedno trwałe połączenie na wątek, jak przeglądarka z keep-alive
+    latencies, status, errors = [], {}, 0
+    conn = None
+    while time.time() < stop_at:
+        try:
+            if conn is None:
+                conn = http.client.HTTPConnection(host, port, timeout=10)
+            t0 = time.perf_counter()
+            conn.request('GET', path)
+            resp = conn.getresponse()
+            resp.read()
+            latencies.append(time.perf_counter() - t0)
+            status[resp.status] = status.get(resp.status, 0) + 1
+            if resp.getheader('Connection', '').lower() == 'close':
+                conn.close()
+                conn = None
+        except (OSError, http.client.HTTPException):
+            errors += 1
+            if conn is not None:
+                conn.close()
+            conn = None
+    if conn is not None:
+        conn.close()
+    out.append((latencies, status, errors))
+
+
+def load(host, port, path, concurrency, duration_s):
+    out = []
+    stop_at = time.time() + duration_s
+    threads = [threading.Thread(target=worker, args=(host, port, path, stop_at, out))
+               for _ in range(concurrency)]
+    t0 = time.perf_counter()
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    elapsed = time.perf_counter() - t0
+
+    latencies, status, errors = [], {}, 0
+    for lat, st, err in out:
+        latencies.extend(lat)
+        errors += err
+        for code, n in st.items():
+            status[str(code)] = status.get(str(code), 0) + n
+    ms = [x * 1000.0 for x in latencies]
+    return {
+        'concurrency': concurrency,
+        'requests': len(latencies),
+        'errors': errors,
+        'status': status,
+        'rps': len(latencies) / elapsed if elapsed > 0 else None,
+        'p50_ms': percentile(ms, 50),
+        'p99_ms': percentile(ms, 99),
+    }
+
+
+def api_heap(host, port, count):
+    # Pierwsze żądanie rozgrzewa serwer (np. bufor sesji), potem licznik nie rośnie
+    conn = http.client.HTTPConnection(host, port, timeout=10)
+    body = json.dumps({'motor': 0, 'dir': 'fwd', 'duty': 2048, 'duration_ms': 20, 'ramp': 'none'})
+    headers = {'Content-Type': 'application/json'}
+    status = {}
+    try:
+        def post():
+            conn.request('POST', '/api/v1/motor', body, headers)
+            resp = conn.getresponse()
+            resp.read()
+            status[str(resp.status)] = status.get(str(resp.status), 0) + 1
+
+        post()
+        conn.request('GET', '/api/v1/motor')
+        before = json.loads(conn.getresponse().read()).get('heap_allocs')
+        if before is None:
+            return None
+        for _ in range(count):
+            post()
+        conn.request('GET', '/api/v1/motor')
+        after = json.loads(conn.getresponse().read())['heap_allocs']
+    finally:
+        conn.close()
+    if after != before:
+        sys.exit('POST /api/v1/motor allocated {} times in {} requests'.format(after - before, count))
+    return {'requests': count, 'heap_allocs': after - before, 'status': status}
+
+
+def dashboard_client(host, port, stop_at, think_s, seed, out):
+    # Telefon z otwartym panelem: odczyt, przerwa z połączeniem keep-alive,
+    # czasem zamknięcie (uśpienie ekranu). Serwer może wypchnąć bezczynną
+    # sesję (LRU) - wtedy jak przeglądarka ponawia żądanie na nowym połączeniu.
+    rng = random.Random(seed)
+    result = {'requests': 0, 'reconnects': 0, 'refused': 0, 'status': {}}
+    conn = None
+    while time.time() < stop_at:
+        path = rng.choice(DASHBOARD_PATHS)
+        for attempt in range(2):
+            reused = conn is not None
+            try:
+                if conn is None:
+                    conn = http.client.HTTPConnection(host, port, timeout=10)
+                conn.request('GET', path)
+                resp = conn.getresponse()
+                resp.read()
+                result['requests'] += 1
+                code = str(resp.status)
+                result['status'][code] = result['status'].get(code, 0) + 1
+                break
+            except (OSError, http.client.HTTPException):
+                if conn is not None:
+                    conn.close()
+                conn = None
+                if reused and attempt == 0:
+                    result['reconnects'] += 1
+                    continue
+                result['refused'] += 1
+                break
+        time.sleep(rng.uniform(*think_s))
+        if conn is not None and rng.random() < 0.2:
+            conn.close()
+            conn = None
+    if conn is not None:
+        conn.close()
+    out.append(result)
+
+
+def ws_heartbeat(sock):
+    # Heartbeat [0x07][seq] - każda odpowiedź znaczy, że sesja jest otwarta
+    mask = os.urandom(4)
+    frame = bytes([0x07, 0])
+    try:
+        sock.sendall(bytes([0x82, 0x80 | len(frame)]) + mask + bytes(b ^ mask[i] for i, b in enumerate(frame)))
+        return len(sock.recv(5)) > 0
+    except OSError:
+        return False
+
+
+def held_sessions(host, port, stop_at, out):
+    # Tablet ze strumieniem /events i bezczynnym /ws przez cały test: po
+    # handshake WebSocket nie wysyła nic, więc tylko odświeżanie LRU
+    # przez serwer chroni go przed wypchnięciem
+    result = {'events_samples': 0, 'events_open': True, 'ws_open': False}
+    ws = ws_connect(host, port)
+    events = socket.create_connection((host, port), timeout=5)
+    events.sendall('GET /events HTTP/1.1\r\nHost: {}:{}\r\n\r\n'.format(host, port).encode())
+    try:
+        while time.time() < stop_at:
+            try:
+                chunk = events.recv(4096)
+            except OSError:
+                chunk = b''
+            if not chunk:
+                result['events_open'] = False
+                break
+            result['events_samples'] += chunk.count(b'data:')
+        result['ws_open'] = ws_heartbeat(ws)
+    finally:
+        events.close()
+        ws.close()
+    out.append(result)
+
+
+def intermittent(host, port, clients, duration_s, think_s):
+    out = []
+    held = []
+    stop_at = time.time() + duration_s
+    threads = [threading.Thread(target=dashboard_client, args=(host, port, stop_at, think_s, i, out))
+               for i in range(clients)]
+    threads.append(threading.Thread(target=held_sessions, args=(host, port, stop_at, held)))
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    report = {'clients': clients, 'requests': 0, 'reconnects': 0, 'refused': 0, 'status': {}}
+    for r in out:
+        for key in ('requests', 'reconnects', 'refused'):
+            report[key] += r[key]
+        for code, n in r['status'].items():
+            report['status'][code] = report['status'].get(code, 0) + n
+    stats = get_json(host, port, '/stats')
+    for key in ('http_sessions', 'http_sessions_max', 'http_sessions_total'):
+        report[key] = stats.get(key)
+    report['held'] = held[0] if held else None
+    if report['refused'] or set(report['status']) != {'200'}:
+        sys.exit('intermittent clients refused: {}'.format(json.dumps(report)))
+    if not held or not held[0]['events_open'] or not held[0]['ws_open']:
+        sys.exit('long-lived session purged: {}'.format(json.dumps(report)))
+    return report
+
+
+def build_image(project, build_dir):
+    defaults = 'sdkconfig.defaults;sdkconfig.qemu'
+    subprocess.check_call(['idf.py', '-B', build_dir, '-D', 'SDKCONFIG=' + os.path.join(build_dir, 'sdkconfig'),
+                           '-D', 'SDKCONFIG_DEFAULTS=' + defaults, 'build'], cwd=project)
+    subprocess.check_call([sys.executable, '-m', 'esptool', '--chip', 'esp32', 'merge_bin',
+                           '--fill-flash-size', '4MB', '-o', 'flash.bin', '@flash_args'],
+                          cwd=os.path.join(project, build_dir))
+    return os.path.join(project, build_dir, 'flash.bin')
+
+
+def start_qemu(qemu, image, port, log):
+    return subprocess.Popen([qemu, '-nographic', '-machine', 'esp32',
+                             '-drive', 'file={},if=mtd,format=raw'.format(image),
+                             '-nic', 'user,model=open_eth,hostfwd=tcp:127.0.0.1:{}-:80'.format(port)],
+                            stdin=subprocess.DEVNULL, stdout=log, stderr=subprocess.STDOUT)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='HTTP load benchmark of the firmware in QEMU')
+    parser.add_argument('--project', default=os.path.join(os.path.dirname(__file__), '..'))
+    parser.add_argument('--build-dir', default='build_qemu')
+    parser.add_argument('--qemu', default='qemu-system-xtensa', help='QEMU binary (Espressif fork)')
+    parser.add_argument('--qemu-log', default=None, help='file for the firmware console output')
+    parser.add_argument('--no-build', action='store_true', help='reuse build_qemu/flash.bin')
+    parser.add_argument('--no-qemu', action='store_true', help='benchmark an already running server')
+    parser.add_argument('--host', default='127.0.0.1')
+    parser.add_argument('--port', type=int, default=8081)
+    parser.add_argument('--endpoint', action='append', dest='endpoints',
+                        help='path to load (repeatable), default: {}'.format(' '.join(DEFAULT_ENDPOINTS)))
+    parser.add_argument('--concurrency', type=int, action='append',
+                        help='concurrent connections (repeatable), default: 1 4')
+    parser.add_argument('--duration', type=float, default=10.0, help='seconds per endpoint and concurrency')
+    parser.add_argument('--api-requests', type=int, default=200,
+                        help='POST /api/v1/motor requests for the heap allocation check')
+    parser.add_argument('--clients', type=int, default=24,
+                        help='intermittent dashboard clients (more than the server sessions)')
+    parser.add_argument('--clients-duration', type=float, default=30.0)
+    parser.add_argument('--think-ms', default='200,2000',
+                        help='min,max pause of a dashboard client between requests')
+    args = parser.parse_args()
+
+    proc = None
+    log = None
+    if not args.no_qemu:
+        image = os.path.join(args.project, args.build_dir, 'flash.bin')
+        if not args.no_build:
+            image = build_image(args.project, args.build_dir)
+        log = open(args.qemu_log, 'wb') if args.qemu_log else subprocess.DEVNULL
+        proc = start_qemu(args.qemu, image, args.port, log)
+
+    report = {'endpoints': {}}
+    try:
+        report['boot'] = wait_for_server(args.host, args.port, 120)
+        for path in args.endpoints or DEFAULT_ENDPOINTS:
+            runs = []
+            for concurrency in args.concurrency or [1, 4]:
+                result = load(args.host, args.port, path, concurrency, args.duration)
+                stats = get_json(args.host, args.port, '/stats')
+                result['heap_free'] = stats['heap_free']
+                result['heap_min'] = stats['heap_min']
+                runs.append(result)
+            report['endpoints'][path] = runs
+        report['heap_min'] = get_json(args.host, args.port, '/stats')['heap_min']
+        report['api_heap'] = api_heap(args.host, args.port, args.api_requests)
+        think_s = [int(x) / 1000.0 for x in args.think_ms.split(',')]
+        report['intermittent'] = intermittent(args.host, args.port, args.clients,
+                                              args.clients_duration, think_s)
+    finally:
+        if proc:
+            proc.terminate()
+            proc.wait()
+        if log not in (None, subprocess.DEVNULL):
+            log.close()
+    json.dump(report, sys.stdout, indent=2)
+    sys.stdout.write('\n')
+
+
+if __name__ == '__main__':
+    main()
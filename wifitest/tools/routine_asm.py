@@ -0,0 +1,115 @@
+#!/usr/bin/env python
+# Asembler procedur ruchu (main/motor_routine.h) do blobu zapisywanego
+# przez PUT /api/v1/routine. Jedna instrukcja w wierszu, etykiety "nazwa:",
+# komentarze od '#':
+#   drive fwd|rev DUTY          praca ciągła
+#   stop
+#   run fwd|rev DUTY MS         praca przez MS i stop
+#   move POS [DUTY]             ruch do pozycji (enkoder)
+#   wait MS
+#   wait_pos POS TIMEOUT_MS     czekanie na pozycję (enkoder)
+#   wait_cur ge|lt MA TIMEOUT_MS
+#   loop REG LABEL COUNT        COUNT przebiegów od LABEL, licznik REG 0..3
+#   jump_if COND VALUE LABEL    COND: pos_ge pos_lt cur_ge cur_lt
+#   end
+# Pełną walidację wykonuje urządzenie - błąd wraca jako {"error","pc"}.
+import argparse
+import struct
+import sys
+import urllib.error
+import urllib.request
+
+MAGIC = 0x52
+VERSION = 1
+MAX_INSNS = 32
+
+OPS = ['end', 'drive', 'stop', 'run', 'move', 'wait', 'wait_pos', 'wait_cur', 'loop', 'jump_if']
+DIRS = {'fwd': 0, 'rev': 1}
+CONDS = {'pos_ge': 0, 'pos_lt': 1, 'cur_ge': 2, 'cur_lt': 3}
+
+
+def parse(lines):
+    insns = []
+    labels = {}
+    for lineno, line in enumerate(lines, 1):
+        line = line.split('#', 1)[0].strip()
+        if not line:
+            continue
+        if line.endswith(':'):
+            labels[line[:-1]] = len(insns)
+            continue
+        words = line.split()
+        if words[0] not in OPS:
+            sys.exit('line {}: unknown instruction {}'.format(lineno, words[0]))
+        insns.append((lineno, words))
+    return insns, labels
+
+
+def encode(lineno, words, labels):
+    op = words[0]
+    args = words[1:]
+
+    def label(name):
+        if name not in labels:
+            sys.exit('line {}: unknown label {}'.format(lineno, name))
+        return labels[name]
+
+    try:
+        if op in ('end', 'stop'):
+            a, b, arg = 0, 0, 0
+        elif op == 'drive':
+            a, b, arg = DIRS[args[0]], int(args[1]), 0
+        elif op == 'run':
+            a, b, arg = DIRS[args[0]], int(args[1]), int(args[2])
+        elif op == 'move':
+            a, b, arg = 0, int(args[1]) if len(args) > 1 else 0, int(args[0])
+        elif op == 'wait':
+            a, b, arg = 0, 0, int(args[0])
+        elif op == 'wait_pos':
+            a, b, arg = 0, int(args[1]), int(args[0])
+        elif op == 'wait_cur':
+            a, b, arg = CONDS['cur_' + args[0]], int(args[2]), int(args[1])
+        elif op == 'loop':
+            a, b, arg = int(args[0]), label(args[1]), int(args[2])
+        else:
+            a, b, arg = CONDS[args[0]], label(args[2]), int(args[1])
+        return struct.pack('<BBHi', OPS.index(op), a, b, arg)
+    except (IndexError, KeyError, ValueError, struct.error):
+        sys.exit('line {}: bad operands for {}'.format(lineno, op))
+
+
+def assemble(text):
+    insns, labels = parse(text.splitlines())
+    if not insns or len(insns) > MAX_INSNS:
+        sys.exit('a routine has 1..{} instructions'.format(MAX_INSNS))
+    code = b''.join(encode(lineno, words, labels) for lineno, words in insns)
+    return struct.pack('<BBBB', MAGIC, VERSION, len(insns), 0) + code
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Assemble a motion routine')
+    parser.add_argument('source')
+    parser.add_argument('-o', '--output', help='write the blob to a file')
+    parser.add_argument('--put', metavar='URL',
+                        help='upload, e.g. http://<ip>/api/v1/routine?name=level')
+    args = parser.parse_args()
+
+    with open(args.source) as src:
+        blob = assemble(src.read())
+    if args.output:
+        with open(args.output, 'wb') as dst:
+            dst.write(blob)
+    if args.put:
+        req = urllib.request.Request(args.put, data=blob, method='PUT',
+                                     headers={'Content-Type': 'application/octet-stream'})
+        try:
+            with urllib.request.urlopen(req, timeout=10) as resp:
+                print(resp.read().decode())
+        except urllib.error.HTTPError as err:
+            sys.exit('{} {}'.format(err.code, err.read().decode()))
+    if not args.output and not args.put:
+        sys.stdout.buffer.write(blob)
+
+
+if __name__ == '__main__':
+    main()